@@ -0,0 +1,157 @@
+#include "Bench.h"
+#include "Engine.h"
+#include "font.h"
+#include <array>
+#include <fstream>
+#include <glad/glad.h>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    constexpr int QUADS = 10000;
+    const char *TEXT = "The quick brown fox jumps over the lazy dog 0123456789";
+
+    // The sandbox doesn't ship a font, ENGINE_BENCH_FONT names a .ttf in the assets directory
+    std::string benchFont(Bench::State &state)
+    {
+        const char *name = std::getenv("ENGINE_BENCH_FONT");
+        std::string fontName = name ? name : "font.ttf";
+        if (!std::ifstream(Content::path().append(fontName)).good())
+        {
+            state.skip("no " + fontName + " in assets (set ENGINE_BENCH_FONT)");
+            return "";
+        }
+        return fontName;
+    }
+}
+
+void registerBatchBenchmarks()
+{
+    Bench::add("Batch::quad", [](Bench::State &state)
+               {
+                   Engine::Batch batch;
+                   state.setItems(QUADS);
+                   while (state.run())
+                   {
+                       for (int i = 0; i < QUADS; i++)
+                           batch.quad({(float)(i % 640), (float)(i / 640)}, {8.0f, 8.0f}, 0xffffff);
+                       batch.clear();
+                   }
+               });
+
+    Bench::add("Batch::tex", [](Bench::State &state)
+               {
+                   Engine::Batch batch;
+                   auto texture = Engine::Texture::create(64, 64, Engine::TextureFormat::RGBA);
+                   auto subtexture = Engine::Subtexture(texture, Engine::Rect(16, 16, 32, 32));
+                   state.setItems(QUADS);
+                   while (state.run())
+                   {
+                       for (int i = 0; i < QUADS; i++)
+                           batch.tex(subtexture, {(float)(i % 640), (float)(i / 640)}, 0xffffff);
+                       batch.clear();
+                   }
+               });
+
+    Bench::add("Batch::texBatch", [](Bench::State &state)
+               {
+                   Engine::Batch batch;
+                   auto texture = Engine::Texture::create(64, 64, Engine::TextureFormat::RGBA);
+                   auto subtexture = Engine::Subtexture(texture, Engine::Rect(16, 16, 32, 32));
+                   std::vector<Engine::SpriteInstance> instances(QUADS);
+                   for (int i = 0; i < QUADS; i++)
+                       instances[i] = {&subtexture, {(float)(i % 640), (float)(i / 640)}, {1.0f, 1.0f}, 0xffffff};
+                   state.setItems(QUADS);
+                   while (state.run())
+                   {
+                       batch.texBatch(instances.data(), instances.size());
+                       batch.clear();
+                   }
+               });
+
+    // Four workers record a quarter of the quads each, the render thread merges their Batches
+    Bench::add("Batch::merge", [](Bench::State &state)
+               {
+                   constexpr int WORKERS = 4;
+                   std::array<Engine::Batch, WORKERS> workers;
+                   std::vector<const Engine::Batch *> recorded;
+                   for (int w = 0; w < WORKERS; w++)
+                   {
+                       workers[w].sortKey = w;
+                       recorded.push_back(&workers[w]);
+                   }
+                   Engine::Batch batch;
+                   state.setItems(QUADS);
+                   while (state.run())
+                   {
+                       std::vector<std::thread> threads;
+                       for (int w = 0; w < WORKERS; w++)
+                       {
+                           threads.emplace_back([&workers, w]()
+                                                {
+                                                    for (int i = w; i < QUADS; i += WORKERS)
+                                                        workers[w].quad({(float)(i % 640), (float)(i / 640)}, {8.0f, 8.0f}, 0xffffff);
+                                                });
+                       }
+                       for (auto &thread : threads)
+                           thread.join();
+                       batch.merge(recorded);
+                       batch.clear();
+                       for (auto &worker : workers)
+                           worker.clear();
+                   }
+               });
+
+    Bench::add("Batch::str", [](Bench::State &state)
+               {
+                   auto fontName = benchFont(state);
+                   if (fontName.empty())
+                       return;
+                   Engine::Font font{fontName, 16};
+                   Engine::Batch batch;
+                   std::string text{TEXT};
+                   state.setItems((int64_t)text.size() * 100);
+                   while (state.run())
+                   {
+                       for (int i = 0; i < 100; i++)
+                           batch.str(font, text, {0.0f, i * 16.0f}, 0xffffff);
+                       batch.clear();
+                   }
+               });
+
+    // Building + submitting the batch to an offscreen target, glFinish makes the GPU time part of the measurement.
+    // Run on Mesa llvmpipe for stable numbers: LIBGL_ALWAYS_SOFTWARE=1
+    Bench::add("Batch::render", [](Bench::State &state)
+               {
+                   if (Engine::Application::isHeadless())
+                   {
+                       state.skip("headless, no GL backend");
+                       return;
+                   }
+                   Engine::Batch batch;
+                   auto target = Engine::FrameBuffer::create(640, 360);
+                   auto texture = Engine::Texture::create(64, 64, Engine::TextureFormat::RGBA);
+                   state.setItems(QUADS);
+                   while (state.run())
+                   {
+                       for (int i = 0; i < QUADS; i++)
+                           batch.tex(texture, {(float)(i % 640), (float)(i / 640)}, 0xffffff);
+                       batch.render(target);
+                       batch.clear();
+                       glFinish();
+                   }
+               });
+
+    Bench::add("Font::Font", [](Bench::State &state)
+               {
+                   auto fontName = benchFont(state);
+                   if (fontName.empty())
+                       return;
+                   while (state.run())
+                   {
+                       Engine::Font font{fontName, 16};
+                       Bench::doNotOptimize(font.ascent);
+                   }
+               });
+}
@@ -0,0 +1,179 @@
+#include "Bench.h"
+#include "Log.h"
+#include <json/json.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+
+using json = nlohmann::json;
+
+namespace Bench
+{
+    namespace
+    {
+        // A run shorter than this is too noisy to be trusted
+        constexpr double MIN_RUN_NANOS = 50e6;
+        constexpr int SAMPLES = 5;
+        constexpr uint64_t MAX_ITERATIONS = 1ull << 30;
+        // Stop growing the iteration count once a run takes this long in real time
+        // (benchmarks that pause() can measure very little while spending a lot on setup)
+        constexpr uint64_t MAX_RUN_WALL_NANOS = 2000000000ull;
+
+        struct Entry
+        {
+            std::string name;
+            Function function;
+            int64_t arg;
+            bool parameterised;
+        };
+
+        std::vector<Entry> &registry()
+        {
+            static std::vector<Entry> entries;
+            return entries;
+        }
+
+        uint64_t now()
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       std::chrono::steady_clock::now().time_since_epoch())
+                .count();
+        }
+
+        std::string displayName(const Entry &entry)
+        {
+            if (!entry.parameterised)
+                return entry.name;
+            return entry.name + "/" + std::to_string(entry.arg);
+        }
+
+        // Runs the benchmark once with the given iteration count
+        State measure(const Entry &entry, uint64_t iterations, uint64_t *wallNanos = nullptr)
+        {
+            State state{iterations, entry.arg};
+            uint64_t start = now();
+            entry.function(state);
+            state.finish();
+            if (wallNanos)
+                *wallNanos = now() - start;
+            return state;
+        }
+    }
+
+    bool State::run()
+    {
+        if (!started)
+        {
+            started = true;
+            remaining = iterations;
+            start = now();
+        }
+        if (remaining > 0)
+        {
+            remaining--;
+            return true;
+        }
+        elapsed += now() - start;
+        return false;
+    }
+
+    void State::finish()
+    {
+        // a benchmark that returned before finishing its loop still gets its time recorded
+        if (started && remaining > 0)
+        {
+            elapsed += now() - start;
+            remaining = 0;
+        }
+    }
+
+    void State::pause()
+    {
+        pausedAt = now();
+    }
+
+    void State::resume()
+    {
+        start += now() - pausedAt;
+    }
+
+    void State::skip(const std::string &reason)
+    {
+        skipReason = reason;
+    }
+
+    void add(const std::string &name, Function function, std::vector<int64_t> args)
+    {
+        bool parameterised = args.size() > 1 || (args.size() == 1 && args[0] != 0);
+        for (auto arg : args)
+            registry().push_back({name, function, arg, parameterised});
+    }
+
+    bool runAll()
+    {
+        const char *filter = std::getenv("ENGINE_BENCH_FILTER");
+        const char *output = std::getenv("ENGINE_BENCH_OUT");
+
+        json results = json::array();
+        printf("%-40s %12s %14s %14s %14s %16s\n", "benchmark", "iterations", "ns/op", "min ns/op", "max ns/op", "items/s");
+
+        for (auto &entry : registry())
+        {
+            auto name = displayName(entry);
+            if (filter && name.find(filter) == std::string::npos)
+                continue;
+
+            // find an iteration count that makes a run long enough
+            uint64_t iterations = 1;
+            uint64_t wall = 0;
+            State calibration = measure(entry, iterations, &wall);
+            while (calibration.skipped().empty() && calibration.elapsedNanos() < MIN_RUN_NANOS &&
+                   iterations < MAX_ITERATIONS && wall < MAX_RUN_WALL_NANOS)
+            {
+                double perIteration = std::max(1.0, (double)calibration.elapsedNanos() / iterations);
+                auto target = (uint64_t)(MIN_RUN_NANOS * 1.2 / perIteration);
+                iterations = std::clamp<uint64_t>(target, iterations * 2, iterations * 100);
+                calibration = measure(entry, iterations, &wall);
+            }
+
+            if (!calibration.skipped().empty())
+            {
+                printf("%-40s skipped: %s\n", name.c_str(), calibration.skipped().c_str());
+                results.push_back({{"name", name}, {"skipped", calibration.skipped()}});
+                continue;
+            }
+
+            std::vector<double> samples;
+            samples.reserve(SAMPLES);
+            for (int i = 0; i < SAMPLES; i++)
+                samples.push_back((double)measure(entry, iterations).elapsedNanos() / iterations);
+            std::sort(samples.begin(), samples.end());
+
+            double median = samples[SAMPLES / 2];
+            double itemsPerSecond = calibration.items() > 0 ? calibration.items() * 1e9 / median : 0.0;
+            printf("%-40s %12llu %14.1f %14.1f %14.1f %16.0f\n",
+                   name.c_str(), (unsigned long long)iterations, median, samples.front(), samples.back(), itemsPerSecond);
+
+            results.push_back({{"name", name},
+                               {"iterations", iterations},
+                               {"ns_per_op", median},
+                               {"min_ns_per_op", samples.front()},
+                               {"max_ns_per_op", samples.back()},
+                               {"items_per_second", itemsPerSecond}});
+        }
+
+        if (output)
+        {
+            std::ofstream writer(output);
+            if (!writer.is_open())
+            {
+                ENGINE_CORE_ERROR("Could not write benchmark results to {}", output);
+                return false;
+            }
+            writer << results.dump(2);
+        }
+        return true;
+    }
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// A small benchmark harness.
+// Each benchmark is a function that loops `while (state.run())`, the harness calls it with an increasing
+// iteration count until a run takes long enough to be measured, then takes SAMPLES runs and reports the median.
+//
+// Filter benchmarks with ENGINE_BENCH_FILTER=<substring> and write the results as json with ENGINE_BENCH_OUT=<file>.
+namespace Bench
+{
+    // Keeps the compiler from optimising away a value the benchmark doesn't otherwise use
+    template <class T>
+    inline void doNotOptimize(const T &value)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : "r,m"(value) : "memory");
+#else
+        const volatile T *sink = &value;
+        (void)sink;
+#endif
+    }
+
+    class State
+    {
+    public:
+        State(uint64_t iterations, int64_t arg) : iterations{iterations}, arg{arg} {}
+
+        // Returns true `iterations` times. Time is measured from the first call until it returns false.
+        bool run();
+
+        // Excludes per iteration setup from the measurement
+        void pause();
+        void resume();
+
+        // Marks the benchmark as not applicable (missing asset, no GPU...)
+        void skip(const std::string &reason);
+
+        // Work done per iteration (quads, entities, bytes...) to report a throughput
+        void setItems(int64_t items) { itemsPerIteration = items; }
+
+        // Called by the harness once the benchmark function returned
+        void finish();
+
+        [[nodiscard]] uint64_t elapsedNanos() const { return elapsed; }
+        [[nodiscard]] int64_t items() const { return itemsPerIteration; }
+        [[nodiscard]] const std::string &skipped() const { return skipReason; }
+
+        uint64_t iterations;
+        // Parameter the benchmark was registered with (entity count, density...)
+        int64_t arg;
+
+    private:
+        uint64_t remaining = 0;
+        bool started = false;
+        uint64_t start = 0;
+        uint64_t pausedAt = 0;
+        uint64_t elapsed = 0;
+        int64_t itemsPerIteration = 0;
+        std::string skipReason;
+    };
+
+    using Function = std::function<void(State &)>;
+
+    // Registers a benchmark, one entry is reported per arg
+    void add(const std::string &name, Function function, std::vector<int64_t> args = {0});
+
+    // Runs every registered benchmark matching the filter. Returns false if the json output couldn't be written.
+    bool runAll();
+}
@@ -0,0 +1,101 @@
+#include "Bench.h"
+#include "Engine.h"
+#include "TexturePacker.h"
+#include "ImageOps.h"
+#include <fstream>
+#include <random>
+
+void registerContentBenchmarks()
+{
+    // arg = number of entries, sized between 8x8 and 64x64
+    Bench::add("TexturePacker::pack", [](Bench::State &state)
+               {
+                   std::mt19937 random{42};
+                   std::uniform_int_distribution<int> size{8, 64};
+                   std::vector<glm::ivec2> sizes;
+                   std::vector<std::vector<Engine::Color>> pixels;
+                   for (int64_t i = 0; i < state.arg; i++)
+                   {
+                       auto &entry = sizes.emplace_back(size(random), size(random));
+                       pixels.emplace_back(entry.x * entry.y);
+                   }
+
+                   state.setItems(state.arg);
+                   while (state.run())
+                   {
+                       Engine::TexturePacker packer;
+                       for (int64_t i = 0; i < state.arg; i++)
+                           packer.addEntry((int)i, sizes[i].x, sizes[i].y, pixels[i].data());
+                       Bench::doNotOptimize(packer.pack());
+                   }
+               },
+               {16, 64});
+
+    Bench::add("Aseprite::Aseprite", [](Bench::State &state)
+               {
+                   auto file = Content::path().append("webman.ase");
+                   if (!std::ifstream(file).good())
+                   {
+                       state.skip("missing " + file);
+                       return;
+                   }
+                   while (state.run())
+                   {
+                       Engine::Aseprite aseprite{file};
+                       Bench::doNotOptimize(aseprite.frames.size());
+                   }
+               });
+
+    // decode only, without the file read
+    Bench::add("Aseprite::decode", [](Bench::State &state)
+               {
+                   std::ifstream reader(Content::path().append("webman.ase"), std::ios::binary);
+                   if (!reader.good())
+                   {
+                       state.skip("missing webman.ase");
+                       return;
+                   }
+                   std::vector<uint8_t> data((std::istreambuf_iterator<char>(reader)), std::istreambuf_iterator<char>());
+                   while (state.run())
+                   {
+                       Engine::Aseprite aseprite{data.data(), data.size()};
+                       Bench::doNotOptimize(aseprite.frames.size());
+                   }
+               });
+
+    // arg = pixels per call
+    Bench::add("ImageOps::paletteLookup", [](Bench::State &state)
+               {
+                   std::vector<uint8_t> indices(state.arg);
+                   for (int64_t i = 0; i < state.arg; i++)
+                       indices[i] = (uint8_t)(i * 7);
+                   std::vector<Engine::Color> palette(256, Engine::Color(0x336699));
+                   std::vector<Engine::Color> pixels(state.arg);
+                   state.setItems(state.arg);
+                   while (state.run())
+                   {
+                       Engine::ImageOps::paletteLookup(pixels.data(), indices.data(), indices.size(), palette.data(), palette.size(), 0);
+                       Bench::doNotOptimize(pixels.data());
+                   }
+               },
+               {4096, 1 << 20});
+
+    Bench::add("ImageOps::alphaToRGBA", [](Bench::State &state)
+               {
+                   std::vector<uint8_t> alpha(state.arg, 0x80);
+                   std::vector<Engine::Color> pixels(state.arg);
+                   state.setItems(state.arg);
+                   while (state.run())
+                   {
+                       Engine::ImageOps::alphaToRGBA(pixels.data(), alpha.data(), alpha.size());
+                       Bench::doNotOptimize(pixels.data());
+                   }
+               },
+               {4096, 1 << 20});
+
+    Bench::add("Content::load", [](Bench::State &state)
+               {
+                   while (state.run())
+                       Content::load();
+               });
+}
@@ -0,0 +1,216 @@
+#include "Bench.h"
+#include "Engine.h"
+#include "Collider.h"
+#include "Transforms.h"
+#include "Animators.h"
+#include "Sprite.h"
+#include <map>
+#include <random>
+
+namespace
+{
+    struct Mover : public Engine::Component
+    {
+        glm::ivec2 velocity{1, 0};
+
+        void update() override
+        {
+            entity->position += velocity;
+            if (entity->position.x > 640)
+                entity->position.x = 0;
+        }
+    };
+
+    struct Dot : public Engine::Component
+    {
+        void render(Engine::Batch &batch) override
+        {
+            batch.quad(entity->position, {4.0f, 4.0f}, 0xffffff);
+        }
+    };
+
+    // Distinct component types to fill an entity with
+    template <int N>
+    struct Tag : public Engine::Component
+    {
+    };
+
+    // Worlds are built once per size and kept (leaked) for the whole run: the harness calls each benchmark
+    // several times and tearing a World down is quadratic in its entity count (see World::destroyEntity)
+    template <class Setup>
+    Engine::World &sharedWorld(std::map<int64_t, Engine::World *> &cache, int64_t arg, Setup setup)
+    {
+        auto &world = cache[arg];
+        if (!world)
+        {
+            world = new Engine::World();
+            setup(*world, arg);
+        }
+        return *world;
+    }
+
+    void populate(Engine::World &world, int64_t count)
+    {
+        std::mt19937 random{42};
+        std::uniform_int_distribution<int> x{0, 640};
+        std::uniform_int_distribution<int> y{0, 360};
+        for (int64_t i = 0; i < count; i++)
+        {
+            auto *entity = world.addEntity({(float)x(random), (float)y(random)});
+            entity->add<Mover>();
+            auto &dot = entity->add<Dot>();
+            dot.depth = (int)(i % 8);
+        }
+    }
+}
+
+void registerEcsBenchmarks()
+{
+    const std::vector<int64_t> entityCounts{1000, 10000, 100000};
+
+    Bench::add("World::update", [](Bench::State &state)
+               {
+                   static std::map<int64_t, Engine::World *> worlds;
+                   auto &world = sharedWorld(worlds, state.arg, populate);
+                   state.setItems(state.arg);
+                   while (state.run())
+                       world.update();
+               },
+               entityCounts);
+
+    Bench::add("World::render", [](Bench::State &state)
+               {
+                   static std::map<int64_t, Engine::World *> worlds;
+                   auto &world = sharedWorld(worlds, state.arg, populate);
+                   Engine::Batch batch;
+                   state.setItems(state.arg);
+                   while (state.run())
+                   {
+                       world.render<Dot>(batch);
+                       batch.clear();
+                   }
+               },
+               entityCounts);
+
+    // arg = number of actors, each with a child (weapon) that has a child of its own (muzzle flash).
+    // Every iteration moves every actor, so every root follows its entity and the whole hierarchy is recomputed.
+    Bench::add("Transforms::update", [](Bench::State &state)
+               {
+                   static std::map<int64_t, Engine::World *> worlds;
+                   auto &world = sharedWorld(worlds, state.arg, [](Engine::World &world, int64_t count)
+                                             {
+                                                 populate(world, count);
+                                                 for (auto *actor : world.componentsOfType<Mover>())
+                                                 {
+                                                     auto &root = actor->add<Engine::Transform>();
+                                                     auto &weapon = world.addEntity()->add<Engine::Transform>(glm::vec2{8.0f, 0.0f}, 0.5f);
+                                                     auto &flash = world.addEntity()->add<Engine::Transform>(glm::vec2{4.0f, 0.0f});
+                                                     weapon.setParent(&root);
+                                                     flash.setParent(&weapon);
+                                                 }
+                                             });
+                   auto &transforms = world.getTransforms();
+                   auto movers = world.componentsOfType<Mover>();
+                   state.setItems((int64_t)transforms.size());
+                   while (state.run())
+                   {
+                       for (auto *mover : movers)
+                           mover->update();
+                       transforms.update();
+                   }
+               },
+               {1000, 10000, 100000});
+
+    // arg = number of animated sprites, each on a 6 frame ping pong loop with frames of different lengths
+    Bench::add("Animators::update", [](Bench::State &state)
+               {
+                   static Engine::Animation animation = []()
+                   {
+                       Engine::Animation animation;
+                       animation.direction = Engine::Animation::Direction::PingPong;
+                       for (int i = 0; i < 6; i++)
+                           animation.frames.push_back(Engine::Frame{Engine::Subtexture(), 50 + i * 20});
+                       animation.buildTimeline();
+                       return animation;
+                   }();
+                   Engine::Animators animators;
+                   for (int64_t i = 0; i < state.arg; i++)
+                   {
+                       auto handle = animators.create(nullptr);
+                       animators.setAnimation(handle, &animation);
+                       // spread out so the frames don't all change on the same step
+                       animators.seek(handle, (float)(i * 37));
+                   }
+                   state.setItems(state.arg);
+                   while (state.run())
+                       animators.update(1.0f / 60.0f);
+               },
+               {1000, 10000, 100000});
+
+    // arg = number of particles alive, they live longer than the run so the count stays the same
+    Bench::add("ParticleEmitter::update", [](Bench::State &state)
+               {
+                   Engine::World world;
+                   auto &emitter = world.addEntity({320.0f, 180.0f})->add<Engine::ParticleEmitter>("particle", (size_t)state.arg);
+                   emitter.gravity = {0.0f, 98.0f};
+                   emitter.drag = 0.5f;
+                   emitter.minLife = emitter.maxLife = 1e6f;
+                   emitter.burst((int)state.arg);
+                   state.setItems(state.arg);
+                   while (state.run())
+                       emitter.update();
+               },
+               {1000, 10000, 50000});
+
+    // arg = number of 16x16 colliders spread over a 1024x1024 area, each iteration runs 100 checks
+    Bench::add("Collider::check", [](Bench::State &state)
+               {
+                   static std::map<int64_t, Engine::World *> worlds;
+                   auto &world = sharedWorld(worlds, state.arg, [](Engine::World &world, int64_t count)
+                                             {
+                                                 std::mt19937 random{42};
+                                                 std::uniform_int_distribution<int> position{0, 1024 - 16};
+                                                 for (int64_t i = 0; i < count; i++)
+                                                 {
+                                                     auto *entity = world.addEntity({(float)position(random), (float)position(random)});
+                                                     auto rect = Engine::RectI(0, 0, 16, 16);
+                                                     auto &collider = entity->add<Collider>(rect);
+                                                     collider.mask = Collider::Mask::SOLID;
+                                                 }
+                                             });
+                   auto colliders = world.componentsOfType<Collider>();
+                   std::vector<Collider *> probes{colliders.begin(), colliders.end()};
+
+                   state.setItems(100);
+                   size_t probe = 0;
+                   while (state.run())
+                   {
+                       for (int i = 0; i < 100; i++)
+                       {
+                           Bench::doNotOptimize(probes[probe]->check(Collider::Mask::SOLID));
+                           probe = (probe + 1) % probes.size();
+                       }
+                   }
+               },
+               {100, 1000, 10000});
+
+    Bench::add("Entity::get", [](Bench::State &state)
+               {
+                   Engine::World world;
+                   auto *entity = world.addEntity();
+                   entity->add<Tag<0>>();
+                   entity->add<Tag<1>>();
+                   entity->add<Tag<2>>();
+                   entity->add<Tag<3>>();
+                   entity->add<Tag<4>>();
+                   entity->add<Tag<5>>();
+                   entity->add<Tag<6>>();
+                   entity->add<Tag<7>>();
+                   while (state.run())
+                   {
+                       // first and last component, best and worst case of the linear search
+                       Bench::doNotOptimize(entity->get<Tag<0>>());
+                       Bench::doNotOptimize(entity->get<Tag<7>>());
+                   }
+               });
+}
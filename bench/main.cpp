@@ -0,0 +1,40 @@
+#include "Bench.h"
+#include "Engine.h"
+
+void registerBatchBenchmarks();
+void registerEcsBenchmarks();
+void registerContentBenchmarks();
+
+// Runs every benchmark from the first update() and quits.
+// Use --headless for the null graphics backend, otherwise rendering benchmarks need a GL driver
+// (LIBGL_ALWAYS_SOFTWARE=1 to use Mesa llvmpipe).
+class BenchApplication : public Engine::Application
+{
+public:
+    BenchApplication() : Engine::Application("engine bench", 640, 360, false)
+    {
+        registerBatchBenchmarks();
+        registerEcsBenchmarks();
+        registerContentBenchmarks();
+    }
+
+    void update() override
+    {
+        if (!Bench::runAll())
+            ENGINE_ERROR("Benchmark results could not be saved");
+        isRunning = false;
+    }
+
+    void render() override
+    {
+    }
+
+    void handleEvent(SDL_Event &event) override
+    {
+    }
+};
+
+Engine::Application *Engine::createApplication()
+{
+    return new BenchApplication();
+}
@@ -4,6 +4,9 @@
 #include "../src/Application.h"
 #include "../src/graphics/FrameBuffer.h"
 #include "../src/graphics/Batch.h"
+#include "../src/graphics/GpuProfiler.h"
+#include "../src/graphics/Readback.h"
+#include "../src/graphics/RenderGraph.h"
 #include "../src/graphics/Sprite.h"
 #include "../src/image/Aseprite.h"
 #include "time/time.h"
@@ -12,7 +15,9 @@
 #include "Entity.h"
 #include "Entity.hpp"
 #include "Log.h"
+#include "Profiler.h"
 #include "Input.h"
+#include "Audio.h"
 #include "Content.h"
 #include "KeyCodes.h"
 
@@ -21,4 +26,7 @@
 #include "Kinetic.h"
 #include "CameraComponent.h"
 #include "TileMapComponent.h"
-#include "Hurtable.h"
\ No newline at end of file
+#include "Hurtable.h"
+#include "SoundEmitter.h"
+#include "Transform.h"
+#include "ParticleEmitter.h"
\ No newline at end of file
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <glm/glm.hpp>
+
+namespace Engine
+{
+    // Index of a sound in the bank, returned by Audio::load / Audio::find
+    using SoundId = uint32_t;
+
+    // A playing sound. Handles stay safe to use after the sound ends or its voice is reused, they just stop working.
+    struct Voice
+    {
+        // voice slot + 1 in the low byte, the slot's generation above it (0 is never a valid voice)
+        uint32_t id = 0;
+
+        [[nodiscard]] bool valid() const { return id != 0; }
+    };
+
+    // Sound effects are decoded when loaded (during Content::load) into a bank and played by SoundId, playing
+    // does no file or string work. A fixed pool of voices plays them, when every voice is busy the voice with the
+    // lowest priority (the oldest one among equals) is stolen, unless the new sound's priority is lower still.
+    // Music is streamed from its file by the mixer thread.
+    // Headless applications get a null backend: nothing is heard, but voices play for the sound's duration.
+    // Every call must be made from the main thread.
+    class Audio
+    {
+    public:
+        static constexpr SoundId INVALID_SOUND = UINT32_MAX;
+        static constexpr int MAX_VOICES = 32;
+
+        enum class Bus
+        {
+            Music,
+            Effects,
+            Interface,
+            Count
+        };
+
+        // Distance from the listener at which spatial sounds go silent (and are fully panned)
+        static float range;
+
+        // Opens the audio device, called by the Application before Content::load
+        static void init();
+
+        // Stops everything, frees the bank and closes the device
+        static void shutdown();
+
+        // Frees the voices that finished and applies volume / position changes, called by the Application every step
+        static void update();
+
+        // Decodes a sound file (relative to Content::path()) into the bank. Loading the same file again returns its id.
+        static SoundId load(const std::string &file, Bus bus = Bus::Effects, int priority = 0);
+
+        // Id of a loaded sound, INVALID_SOUND if it isn't in the bank
+        static SoundId find(const std::string &file);
+
+        static Voice play(SoundId sound, float volume = 1.0f, bool loop = false);
+
+        // Plays a sound panned and attenuated by its distance to the listener
+        static Voice playAt(SoundId sound, const glm::vec2 &position, float volume = 1.0f, bool loop = false);
+
+        static void stop(Voice voice);
+
+        [[nodiscard]] static bool isPlaying(Voice voice);
+
+        // Moves a spatial voice, ex. to follow its entity (see SoundEmitter)
+        static void setPosition(Voice voice, const glm::vec2 &position);
+
+        static void setVolume(Voice voice, float volume);
+
+        static void setListener(const glm::vec2 &position);
+
+        static void setBusVolume(Bus bus, float volume);
+
+        [[nodiscard]] static float getBusVolume(Bus bus);
+
+        static void setMasterVolume(float volume);
+
+        // Streams a music file (relative to Content::path()) on the Music bus, replacing the current one
+        static bool playMusic(const std::string &file, bool loop = true);
+
+        static void stopMusic();
+
+        // Voices playing right now
+        [[nodiscard]] static int activeVoices();
+
+    private:
+        Audio() = default;
+    };
+}
@@ -30,6 +30,7 @@ public:
 
     static std::vector<MapInfo> getMaps();
 
+    // Logs an error and returns nullptr if there is no sprite with that name
     static Engine::Sprite *findSprite(const std::string &name);
 
     static MapInfo *findMapInfo(const glm::ivec2 &position);
@@ -1,8 +1,12 @@
 #pragma once
 
+#include <cstdint>
+#include <string>
 #include <utility>
 #include "KeyCodes.h"
 
+union SDL_Event;
+
 namespace Engine {
     enum Mouse {
         BUTTON_LEFT = 1,
@@ -10,12 +14,124 @@ namespace Engine {
         BUTTON_RIGHT = 3,
     };
 
+    // SDL_GameControllerButton values (Xbox layout names)
+    enum class GamepadButton {
+        A,
+        B,
+        X,
+        Y,
+        Back,
+        Guide,
+        Start,
+        LeftStick,
+        RightStick,
+        LeftShoulder,
+        RightShoulder,
+        DpadUp,
+        DpadDown,
+        DpadLeft,
+        DpadRight,
+    };
+
+    // SDL_GameControllerAxis values, sticks go from -1 to 1 and triggers from 0 to 1
+    enum class GamepadAxis {
+        LeftX,
+        LeftY,
+        RightX,
+        RightY,
+        LeftTrigger,
+        RightTrigger,
+        Count
+    };
+
+    // A key, mouse or gamepad button changing during a step, in the order they happened
+    struct InputEvent {
+        enum Type : uint8_t {
+            KeyDown,
+            KeyUp,
+            MouseDown,
+            MouseUp,
+            GamepadDown,
+            GamepadUp,
+        };
+
+        Type type;
+        // gamepad slot, for gamepad events
+        uint8_t gamepad;
+        // Key, Mouse or GamepadButton
+        uint16_t code;
+        // seconds between the event and the snapshot (when the step started), for sub-step timing
+        float age;
+    };
+
+    struct GamepadState {
+        bool connected = false;
+        // bit n is GamepadButton n
+        uint32_t buttons = 0;
+        uint32_t pressed = 0;
+        uint32_t released = 0;
+        // raw values, Input::axis() applies the dead zone
+        float axes[(int) GamepadAxis::Count]{};
+    };
+
+    // Everything the game can query about its input during one simulation step.
+    // Plain data, a snapshot can be copied, compared and written to a recording as is.
+    struct InputState {
+        // Matches SDL_NUM_SCANCODES, keys are indexed by scancode
+        static constexpr int KEY_COUNT = 512;
+        static constexpr int MAX_GAMEPADS = 4;
+        static constexpr int MAX_EVENTS = 32;
+        static constexpr int TEXT_SIZE = 32;
+
+        // Key flags, a key can be pressed and released in the same step (a tap shorter than a step)
+        static constexpr uint8_t KEY_DOWN = 1;
+        static constexpr uint8_t KEY_PRESSED = 2;
+        static constexpr uint8_t KEY_RELEASED = 4;
+
+        uint8_t keys[KEY_COUNT]{};
+        // SDL_BUTTON masks: held, and went down / up during the step
+        uint32_t mouseButtons = 0;
+        uint32_t mousePressed = 0;
+        uint32_t mouseReleased = 0;
+        float mouseX = 0.0f;
+        float mouseY = 0.0f;
+        // wheel movement during the step
+        float wheelX = 0.0f;
+        float wheelY = 0.0f;
+        GamepadState gamepads[MAX_GAMEPADS];
+        // UTF-8 text typed during the step (null terminated, cut at TEXT_SIZE - 1 bytes)
+        char text[TEXT_SIZE]{};
+        // the first MAX_EVENTS button changes of the step
+        InputEvent events[MAX_EVENTS]{};
+        uint8_t eventCount = 0;
+    };
+
+    // Input is sampled once per simulation step into a snapshot, so every update() of the same step
+    // sees the same state and a recorded session can be re-simulated exactly.
+    // Devices are read from the SDL events the Application forwards to event(), nothing queries SDL directly.
+    // Queries only read the snapshot, which changes between steps (poll / update), so systems running on
+    // worker threads during a step can query input. Bind actions and axes before the game starts stepping.
     class Input {
     public:
+        enum class Source {
+            // Keyboard, mouse and gamepad state come from SDL events
+            Devices,
+            // State is only changed through setKey / setMouseButton / setMousePosition (headless runs, bots)
+            Scripted,
+            // State is read back from a recording
+            Replay,
+        };
+
+        // Stick values under this are reported as 0 by axis()
+        static float deadZone;
+
         static bool down(Engine::Key key);
         static bool pressed(Engine::Key key);
+        static bool released(Engine::Key key);
 
+        static bool down(Engine::Mouse button);
         static bool pressed(Engine::Mouse button);
+        static bool released(Engine::Mouse button);
 
         static float getMouseX();
 
@@ -23,7 +139,67 @@ namespace Engine {
 
         static std::pair<float, float> getMousePosition();
 
+        // Wheel movement during the step
+        static std::pair<float, float> getMouseWheel();
+
+        static bool connected(int gamepad);
+        static bool down(GamepadButton button, int gamepad = 0);
+        static bool pressed(GamepadButton button, int gamepad = 0);
+        static bool released(GamepadButton button, int gamepad = 0);
+        static float axis(GamepadAxis axis, int gamepad = 0);
+
+        // UTF-8 text typed during the step
+        static const char *text();
+
+        // Binds a key / button to a named action, an action can have any number of bindings.
+        // A gamepad of -1 means any gamepad.
+        static void bindAction(const std::string &action, Engine::Key key);
+        static void bindAction(const std::string &action, Engine::Mouse button);
+        static void bindAction(const std::string &action, GamepadButton button, int gamepad = -1);
+
+        // Binds a pair of keys (-1 and 1) or a gamepad axis to a named axis, the strongest binding wins
+        static void bindAxis(const std::string &axis, Engine::Key negative, Engine::Key positive);
+        static void bindAxis(const std::string &axis, GamepadAxis gamepadAxis, int gamepad = -1);
+
+        static void clearBindings();
+
+        // Actions, true if any binding is
+        static bool down(const std::string &action);
+        static bool pressed(const std::string &action);
+        static bool released(const std::string &action);
+
+        // -1 to 1
+        static float axis(const std::string &axis);
+
+        // Feeds an SDL event to the device state, the Application forwards every event it polls
+        static void event(const SDL_Event &event);
+
+        // Samples the current source into the snapshot. Called by the Application before each simulation step.
+        static void poll();
+
+        // Ends the current step: pressed / released flags, wheel, text and events are cleared
         static void update();
+
+        static void setSource(Source source);
+        static Source getSource();
+
+        // Scripted input, only has an effect when the source is Source::Scripted
+        static void setKey(Engine::Key key, bool down);
+        static void setMouseButton(Engine::Mouse button, bool down);
+        static void setMousePosition(float x, float y);
+
+        [[nodiscard]] static const InputState &state();
+
+        // Writes the input of every following step to a file. The seed is stored alongside it
+        // so the replay can restore the game's random state.
+        static bool startRecording(const std::string &path, uint32_t seed);
+        static void stopRecording();
+
+        // Switches the source to Source::Replay. Outputs the seed the recording was made with.
+        static bool startReplay(const std::string &path, uint32_t &seed);
+
+        // True once a replay reached the step its recording was stopped at
+        static bool replayFinished();
     };
 
-}
\ No newline at end of file
+}
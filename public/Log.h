@@ -1,47 +1,102 @@
 #pragma once
 
+// Log calls below SPDLOG_ACTIVE_LEVEL compile to nothing (their arguments aren't evaluated), see ENGINE_LOG_LEVEL in CMakeLists.txt
+#ifndef SPDLOG_ACTIVE_LEVEL
+#define SPDLOG_ACTIVE_LEVEL SPDLOG_LEVEL_TRACE
+#endif
+
+#include <array>
 #include <spdlog/spdlog.h>
 
 // Core log macros
-#define ENGINE_CORE_TRACE(...) ::Engine::Log::getCoreLogger()->trace(__VA_ARGS__)
-#define ENGINE_CORE_INFO(...) ::Engine::Log::getCoreLogger()->info(__VA_ARGS__)
-#define ENGINE_CORE_WARN(...) ::Engine::Log::getCoreLogger()->warn(__VA_ARGS__)
-#define ENGINE_CORE_ERROR(...) ::Engine::Log::getCoreLogger()->error(__VA_ARGS__)
-#define ENGINE_CORE_FATAL(...) ::Engine::Log::getCoreLogger()->fatal(__VA_ARGS__)
+#define ENGINE_CORE_TRACE(...) SPDLOG_LOGGER_TRACE(::Engine::Log::getCoreLogger(), __VA_ARGS__)
+#define ENGINE_CORE_INFO(...) SPDLOG_LOGGER_INFO(::Engine::Log::getCoreLogger(), __VA_ARGS__)
+#define ENGINE_CORE_WARN(...) SPDLOG_LOGGER_WARN(::Engine::Log::getCoreLogger(), __VA_ARGS__)
+#define ENGINE_CORE_ERROR(...) SPDLOG_LOGGER_ERROR(::Engine::Log::getCoreLogger(), __VA_ARGS__)
+#define ENGINE_CORE_FATAL(...) SPDLOG_LOGGER_CRITICAL(::Engine::Log::getCoreLogger(), __VA_ARGS__)
 
 // Client log macros
-#define ENGINE_TRACE(...) ::Engine::Log::getClientLogger()->trace(__VA_ARGS__)
-#define ENGINE_INFO(...) ::Engine::Log::getClientLogger()->info(__VA_ARGS__)
-#define ENGINE_WARN(...) ::Engine::Log::getClientLogger()->warn(__VA_ARGS__)
-#define ENGINE_ERROR(...) ::Engine::Log::getClientLogger()->error(__VA_ARGS__)
-#define ENGINE_FATAL(...) ::Engine::Log::getClientLogger()->fatal(__VA_ARGS__)
+#define ENGINE_TRACE(...) SPDLOG_LOGGER_TRACE(::Engine::Log::getClientLogger(), __VA_ARGS__)
+#define ENGINE_INFO(...) SPDLOG_LOGGER_INFO(::Engine::Log::getClientLogger(), __VA_ARGS__)
+#define ENGINE_WARN(...) SPDLOG_LOGGER_WARN(::Engine::Log::getClientLogger(), __VA_ARGS__)
+#define ENGINE_ERROR(...) SPDLOG_LOGGER_ERROR(::Engine::Log::getClientLogger(), __VA_ARGS__)
+#define ENGINE_FATAL(...) SPDLOG_LOGGER_CRITICAL(::Engine::Log::getClientLogger(), __VA_ARGS__)
+
+// Subsystem log macros, ex. ENGINE_LOG_WARN(Graphics, "Texture {} is too large", name)
+#define ENGINE_LOG_TRACE(category, ...) SPDLOG_LOGGER_TRACE(::Engine::Log::get(::Engine::Log::Category::category), __VA_ARGS__)
+#define ENGINE_LOG_INFO(category, ...) SPDLOG_LOGGER_INFO(::Engine::Log::get(::Engine::Log::Category::category), __VA_ARGS__)
+#define ENGINE_LOG_WARN(category, ...) SPDLOG_LOGGER_WARN(::Engine::Log::get(::Engine::Log::Category::category), __VA_ARGS__)
+#define ENGINE_LOG_ERROR(category, ...) SPDLOG_LOGGER_ERROR(::Engine::Log::get(::Engine::Log::Category::category), __VA_ARGS__)
 
+// Only checked in debug builds, the condition isn't evaluated when NDEBUG is defined
+#ifdef NDEBUG
 #define ENGINE_ASSERT(condition, ...) \
-    if (!(condition))                 \
+    do                                \
     {                                 \
-        ENGINE_ERROR(__VA_ARGS__);    \
-    }
+        (void)sizeof(condition);      \
+    } while (false)
+#else
+#define ENGINE_ASSERT(condition, ...)      \
+    do                                     \
+    {                                      \
+        if (!(condition))                  \
+            ENGINE_CORE_ERROR(__VA_ARGS__); \
+    } while (false)
+#endif
 
 namespace Engine
 {
+    // Loggers are asynchronous: a log call formats the message and queues it, a worker thread writes it out.
+    // When the queue is full the oldest messages are dropped instead of waiting, logging never blocks a frame.
+    // A call site logging more than RATE_LIMIT messages in a second has the rest dropped, the count of
+    // dropped messages is written with the first message it logs after that second.
     class Log
     {
     public:
+        // One logger per subsystem, messages are tagged with its name
+        enum class Category
+        {
+            Core,
+            App,
+            Graphics,
+            Audio,
+            Input,
+            Ecs,
+            Content,
+            Count
+        };
+
+        static constexpr size_t QUEUE_SIZE = 8192;
+        static constexpr int RATE_LIMIT = 20;
+
         static void init();
 
+        // Writes every message to a JSON lines file as well: one object per message with its time, level,
+        // category, thread, source location and text
+        static bool openFile(const std::string &path);
+
+        // Writes out what's queued and stops the worker thread, logging is synchronous after this
+        static void shutdown();
+
+        static void setLevel(Category category, spdlog::level::level_enum level);
+
+        inline static std::shared_ptr<spdlog::logger> &get(Category category)
+        {
+            return loggers[(size_t)category];
+        }
+
         inline static std::shared_ptr<spdlog::logger> &getCoreLogger()
         {
-            return coreLogger;
+            return get(Category::Core);
         }
 
-        inline static std::shared_ptr<spdlog::logger> &getClientLogger() { return clientLogger; }
+        inline static std::shared_ptr<spdlog::logger> &getClientLogger() { return get(Category::App); }
 
         Log();
 
         ~Log();
 
     private:
-        static std::shared_ptr<spdlog::logger> coreLogger;
-        static std::shared_ptr<spdlog::logger> clientLogger;
+        static std::array<std::shared_ptr<spdlog::logger>, (size_t)Category::Count> loggers;
     };
-}
\ No newline at end of file
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// Zones are only recorded when the engine is built with ENGINE_PROFILE defined
+// (cmake -DENGINE_PROFILER=ON). Otherwise every macro expands to nothing.
+#ifdef ENGINE_PROFILE
+#define ENGINE_PROFILE_CONCAT_INNER(a, b) a##b
+#define ENGINE_PROFILE_CONCAT(a, b) ENGINE_PROFILE_CONCAT_INNER(a, b)
+#define ENGINE_PROFILE_SCOPE(name) ::Engine::Profiler::Zone ENGINE_PROFILE_CONCAT(profileZone, __LINE__){name}
+#define ENGINE_PROFILE_FUNCTION() ENGINE_PROFILE_SCOPE(__func__)
+#define ENGINE_PROFILE_FRAME() ::Engine::Profiler::frame()
+#else
+#define ENGINE_PROFILE_SCOPE(name)
+#define ENGINE_PROFILE_FUNCTION()
+#define ENGINE_PROFILE_FRAME()
+#endif
+
+namespace Engine
+{
+    // A CPU frame profiler.
+    // Each thread writes the zones it closes into its own ring buffer (single producer, no locks),
+    // the ImGui view and the Chrome trace exporter only read from them.
+    class Profiler
+    {
+    public:
+        // Number of zones each thread keeps before the oldest ones get overwritten
+        static constexpr uint32_t CAPACITY = 1 << 14;
+
+        // Number of frames kept for the frame time graph
+        static constexpr uint32_t FRAME_HISTORY = 256;
+
+        struct Event
+        {
+            // Must point to a string that outlives the profiler (literals, __func__, typeid names)
+            const char *name;
+            uint64_t start;
+            uint64_t end;
+            uint32_t depth;
+        };
+
+        // Records the time between its construction and destruction. Use ENGINE_PROFILE_SCOPE instead.
+        class Zone
+        {
+        public:
+            explicit Zone(const char *name);
+            ~Zone();
+
+            Zone(const Zone &) = delete;
+            Zone &operator=(const Zone &) = delete;
+
+        private:
+            const char *name;
+            uint64_t start;
+        };
+
+        // Monotonic time in nanoseconds
+        static uint64_t now();
+
+        // Marks the beginning of a new frame (the timeline view shows the last complete frame)
+        static void frame();
+
+        // Names the calling thread in the timeline and in exported traces
+        static void setThreadName(const std::string &name);
+
+        // Stops recording new zones (already recorded ones can still be inspected)
+        static void setPaused(bool paused);
+        static bool isPaused();
+
+        // Draws the frame time graph and a flame/timeline view of the last complete frame
+        static void drawImGui();
+
+        // Writes every zone still in the ring buffers in the Chrome trace event format
+        // (open it with chrome://tracing or https://ui.perfetto.dev)
+        static bool exportChromeTrace(const std::string &path);
+
+    private:
+        Profiler() = default;
+    };
+}
@@ -23,7 +23,7 @@ namespace Engine
         {
         };
 
-        ~Component()
+        virtual ~Component()
         {
         }
 
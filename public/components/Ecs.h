@@ -1,6 +1,7 @@
 #pragma once
 
 #include <list>
+#include <memory>
 #include <vector>
 
 #include "glm/glm.hpp"
@@ -11,6 +12,8 @@ namespace Engine
 {
 
     class Batch;
+    class Transforms;
+    class Animators;
 
     class World {
 
@@ -54,6 +57,12 @@ namespace Engine
 
         void clear();
 
+        // The data of the Transform components, see Transform
+        Transforms &getTransforms() { return *transforms; }
+
+        // The playback state of the SpriteComponents, advanced at the start of every update, see Animators
+        Animators &getAnimators() { return *animators; }
+
         template <class T>
         T *add(Entity *entity, T *component);
 
@@ -99,6 +108,9 @@ namespace Engine
         //  contiguous memory. For now this should do
         std::vector<Component *> components[MAX_COMPONENTS];
 
+        std::unique_ptr<Transforms> transforms;
+        std::unique_ptr<Animators> animators;
+
         void destroyComponent(Component *component);
 
         friend class Entity;
@@ -16,7 +16,10 @@ namespace Engine
 
         std::vector<Component *> components;
 
-        Entity(bool alive, glm::vec2 pos, World *world) : alive{alive}, position{pos}, world{world} {}
+        // false until the world snapshots the entity's position for the first time, see World::update
+        bool tracked = false;
+
+        Entity(bool alive, glm::vec2 pos, World *world) : alive{alive}, world{world}, position{pos}, previousPosition{pos} {}
 
         static Entity* create(bool alive, glm::vec2 pos, World* world) {
             return new Entity(alive, pos, world);
@@ -37,6 +40,15 @@ namespace Engine
 
         glm::ivec2 position;
 
+        // Position at the start of the latest simulation step
+        glm::ivec2 previousPosition;
+
+        // Where to draw the entity this frame: between previousPosition and position, by Time::alpha
+        [[nodiscard]] glm::vec2 renderPosition() const;
+
+        // Moves the entity without interpolating from its old position (spawns, respawns, wrap arounds)
+        void teleport(glm::ivec2 target);
+
         [[nodiscard]] const std::vector<Component *> &getComponents() const;
 
         void remove(Component *component);
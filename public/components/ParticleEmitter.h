@@ -0,0 +1,95 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "Component.h"
+#include "Color.h"
+
+namespace Engine {
+    struct SpriteInstance;
+    class Subtexture;
+
+    // Emits particles drawn with a sprite's first frame, all of them in one Batch::texBatch call.
+    // Particles aren't entities: their state is kept in arrays (one per field) sized once for `capacity` particles,
+    // so emitting never allocates. They are drawn between their last two steps by Time::alpha, like entities.
+    // Particles live in world space, moving the entity doesn't drag the ones already out.
+    // A finished emitter can be kept around and restarted (reset() then burst() or emitting = true) instead of
+    // creating a new entity per effect.
+    class ParticleEmitter : public Component {
+    public:
+        explicit ParticleEmitter(const std::string &sprite, size_t capacity = 1024);
+
+        ~ParticleEmitter() override;
+
+        // Particles emitted per second while `emitting`
+        float rate = 0.0f;
+        bool emitting = true;
+
+        // Emitted from the entity's position plus `offset`, anywhere in `area` (centered on it)
+        glm::vec2 offset{};
+        glm::vec2 area{};
+
+        // Direction (radians, 0 is right) and the random spread around it
+        float angle = 0.0f;
+        float spread = 3.14159265f;
+        float minSpeed = 20.0f;
+        float maxSpeed = 60.0f;
+        // Seconds
+        float minLife = 0.5f;
+        float maxLife = 1.0f;
+
+        glm::vec2 gravity{};
+        // Fraction of the velocity lost per second
+        float drag = 0.0f;
+
+        // Interpolated over each particle's life
+        Color startColor = 0xffffff;
+        Color endColor = 0xffffff;
+        float startScale = 1.0f;
+        float endScale = 1.0f;
+
+        // Emits `count` particles right away (fewer if there's no room left)
+        void burst(int count);
+
+        // Runs the emitter for `seconds` at once, so it starts out as if it had already been emitting
+        void warmUp(float seconds);
+
+        // Drops every particle (the storage is kept)
+        void reset();
+
+        [[nodiscard]] size_t count() const { return alive; }
+
+        [[nodiscard]] size_t getCapacity() const { return capacity; }
+
+        // Not emitting and no particle left
+        [[nodiscard]] bool isFinished() const;
+
+        bool awake() override;
+
+        void update() override;
+
+        void render(Batch &batch) override;
+
+    private:
+        std::string spriteName;
+        // the sprite's first frame, resolved once, Content keeps its sprites for the whole run (null if it has none)
+        const Subtexture *texture = nullptr;
+        size_t capacity;
+        size_t alive = 0;
+        // fraction of a particle left to emit from the previous updates
+        float pending = 0.0f;
+
+        std::vector<float> x, y;
+        // positions before the last update
+        std::vector<float> previousX, previousY;
+        std::vector<float> velocityX, velocityY;
+        // 0 when emitted, the particle dies at 1
+        std::vector<float> age;
+        // 1 / life in seconds
+        std::vector<float> ageRate;
+
+        std::vector<SpriteInstance> instances;
+
+        void simulate(float delta);
+    };
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "Component.h"
+#include "Audio.h"
+
+namespace Engine {
+    // Plays a sound at its entity's position, the voice follows the entity while it moves
+    class SoundEmitter : public Component {
+    public:
+        explicit SoundEmitter(SoundId sound, float volume = 1.0f, bool loop = false);
+
+        // Stops the voice
+        ~SoundEmitter() override;
+
+        // Restarts the sound (a looping one keeps playing until stop() is called or the component is destroyed)
+        void play();
+
+        void stop();
+
+        [[nodiscard]] bool isPlaying() const;
+
+        void update() override;
+
+        SoundId sound;
+        float volume;
+        bool loop;
+
+    private:
+        Voice voice;
+    };
+}
@@ -1,14 +1,21 @@
 #pragma once
 
+#include <cstdint>
+#include <functional>
 #include <string>
+#include <vector>
 #include "Component.h"
 #include "Color.h"
 
 namespace Engine {
 
     class Sprite;
-    class Animation;
+    struct Animation;
+    class Animators;
 
+    // Draws a Content sprite, playing one of its animations. The animations of every SpriteComponent in a World are
+    // advanced together at the start of World::update (see Animators), by the step's delta times the speed, in the
+    // direction set on the Aseprite tag. Animations loop.
     class SpriteComponent : public Component {
 
     public:
@@ -19,12 +26,26 @@ namespace Engine {
 
         explicit SpriteComponent(const std::string &sprite);
 
+        ~SpriteComponent() override;
+
+        // Starts `animation` from its first frame, keeps playing it if it's the current one already
         void play(const std::string &animation);
 
         void render(Batch &batch) override;
 
-        void update() override;
+        // Playback controls, usable once the component was added to an entity
+        void setSpeed(float speed);
+        [[nodiscard]] float getSpeed() const;
+
+        // Jumps `millis` into the current animation's loop
+        void seek(float millis);
+
+        // Index of the frame shown in the current animation
+        [[nodiscard]] int getFrame() const;
 
+        // Calls `callback` every time `frame` of `animation` starts playing (ex. a footstep sound).
+        // Frames skipped over by a long step still fire, in order.
+        void onFrame(const std::string &animation, int frame, std::function<void()> callback);
 
         int getCurrentAnimDuration();
 
@@ -36,14 +57,28 @@ namespace Engine {
         bool awake() override;
 
     private:
-        int frameIndex{0};
-        float frameCounter{0};
+        friend class Animators;
+
+        struct FrameEvent {
+            std::string animation;
+            int frame;
+            std::function<void()> callback;
+        };
 
         std::string spriteName;
         std::string animationName;
-
-        Engine::Sprite* getSprite();
-        Engine::Animation* getAnimation();
+        // resolved once, Content keeps its sprites for the whole run
+        Engine::Sprite *sprite = nullptr;
+        const Engine::Animation *animation = nullptr;
+
+        Animators *animators = nullptr;
+        uint32_t handle = UINT32_MAX;
+        std::vector<FrameEvent> events;
+        // set while fireFrameEvents runs, the destructor raises it so the remaining callbacks aren't called
+        bool *destroyed = nullptr;
+
+        // Called by Animators after the frame changed, from and to are entries of the animation's timeline
+        void fireFrameEvents(uint32_t from, uint32_t to);
 
         Engine::Color color = 0xffffff;
     };
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include "Component.h"
+
+namespace Engine {
+    class Transforms;
+
+    // Position, rotation and scale relative to a parent Transform. A Transform without a parent is placed at its
+    // entity's position (the interpolated render position), one with a parent ignores its entity's position.
+    // World matrices are computed when they are read after the Transform, one of its parents or the root's entity
+    // moved (see Transforms), draw with them through Batch::tex's matrix overload.
+    // Setters and getters can be used once the Transform was added to an entity.
+    class Transform : public Component {
+    public:
+        explicit Transform(const glm::vec2 &position = {}, float rotation = 0.0f, const glm::vec2 &scale = {1.0f, 1.0f});
+
+        ~Transform() override;
+
+        bool awake() override;
+
+        // The parent must be in the same World. Children of a destroyed Transform become roots.
+        void setParent(Transform *parent);
+        [[nodiscard]] Transform *getParent() const;
+
+        void setPosition(const glm::vec2 &position);
+        [[nodiscard]] glm::vec2 getPosition() const;
+
+        void setRotation(float radians);
+        [[nodiscard]] float getRotation() const;
+
+        void setScale(const glm::vec2 &scale);
+        [[nodiscard]] glm::vec2 getScale() const;
+
+        // Point (in local space) that is placed at the position, and rotated and scaled around
+        void setOrigin(const glm::vec2 &origin);
+        [[nodiscard]] glm::vec2 getOrigin() const;
+
+        // Local to world
+        [[nodiscard]] glm::mat3x2 getMatrix() const;
+
+    private:
+        Transforms *transforms = nullptr;
+        uint32_t handle = UINT32_MAX;
+
+        // set before the component is added to an entity
+        glm::vec2 initialPosition;
+        float initialRotation;
+        glm::vec2 initialScale;
+    };
+}
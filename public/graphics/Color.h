@@ -11,7 +11,8 @@ namespace Engine {
         uint8_t b;
         uint8_t a;
 
-        Color();
+        // inline so arrays of vertices holding a Color can be grown without a call per element
+        Color() : r(0), g(0), b(0), a(0) {}
 
         Color(int rgb);
 
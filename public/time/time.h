@@ -5,11 +5,36 @@
 namespace Engine {
     struct Time {
 
+        // Length of a simulation step in seconds. update() always advances the world by exactly this amount.
+        static float delta;
+
+        // Real time elapsed since the previous rendered frame, in seconds
+        static float frameDelta;
+
+        // How far (0..1) the current frame is between the previous and the latest simulation step.
+        // Renderers use it to interpolate between the two states.
+        static float alpha;
+
+        // Freezes the simulation (not rendering) for the given amount of milliseconds
         static uint32_t pauseTimer;
 
+        // Number of simulation steps run so far
+        static uint64_t steps;
+
+        // Simulated time in seconds
+        static double elapsed;
+
         static bool onInterval(uint32_t interval);
 
+        // Simulated time in milliseconds, it only advances when the simulation steps
         static uint32_t getTime();
 
+        // Seconds since the engine started (real time, high resolution)
+        static double now();
+
+        // Blocks the calling thread until now() reaches the given time.
+        // Sleeps while far from the target and spins for the last couple of milliseconds.
+        static void sleepUntil(double time);
+
     };
 }
@@ -14,12 +14,13 @@ bool Background::awake()
 void Background::update()
 {
     if (entity->position.x <= -width)
-        entity->position.x = 0;
+        entity->teleport({0, entity->position.y});
 }
 
 void Background::render(Engine::Batch &batch)
 {
     auto sky_texture = sky->getAnimation()->frames[0].texture;
-    batch.tex(sky_texture, entity->position, 0xffffff);
-    batch.tex(sky_texture, entity->position + glm::ivec2{width, 0}, 0xffffff);
+    auto position = entity->renderPosition();
+    batch.tex(sky_texture, position, 0xffffff);
+    batch.tex(sky_texture, position + glm::vec2{width, 0}, 0xffffff);
 }
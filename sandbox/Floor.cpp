@@ -19,12 +19,13 @@ bool Floor::awake()
 void Floor::update()
 {
     if (entity->position.x <= -width)
-        entity->position.x = 0;
+        entity->teleport({0, entity->position.y});
 }
 
 void Floor::render(Engine::Batch &batch)
 {
     auto base_texture = base->getAnimation()->frames[0].texture;
-    batch.tex(base_texture, {entity->position.x, height - base_texture.height()}, 0xffffff);
-    batch.tex(base_texture, {entity->position.x + width, height - base_texture.height()}, 0xffffff);
+    auto position = entity->renderPosition();
+    batch.tex(base_texture, {position.x, height - base_texture.height()}, 0xffffff);
+    batch.tex(base_texture, {position.x + width, height - base_texture.height()}, 0xffffff);
 }
\ No newline at end of file
@@ -15,6 +15,7 @@ private:
     static constexpr float SCALE = 1.7;
     static constexpr int PIPE_INTERVAL_MS = 2400;
 
+    Engine::RenderGraph graph;
     std::shared_ptr<Engine::FrameBuffer> buffer;
     std::shared_ptr<Engine::Material> material;
     Engine::Entity *player;
@@ -24,6 +25,10 @@ public:
     SandboxApplication() : Engine::Application("Flappy Bird", WIDTH * SCALE, HEIGHT * SCALE, false)
     {
         buffer = Engine::FrameBuffer::create(WIDTH, HEIGHT);
+        // the window is 1.7x the game, sharp bilinear keeps the pixels even
+        presenter().setSource(buffer);
+        presenter().scaling = Engine::Presenter::Scaling::Fit;
+        presenter().sharpBilinear = true;
         auto shader = Engine::Shader::create("assets/ctr.vsh", "assets/ctr.fsh");
         material = std::shared_ptr<Engine::Material>(new Engine::Material(shader));
         batch.defaultSampler = Engine::TextureSampler(Engine::TextureFilter::Nearest);
@@ -92,29 +97,25 @@ public:
 
     void render() override
     {
-        buffer->clear();
-        batch.pushMaterial(material);
-        world.render<Background>(batch);
-        batch.popMaterial();
-        batch.pushBlend(Engine::BlendMode::Normal);
-        world.render<Pipe>(batch);
-        world.render<Bird>(batch);
-        world.render<Floor>(batch);
-        batch.render(buffer);
-        batch.popBlend();
-        batch.clear();
-
-        // Render to screen
-        auto screenBuffer = Engine::FrameBuffer::BackBuffer();
-        screenBuffer->clear(0xffffffff);
-        glm::vec2 screenCenter = glm::vec2{(float)screenBuffer->width(), (float)screenBuffer->height()} * 0.5f;
-        glm::vec2 bufferCenter = glm::vec2{(float)buffer->width(), (float)buffer->height()} * 0.5f;
-        glm::vec2 scale = {screenBuffer->width() / (float)buffer->width(), screenBuffer->height() / (float)buffer->height()};
-        batch.pushMatrix(Engine::Math::transform(screenCenter, bufferCenter, scale));
-        batch.tex(buffer->attachment(0), {0.0f, 0.0f}, 0xffffff);
-        batch.render(Engine::FrameBuffer::BackBuffer());
-        batch.popMatrix();
-        batch.clear();
+        auto scene = graph.import(buffer);
+
+        graph.addPass("Scene", {}, scene, [this](const Engine::RenderGraph::Context &context)
+        {
+            context.target()->clear();
+            batch.pushMaterial(material);
+            world.render<Background>(batch);
+            batch.popMaterial();
+            batch.pushBlend(Engine::BlendMode::Normal);
+            world.render<Pipe>(batch);
+            world.render<Bird>(batch);
+            world.render<Floor>(batch);
+            batch.render(context.target());
+            batch.popBlend();
+            batch.clear();
+        });
+
+        // the Application's presenter scales the buffer to the window
+        graph.execute();
     }
 
     void handleEvent(SDL_Event &event) override
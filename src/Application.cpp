@@ -3,16 +3,81 @@
 #include "imgui/backends/imgui_impl_opengl3.h"
 #include "imgui/backends/imgui_impl_sdl.h"
 #include <utility>
+#include <algorithm>
+#include <cstdlib>
+#include <ctime>
 #include <Log.h>
 #include <glad/glad.h>
 
 #include "time/time.h"
 #include "Content.h"
 #include "Input.h"
+#include "Audio.h"
+#include "Profiler.h"
+#include "GpuProfiler.h"
+#include "SamplerCache.h"
+#include "Readback.h"
+#include "font.h"
+#include "ShaderCache.h"
 
 Engine::Application *Engine::Application::instance = nullptr;
-Engine::Application::Application(std::string name, int width, int height, bool fullScreen) : appName{std::move(name)}
+Engine::LaunchOptions Engine::Application::launchOptions{};
+
+Engine::LaunchOptions Engine::LaunchOptions::parse(int argc, char *argv[])
 {
+    LaunchOptions options;
+    options.seed = (uint32_t)time(nullptr);
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg{argv[i]};
+        bool hasValue = i + 1 < argc;
+        if (arg == "--headless")
+            options.headless = true;
+        else if (arg == "--offscreen")
+            options.offscreen = true;
+        else if (arg == "--steps" && hasValue)
+            options.steps = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--seed" && hasValue)
+            options.seed = (uint32_t)std::strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--record" && hasValue)
+            options.record = argv[++i];
+        else if (arg == "--replay" && hasValue)
+            options.replay = argv[++i];
+        else if (arg == "--log" && hasValue)
+            options.log = argv[++i];
+        else
+            ENGINE_CORE_WARN("Unknown argument {}", arg);
+    }
+    return options;
+}
+
+Engine::Application::Application(std::string name, int width, int height, bool fullScreen) : appName{std::move(name)},
+                                                                                              headlessWidth{width},
+                                                                                              headlessHeight{height}
+{
+    if (isHeadless())
+    {
+        ENGINE_CORE_INFO("Running headless");
+        if (SDL_Init(0) != 0)
+        {
+            SDL_Log("Unable to initialize SDL: %s", SDL_GetError());
+            return;
+        }
+
+        // ImGui calls made from update() still need a context, nothing is ever rendered
+        IMGUI_CHECKVERSION();
+        ImGui::CreateContext();
+        ImGuiIO &io = ImGui::GetIO();
+        io.DisplaySize = ImVec2((float)width, (float)height);
+        io.IniFilename = nullptr;
+        io.Fonts->Build();
+
+        isRunning = true;
+        instance = this;
+        Audio::init();
+        Content::load();
+        return;
+    }
 
     // Init platform
     {
@@ -22,7 +87,7 @@ Engine::Application::Application(std::string name, int width, int height, bool f
 
         ENGINE_CORE_INFO("SDL v{:d}.{:d}.{:d}", major, version.minor, version.patch);
 
-        if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO) != 0)
+        if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO | SDL_INIT_GAMECONTROLLER) != 0)
         {
             SDL_Log("Unable to initialize SDL: %s", SDL_GetError());
             return;
@@ -35,10 +100,11 @@ Engine::Application::Application(std::string name, int width, int height, bool f
         SDL_GL_SetAttribute(SDL_GL_DOUBLEBUFFER, 1);
 
         Uint32 flags = fullScreen ? SDL_WINDOW_FULLSCREEN : 0;
+        flags |= launchOptions.offscreen ? SDL_WINDOW_HIDDEN : SDL_WINDOW_SHOWN;
         window = SDL_CreateWindow(appName.c_str(),
                                   SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
                                   width, height,
-                                  flags | SDL_WINDOW_OPENGL | SDL_WINDOW_SHOWN);
+                                  flags | SDL_WINDOW_OPENGL);
 
         if (!window)
         {
@@ -51,9 +117,6 @@ Engine::Application::Application(std::string name, int width, int height, bool f
         SDL_SetWindowResizable(window, SDL_TRUE);
         SDL_SetWindowMinimumSize(window, 128, 128);
 
-        // enable v-sync
-        SDL_GL_SetSwapInterval(1);
-
         isRunning = true;
         instance = this;
     }
@@ -66,7 +129,14 @@ Engine::Application::Application(std::string name, int width, int height, bool f
             ENGINE_ERROR("Failed to create OpenGL context: {}", SDL_GetError());
         SDL_GL_MakeCurrent(window, context);
         if (!gladLoadGL())
-            std::cout << "Failed to initialize GLAD" << std::endl;
+            ENGINE_CORE_ERROR("Failed to initialize GLAD");
+
+        // enable v-sync, without it frames are paced by the frame rate limiter
+        if (SDL_GL_SetSwapInterval(1) != 0)
+        {
+            ENGINE_CORE_WARN("V-sync unavailable: {}", SDL_GetError());
+            frameRateLimit = UPDATE_RATE;
+        }
 
         // TODO: add a debug callback
 
@@ -87,57 +157,187 @@ Engine::Application::Application(std::string name, int width, int height, bool f
         ImGui_ImplOpenGL3_Init(glslversion);
     }
 
+    // Program binaries from previous runs are loaded instead of compiled
+    if (char *prefPath = SDL_GetPrefPath("engine", appName.c_str()))
+    {
+        ShaderCache::setBinaryDirectory(prefPath);
+        SDL_free(prefPath);
+    }
+
+    Audio::init();
     Content::load();
+    ShaderCache::warmUp();
 }
 
 Engine::Application::~Application()
 {
-    SDL_GL_DeleteContext(context);
+    if (context)
+        SDL_GL_DeleteContext(context);
     if (window)
         SDL_DestroyWindow(window);
     window = nullptr;
+    Audio::shutdown();
     SDL_Quit();
     ENGINE_INFO("GAME CLEANED");
 }
 
+void Engine::Application::step()
+{
+    Input::poll();
+    update();
+    // pressed()/released() report edges relative to the previous step
+    Input::update();
+    Audio::update();
+    Time::steps++;
+    Time::elapsed += Time::delta;
+}
+
+bool Engine::Application::finishedSteps() const
+{
+    if (launchOptions.steps > 0)
+        return Time::steps >= launchOptions.steps;
+    // without a step count a replay runs for as long as it was recorded
+    return Input::replayFinished();
+}
+
+void Engine::Application::runHeadless()
+{
+    Time::alpha = 1.0f;
+    double start = Time::now();
+    uint64_t firstStep = Time::steps;
+
+    while (isRunning && !finishedSteps())
+    {
+        ImGui::GetIO().DeltaTime = Time::delta;
+        ImGui::NewFrame();
+        step();
+        ImGui::EndFrame();
+    }
+
+    double seconds = Time::now() - start;
+    uint64_t steps = Time::steps - firstStep;
+    ENGINE_CORE_INFO("Simulated {} steps in {:.3f}s ({:.0f} steps/s)", steps, seconds, seconds > 0.0 ? steps / seconds : 0.0);
+    ImGui::DestroyContext();
+}
+
 void Engine::Application::run()
 {
-    uint32_t frameStart, frameTime;
+    if (isHeadless())
+    {
+        runHeadless();
+        return;
+    }
+
+    double previousFrame = Time::now();
+    double accumulator = 0.0;
+
+#ifdef ENGINE_PROFILE
+    Profiler::setThreadName("Main");
+#endif
 
     while (isRunning)
     {
-        frameStart = SDL_GetTicks();
+        ENGINE_PROFILE_FRAME();
+        double frameStart = Time::now();
+        double frameTime = std::min(frameStart - previousFrame, MAX_FRAME_TIME);
+        previousFrame = frameStart;
+        Time::frameDelta = (float)frameTime;
 
         // Poll system events
-        while (SDL_PollEvent(&event))
         {
-            ImGui_ImplSDL2_ProcessEvent(&event);
-            if (event.type == SDL_QUIT)
-                isRunning = false;
-            handleEvent(event);
+            ENGINE_PROFILE_SCOPE("Events");
+            while (SDL_PollEvent(&event))
+            {
+                ImGui_ImplSDL2_ProcessEvent(&event);
+                Input::event(event);
+                if (event.type == SDL_QUIT)
+                    isRunning = false;
+                handleEvent(event);
+            }
         }
         // Start the Dear ImGui frame
         ImGui_ImplOpenGL3_NewFrame();
         ImGui_ImplSDL2_NewFrame();
         ImGui::NewFrame();
 
-        update();
-        render();
-        ImGui::Render();
-        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
-        // present
-        SDL_GL_SwapWindow(window);
-        frameTime = SDL_GetTicks() - frameStart;
-        if (frameTime < FRAME_DURATION + Engine::Time::pauseTimer)
+        // Run as many fixed steps as needed to catch up with real time
         {
-            SDL_Delay(FRAME_DURATION - frameTime + Engine::Time::pauseTimer);
-            Engine::Time::pauseTimer = 0;
+            ENGINE_PROFILE_SCOPE("Update");
+            if (Time::pauseTimer > 0)
+            {
+                auto elapsedMillis = (uint32_t)(frameTime * 1000.0);
+                Time::pauseTimer = elapsedMillis < Time::pauseTimer ? Time::pauseTimer - elapsedMillis : 0;
+            }
+            else
+            {
+                accumulator += frameTime;
+            }
+
+            while (accumulator >= Time::delta && !finishedSteps())
+            {
+                step();
+                accumulator -= Time::delta;
+            }
+            Time::alpha = (float)(accumulator / Time::delta);
+        }
+        {
+            ENGINE_PROFILE_SCOPE("Render");
+            render();
+        }
+        {
+            ENGINE_PROFILE_SCOPE("ImGui");
+#ifdef ENGINE_PROFILE
+            Profiler::drawImGui();
+            GpuProfiler::drawImGui();
+#endif
+            ImGui::Render();
+        }
+        // checked after rendering so an invalidate() from render() is presented this frame.
+        // ImGui draws straight to the window, a frame with ImGui windows is always presented
+        bool presentFrame = !framePresenter.getSource() || framePresenter.needsPresent(width(), height()) ||
+                            ImGui::GetDrawData()->CmdListsCount > 0;
+        if (presentFrame)
+        {
+            if (framePresenter.getSource())
+                framePresenter.present(FrameBuffer::BackBuffer());
+            ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+
+            ENGINE_PROFILE_SCOPE("Swap");
+            SDL_GL_SwapWindow(window);
+        }
+        else if (frameRateLimit == 0)
+        {
+            // nothing was swapped so v-sync didn't pace this frame, wait for a refresh instead
+            ENGINE_PROFILE_SCOPE("Sleep");
+            SDL_DisplayMode mode;
+            int refreshRate = SDL_GetWindowDisplayMode(window, &mode) == 0 && mode.refresh_rate > 0 ? mode.refresh_rate : UPDATE_RATE;
+            Time::sleepUntil(frameStart + 1.0 / refreshRate);
+        }
+#ifdef ENGINE_PROFILE
+        GpuProfiler::frame();
+#endif
+        Readback::frame();
+        Font::frame();
+        if (finishedSteps())
+            isRunning = false;
+
+        if (frameRateLimit > 0)
+        {
+            ENGINE_PROFILE_SCOPE("Sleep");
+            Time::sleepUntil(frameStart + 1.0 / frameRateLimit);
         }
-        Input::update();
     }
 
     // shutdown graphics?
     // shutdown platform?
+#ifdef ENGINE_PROFILE
+    GpuProfiler::shutdown();
+#endif
+    Readback::shutdown();
+    framePresenter.dispose();
+    ShaderCache::shutdown();
+    SamplerCache::shutdown();
+
     // shut down imgui
     {
         ImGui_ImplOpenGL3_Shutdown();
@@ -146,6 +346,36 @@ void Engine::Application::run()
     }
 }
 
+void Engine::Application::setUpdateRate(int stepsPerSecond)
+{
+    ENGINE_ASSERT(stepsPerSecond > 0, "Update rate must be positive");
+    if (stepsPerSecond > 0)
+        Time::delta = 1.0f / stepsPerSecond;
+}
+
+void Engine::Application::setFrameRateLimit(int framesPerSecond)
+{
+    frameRateLimit = std::max(framesPerSecond, 0);
+}
+
+int Engine::Application::width() const
+{
+    if (!window)
+        return headlessWidth;
+    int width, height;
+    SDL_GL_GetDrawableSize(window, &width, &height);
+    return width;
+}
+
+int Engine::Application::height() const
+{
+    if (!window)
+        return headlessHeight;
+    int width, height;
+    SDL_GL_GetDrawableSize(window, &width, &height);
+    return height;
+}
+
 const char *Engine::Application::path()
 {
     return SDL_GetBasePath();
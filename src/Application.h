@@ -3,13 +3,34 @@
 #include "iostream"
 #include <SDL.h>
 #include "Ecs.h"
+#include "graphics/Presenter.h"
 
 int main(int argc, char* argv[]);
 
 namespace Engine {
 
-    constexpr int FPS = 60;
-    constexpr double FRAME_DURATION = 1000.0f / FPS;
+    // Default number of simulation steps per second
+    constexpr int UPDATE_RATE = 60;
+
+    // Settings the application is launched with, parsed from the command line by main():
+    //   --headless        no window, no GL context, update() runs as fast as possible
+    //   --offscreen       hidden window with a GL context, for rendering and capturing frames on CI (e.g. llvmpipe)
+    //   --steps N         quit after N simulation steps
+    //   --seed N          seed for rand()
+    //   --record FILE     record the input of every step
+    //   --replay FILE     replay a recording (restores its seed)
+    struct LaunchOptions {
+        bool headless = false;
+        bool offscreen = false;
+        uint64_t steps = 0;
+        uint32_t seed = 0;
+        std::string record;
+        std::string replay;
+        // JSON lines log file, see Log::openFile
+        std::string log;
+
+        static LaunchOptions parse(int argc, char* argv[]);
+    };
 
     class Application {
     public:
@@ -29,6 +50,26 @@ namespace Engine {
 
         SDL_Window* window{};
 
+        // Options the application was launched with
+        static const LaunchOptions& options() { return launchOptions; }
+
+        // True when running without a window / GL context. Graphics objects can still be created,
+        // they just don't allocate any GPU resources and drawing is a no-op.
+        static bool isHeadless() { return launchOptions.headless; }
+
+        // Size of the drawable area of the window (the requested size when headless)
+        [[nodiscard]] int width() const;
+        [[nodiscard]] int height() const;
+
+        // Number of times per second update() is called, independently of the frame rate
+        void setUpdateRate(int stepsPerSecond);
+
+        // Caps the number of rendered frames per second (0 = no cap, rely on v-sync)
+        void setFrameRateLimit(int framesPerSecond);
+
+        // Scales the game's FrameBuffer to the window after render(), see Presenter::setSource
+        Presenter& presenter() { return framePresenter; }
+
 
     protected:
 
@@ -43,11 +84,32 @@ namespace Engine {
 
         void run();
 
+        void runHeadless();
+
+        // Runs one simulation step
+        void step();
+
+        // True once the step count or the replay given in the launch options is exhausted
+        bool finishedSteps() const;
+
+        static LaunchOptions launchOptions;
+
+        int headlessWidth;
+        int headlessHeight;
+
         SDL_Event event{};
 
         static Application* instance;
         
-        SDL_GLContext context;
+        SDL_GLContext context{};
+
+        int frameRateLimit = 0;
+
+        Presenter framePresenter;
+
+        // Longest frame the simulation tries to catch up with, anything above is dropped
+        // so a hitch (breakpoint, window drag) doesn't trigger a burst of updates
+        static constexpr double MAX_FRAME_TIME = 0.25;
 
         friend int::main(int argc, char* argv[]);
 
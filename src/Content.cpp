@@ -5,9 +5,10 @@
 #include <dirent.h>
 #include "Application.h"
 #include <json/json.h>
-#include <SDL_mixer.h>
+#include "Audio.h"
 
 #include "TexturePacker.h"
+#include "ImageOps.h"
 #include "fstream"
 // for convenience
 using json = nlohmann::json;
@@ -15,7 +16,33 @@ using json = nlohmann::json;
 std::map<std::string, Engine::Sprite> Content::sprites{};
 std::vector<MapInfo> Content::maps{};
 
-std::pair<std::string, Engine::Sprite> loadSprite(const std::string &assets, const std::string &name)
+// A sprite whose frames are packed but not uploaded yet, see Content::load
+struct SpritePage
+{
+    std::string name;
+    Engine::Sprite sprite;
+    std::vector<Engine::Color> pixels;
+    int width = 0;
+    int height = 0;
+};
+
+// Frames wrap into rows this wide, so a long animation doesn't make its page (and every layer sharing an array
+// with it) as wide as all its frames together
+constexpr int SPRITE_PAGE_WIDTH = 1024;
+
+// The vertex layer index limits an array to 256 layers
+constexpr int MAX_SPRITE_LAYERS = 256;
+
+// Next power of two, pages are grouped by the size class of each side
+int sizeClass(int size)
+{
+    int result = 1;
+    while (result < size)
+        result *= 2;
+    return result;
+}
+
+SpritePage loadSprite(const std::string &assets, const std::string &name)
 {
     Engine::Aseprite aseprite(assets + name);
 
@@ -30,18 +57,23 @@ std::pair<std::string, Engine::Sprite> loadSprite(const std::string &assets, con
     for (int i = 0; i < aseprite.frames.size(); i++)
     {
         auto image = aseprite.frames[i].image;
+        if (Engine::Texture::isPremultipliedAlpha())
+            Engine::ImageOps::premultiply(image.pixels, (size_t)image.width * image.height);
         packer.addEntry(i, image.width, image.height, image.pixels);
     }
 
-    auto texture = packer.pack();
+    int width, height;
+    auto pixels = packer.packPixels(width, height, std::min(SPRITE_PAGE_WIDTH, Engine::Texture::maxSize()));
 
+    // Frames get their texture once every page is uploaded
     // If there are no tags, just get the first frame...
     if (aseprite.tags.empty())
     {
         Engine::Animation &anim = sprite.addAnimation();
         anim.name = n;
         auto &frame = anim.frames.emplace_back();
-        frame.texture = Engine::Subtexture(texture, *packer.getEntryRect(0));
+        frame.texture = Engine::Subtexture(nullptr, *packer.getEntryRect(0));
+        anim.buildTimeline();
     }
 
     // else
@@ -49,25 +81,108 @@ std::pair<std::string, Engine::Sprite> loadSprite(const std::string &assets, con
     {
         Engine::Animation &anim = sprite.addAnimation();
         anim.name = tag.name;
+        switch (tag.animationDirection)
+        {
+        case Engine::Aseprite::Tag::AnimDirection::Forward:
+            anim.direction = Engine::Animation::Direction::Forward;
+            break;
+        case Engine::Aseprite::Tag::AnimDirection::Reverse:
+            anim.direction = Engine::Animation::Direction::Reverse;
+            break;
+        case Engine::Aseprite::Tag::AnimDirection::PingPong:
+            anim.direction = Engine::Animation::Direction::PingPong;
+            break;
+        }
 
         for (int frameIndex = tag.from; frameIndex <= tag.to; frameIndex++)
         {
             auto &frame = anim.frames.emplace_back();
 
-            auto &image = aseprite.frames[frameIndex].image;
             frame.durationMillis = aseprite.frames[frameIndex].duration;
 
-            anim.duration += frame.durationMillis;
+            // TODO check this, they should not be hardcoded
+            frame.texture = Engine::Subtexture(nullptr, *packer.getEntryRect(frameIndex));
+        }
+        anim.buildTimeline();
+    }
+    return SpritePage{n, std::move(sprite), std::move(pixels), width, height};
+}
 
-            frame.texture = Engine::Subtexture(
-                // TODO: should pack textures into one
-                // Engine::Texture::create(image.width, image.height, (unsigned char *) image.pixels),
-                texture,
-                // TODO check this, they should not be hardcoded
-                *packer.getEntryRect(frameIndex));
+// Uploads a page as a plain 2D texture, for pages that don't fit in a texture array
+void uploadSpritePage(SpritePage &page)
+{
+    auto texture = Engine::Texture::create(page.width, page.height, (unsigned char *)page.pixels.data());
+    for (auto &animation : page.sprite.getAnimations())
+    {
+        for (auto &frame : animation.frames)
+            frame.texture = Engine::Subtexture(texture, frame.texture.rect);
+    }
+}
+
+// Uploads the sprite pages as layers of texture arrays, so sprites never split a batch between them.
+// Pages are grouped by size class, a layer is only padded up to the largest page of its group: one long or tall
+// sprite doesn't set the size of every layer. Pages past the GL limits are uploaded as plain 2D textures.
+void uploadSpritePages(std::vector<SpritePage> &pages, std::map<std::string, Engine::Sprite> &sprites)
+{
+    const int maxSize = Engine::Texture::maxSize();
+    const size_t maxLayers = (size_t)std::min(MAX_SPRITE_LAYERS, Engine::Texture::maxLayers());
+
+    std::map<std::pair<int, int>, std::vector<SpritePage *>> groups;
+    for (auto &page : pages)
+    {
+        if (page.width > maxSize || page.height > maxSize)
+        {
+            ENGINE_LOG_ERROR(Content, "Sprite {} needs a {}x{} page, the max texture size is {}", page.name,
+                             page.width, page.height, maxSize);
+            uploadSpritePage(page);
+            continue;
         }
+        groups[{sizeClass(page.width), sizeClass(page.height)}].push_back(&page);
     }
-    return std::pair{n, std::move(sprite)};
+
+    for (auto &[size, group] : groups)
+    {
+        for (size_t first = 0; first < group.size(); first += maxLayers)
+        {
+            size_t last = std::min(first + maxLayers, group.size());
+            int width = 1, height = 1;
+            for (size_t i = first; i < last; i++)
+            {
+                width = std::max(width, group[i]->width);
+                height = std::max(height, group[i]->height);
+            }
+
+            auto texture = Engine::Texture::createArray(width, height, (int)(last - first), Engine::TextureFormat::RGBA);
+            if (!texture)
+            {
+                ENGINE_LOG_WARN(Content, "Uploading {} sprite pages of {}x{} as separate textures", last - first,
+                                width, height);
+                for (size_t i = first; i < last; i++)
+                    uploadSpritePage(*group[i]);
+                continue;
+            }
+
+            std::vector<Engine::Color> layer((size_t)width * height);
+            for (size_t i = first; i < last; i++)
+            {
+                auto &page = *group[i];
+                int index = (int)(i - first);
+                std::fill(layer.begin(), layer.end(), Engine::Color());
+                Engine::ImageOps::blit(layer.data(), width, page.pixels.data(), page.width, page.width, page.height);
+                texture->setLayer(index, (const unsigned char *)layer.data());
+
+                for (auto &animation : page.sprite.getAnimations())
+                {
+                    for (auto &frame : animation.frames)
+                        frame.texture = Engine::Subtexture(texture, frame.texture.rect, index);
+                }
+            }
+        }
+    }
+
+    for (auto &page : pages)
+        sprites.insert({page.name, std::move(page.sprite)});
+    pages.clear();
 }
 
 // Returns the path to the /assets/ folder
@@ -86,7 +201,7 @@ std::string Content::path()
     }
     if (!directory)
     {
-        ENGINE_CORE_ERROR("Could not find 'assets' directory...");
+        ENGINE_LOG_ERROR(Content, "Could not find 'assets' directory...");
         return nullptr;
     }
     closedir(directory);
@@ -96,44 +211,24 @@ std::string Content::path()
 
 void Content::playSoundJump()
 {
-
-    static auto path = Content::path().append("/jump.wav");
-    static Mix_Chunk *gHigh = Mix_LoadWAV(path.c_str());
-    Mix_PlayChannel(-1, gHigh, 0);
+    static Engine::SoundId sound = Engine::Audio::find("jump.wav");
+    Engine::Audio::play(sound);
 }
 void Content::playSoundHit()
 {
-
-    static auto path = Content::path().append("/hit.wav");
-    static Mix_Chunk *gHigh = Mix_LoadWAV(path.c_str());
-    Mix_PlayChannel(-1, gHigh, 0);
+    static Engine::SoundId sound = Engine::Audio::find("hit.wav");
+    Engine::Audio::play(sound);
 }
 void Content::playMusic()
 {
-    // Init Music
-    // Initialize SDL_mixer
-    static bool audio = false;
-    if (!audio) {
-        if (Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 256) == -1)
-        {
-            return;
-        }
-        audio = true;
-    }
-
     static bool playing = false;
     if (playing) return;
-    std::cout << "Playing music" << std::endl;
-    static auto path = Content::path().append("/music.mp3");
-    static Mix_Music *gHigh = Mix_LoadMUS(path.c_str());
-    Mix_PlayMusic(gHigh, -1);
-    playing = true;
+    playing = Engine::Audio::playMusic("music.mp3");
 }
 void Content::playSound()
 {
-    static auto path = Content::path().append("/coin.wav");
-    static Mix_Chunk *gHigh = Mix_LoadWAV(path.c_str());
-    Mix_PlayChannel(-1, gHigh, 0);
+    static Engine::SoundId sound = Engine::Audio::find("coin.wav");
+    Engine::Audio::play(sound);
 }
 
 void Content::load()
@@ -141,39 +236,44 @@ void Content::load()
     sprites.clear();
     maps.clear();
     auto assets = path();
-    ENGINE_INFO(assets.c_str());
+    ENGINE_LOG_INFO(Content, assets.c_str());
     auto directory = opendir(assets.c_str());
     dirent *dir = readdir(directory);
+    std::vector<SpritePage> pages;
     while (dir != nullptr)
     {
         std::string name{dir->d_name};
 
         // Load sprites
         if (name.size() > 4 && name.compare(name.size() - 4, 4, ".ase") == 0)
+            pages.push_back(loadSprite(assets, name));
+
+        // Load sounds, decoded into the audio bank up front so playing them never touches the disk
+        bool wav = name.size() > 4 && name.compare(name.size() - 4, 4, ".wav") == 0;
+        bool ogg = name.size() > 4 && name.compare(name.size() - 4, 4, ".ogg") == 0;
+        if (wav || ogg)
+            Engine::Audio::load(name);
+
+        // Load images (cooked .ktx2 textures may be block compressed)
+        bool png = name.size() > 4 && name.compare(name.size() - 4, 4, ".png") == 0;
+        bool ktx2 = name.size() > 5 && name.compare(name.size() - 5, 5, ".ktx2") == 0;
+        auto tex = png || ktx2 ? Engine::Texture::create((assets + name).c_str()) : nullptr;
+        if (tex)
         {
-            auto sprite = loadSprite(assets, name);
-            sprites.insert(sprite);
-        }
-
-        // Load sound
-
-        if (name.size() > 4 && name.compare(name.size() - 4, 4, ".png") == 0)
-        {
-            std::string n{name.substr(0, name.size() - 4)};
-            auto sprite = Engine::Sprite(name.substr(0, name.size() - 4));
+            std::string n{name.substr(0, name.find_last_of('.'))};
+            auto sprite = Engine::Sprite(name.substr(0, name.find_last_of('.')));
 
             auto &anim = sprite.addAnimation();
-            anim.duration = 0;
 
             auto &frame = anim.frames.emplace_back();
             frame.durationMillis = 0;
-            auto tex = Engine::Texture::create((assets + name).c_str());
             frame.texture = Engine::Subtexture(
                 // TODO: should pack textures into one
                 // Engine::Texture::create(image.width, image.height, (unsigned char *) image.pixels),
                 tex,
                 // TODO check this, they should not be hardcoded
                 Engine::Rect(0, 0, tex->getWidth(), tex->getHeight()));
+            anim.buildTimeline();
 
             sprites.insert({n, sprite});
         }
@@ -201,6 +301,7 @@ void Content::load()
     }
 
     closedir(directory);
+    uploadSpritePages(pages, sprites);
 }
 
 std::vector<MapInfo> Content::getMaps()
@@ -209,7 +310,13 @@ std::vector<MapInfo> Content::getMaps()
 }
 Engine::Sprite *Content::findSprite(const std::string &name)
 {
-    return &sprites.at(name);
+    auto found = sprites.find(name);
+    if (found == sprites.end())
+    {
+        ENGINE_LOG_ERROR(Content, "There is no sprite {}", name);
+        return nullptr;
+    }
+    return &found->second;
 }
 
 MapInfo *Content::findMapInfo(const glm::ivec2 &position)
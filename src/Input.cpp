@@ -1,40 +1,676 @@
 #include "Input.h"
 #include "Application.h"
+#include "Log.h"
+#include "time/time.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <unordered_map>
+#include <vector>
 
 namespace Engine {
 
-    Uint8 previousKeyboard[SDL_NUM_SCANCODES]{0};
+    namespace {
+        constexpr char RECORDING_MAGIC[4] = {'E', 'R', 'E', 'C'};
+        // 2: key flags, mouse edges and wheel, gamepads, text and events
+        constexpr uint32_t RECORDING_VERSION = 2;
+        // Frame flag: the recording was stopped at this step
+        constexpr uint8_t FRAME_END = 1;
+
+        static_assert(InputState::KEY_COUNT == SDL_NUM_SCANCODES, "InputState::KEY_COUNT must match SDL");
+        static_assert((int) GamepadAxis::Count == SDL_CONTROLLER_AXIS_MAX, "GamepadAxis must match SDL");
+
+        // The snapshot the game queries
+        InputState current{};
+        // Built from SDL events between steps, becomes the snapshot on poll()
+        InputState live{};
+        // SDL timestamps of live.events, turned into ages on poll()
+        uint32_t eventTimes[InputState::MAX_EVENTS]{};
+        SDL_GameController *controllers[InputState::MAX_GAMEPADS]{};
+        SDL_JoystickID controllerIds[InputState::MAX_GAMEPADS]{};
+        Input::Source source = Input::Source::Devices;
+
+        struct Binding {
+            enum Type {
+                Key,
+                MouseButton,
+                Button,
+                Axis,
+                KeyPair,
+            };
+
+            Type type;
+            // Key, Mouse, GamepadButton or GamepadAxis (the negative key for KeyPair)
+            int code;
+            // positive key for KeyPair
+            int positive;
+            // -1 for any gamepad
+            int gamepad;
+        };
+        std::unordered_map<std::string, std::vector<Binding>> actions;
+        std::unordered_map<std::string, std::vector<Binding>> axes;
+
+        std::ofstream recording;
+        // Last state written to the recording, frames only store what changed since
+        InputState recorded{};
+
+        std::ifstream replay;
+        bool replayEnded = false;
+        uint64_t replayEndStep = 0;
+        // Step of the next frame waiting to be applied, UINT64_MAX when there is none
+        uint64_t nextReplayStep = UINT64_MAX;
+
+        template <class T>
+        void write(std::ofstream &stream, const T &value) {
+            stream.write((const char *) &value, sizeof(T));
+        }
+
+        template <class T>
+        bool read(std::ifstream &stream, T &value) {
+            return (bool) stream.read((char *) &value, sizeof(T));
+        }
+
+        // Clears what only lasts one step, the held state stays
+        void clearTransient(InputState &state) {
+            for (auto &key : state.keys)
+                key &= InputState::KEY_DOWN;
+            state.mousePressed = 0;
+            state.mouseReleased = 0;
+            state.wheelX = 0.0f;
+            state.wheelY = 0.0f;
+            for (auto &gamepad : state.gamepads) {
+                gamepad.pressed = 0;
+                gamepad.released = 0;
+            }
+            state.text[0] = '\0';
+            state.eventCount = 0;
+        }
+
+        void addEvent(InputEvent::Type type, int gamepad, int code, uint32_t timestamp) {
+            if (live.eventCount >= InputState::MAX_EVENTS)
+                return;
+            eventTimes[live.eventCount] = timestamp;
+            live.events[live.eventCount++] = InputEvent{type, (uint8_t) gamepad, (uint16_t) code, 0.0f};
+        }
+
+        int gamepadSlot(SDL_JoystickID id) {
+            for (int i = 0; i < InputState::MAX_GAMEPADS; i++) {
+                if (controllers[i] && controllerIds[i] == id)
+                    return i;
+            }
+            return -1;
+        }
+
+        bool sameGamepad(const GamepadState &a, const GamepadState &b) {
+            return a.connected == b.connected && a.buttons == b.buttons && a.pressed == b.pressed &&
+                   a.released == b.released && memcmp(a.axes, b.axes, sizeof(a.axes)) == 0;
+        }
+
+        bool sameEvents(const InputState &a, const InputState &b) {
+            if (a.eventCount != b.eventCount)
+                return false;
+            for (int i = 0; i < a.eventCount; i++) {
+                auto &x = a.events[i];
+                auto &y = b.events[i];
+                if (x.type != y.type || x.gamepad != y.gamepad || x.code != y.code || x.age != y.age)
+                    return false;
+            }
+            return true;
+        }
+
+        void writeFrame(uint8_t flags) {
+            uint16_t changed = 0;
+            for (int i = 0; i < InputState::KEY_COUNT; i++) {
+                if (current.keys[i] != recorded.keys[i])
+                    changed++;
+            }
+            uint8_t changedGamepads = 0;
+            for (int i = 0; i < InputState::MAX_GAMEPADS; i++) {
+                if (!sameGamepad(current.gamepads[i], recorded.gamepads[i]))
+                    changedGamepads++;
+            }
+            bool mouseChanged = current.mouseButtons != recorded.mouseButtons ||
+                                current.mousePressed != recorded.mousePressed ||
+                                current.mouseReleased != recorded.mouseReleased ||
+                                current.mouseX != recorded.mouseX ||
+                                current.mouseY != recorded.mouseY ||
+                                current.wheelX != recorded.wheelX ||
+                                current.wheelY != recorded.wheelY;
+            bool textChanged = strcmp(current.text, recorded.text) != 0;
+            if (changed == 0 && changedGamepads == 0 && !mouseChanged && !textChanged &&
+                sameEvents(current, recorded) && flags == 0)
+                return;
+
+            write(recording, Time::steps);
+            write(recording, flags);
+            write(recording, current.mouseButtons);
+            write(recording, current.mousePressed);
+            write(recording, current.mouseReleased);
+            write(recording, current.mouseX);
+            write(recording, current.mouseY);
+            write(recording, current.wheelX);
+            write(recording, current.wheelY);
+            write(recording, changed);
+            for (uint16_t i = 0; i < InputState::KEY_COUNT; i++) {
+                if (current.keys[i] != recorded.keys[i]) {
+                    write(recording, i);
+                    write(recording, current.keys[i]);
+                }
+            }
+            write(recording, changedGamepads);
+            for (uint8_t i = 0; i < InputState::MAX_GAMEPADS; i++) {
+                auto &gamepad = current.gamepads[i];
+                if (sameGamepad(gamepad, recorded.gamepads[i]))
+                    continue;
+                write(recording, i);
+                write(recording, (uint8_t) gamepad.connected);
+                write(recording, gamepad.buttons);
+                write(recording, gamepad.pressed);
+                write(recording, gamepad.released);
+                for (float value : gamepad.axes)
+                    write(recording, value);
+            }
+            auto textLength = (uint8_t) strlen(current.text);
+            write(recording, textLength);
+            recording.write(current.text, textLength);
+            write(recording, current.eventCount);
+            for (int i = 0; i < current.eventCount; i++) {
+                auto &event = current.events[i];
+                write(recording, (uint8_t) event.type);
+                write(recording, event.gamepad);
+                write(recording, event.code);
+                write(recording, event.age);
+            }
+            recorded = current;
+        }
+
+        void readNextReplayStep() {
+            if (!read(replay, nextReplayStep)) {
+                ENGINE_LOG_WARN(Input, "Replay ended without an end marker");
+                nextReplayStep = UINT64_MAX;
+                replayEnded = true;
+                replayEndStep = Time::steps;
+            }
+        }
+
+        // Applies the frame whose step header was already read
+        void applyReplayFrame() {
+            uint8_t flags = 0;
+            uint16_t changed = 0;
+            bool valid = read(replay, flags) &&
+                         read(replay, current.mouseButtons) &&
+                         read(replay, current.mousePressed) &&
+                         read(replay, current.mouseReleased) &&
+                         read(replay, current.mouseX) &&
+                         read(replay, current.mouseY) &&
+                         read(replay, current.wheelX) &&
+                         read(replay, current.wheelY) &&
+                         read(replay, changed);
+            for (uint16_t i = 0; valid && i < changed; i++) {
+                uint16_t key = 0;
+                uint8_t value = 0;
+                valid = read(replay, key) && read(replay, value) && key < InputState::KEY_COUNT;
+                if (valid)
+                    current.keys[key] = value;
+            }
+
+            uint8_t changedGamepads = 0;
+            valid = valid && read(replay, changedGamepads);
+            for (uint8_t i = 0; valid && i < changedGamepads; i++) {
+                uint8_t index = 0;
+                uint8_t connected = 0;
+                GamepadState gamepad;
+                valid = read(replay, index) && index < InputState::MAX_GAMEPADS &&
+                        read(replay, connected) &&
+                        read(replay, gamepad.buttons) &&
+                        read(replay, gamepad.pressed) &&
+                        read(replay, gamepad.released);
+                for (float &value : gamepad.axes)
+                    valid = valid && read(replay, value);
+                gamepad.connected = connected != 0;
+                if (valid)
+                    current.gamepads[index] = gamepad;
+            }
+
+            uint8_t textLength = 0;
+            valid = valid && read(replay, textLength) && textLength < InputState::TEXT_SIZE &&
+                    replay.read(current.text, textLength);
+            if (valid)
+                current.text[textLength] = '\0';
+
+            valid = valid && read(replay, current.eventCount) && current.eventCount <= InputState::MAX_EVENTS;
+            for (int i = 0; valid && i < current.eventCount; i++) {
+                auto &event = current.events[i];
+                uint8_t type = 0;
+                valid = read(replay, type) && read(replay, event.gamepad) && read(replay, event.code) &&
+                        read(replay, event.age);
+                event.type = (InputEvent::Type) type;
+            }
+
+            if (!valid) {
+                ENGINE_LOG_ERROR(Input, "Corrupted replay frame at step {}", nextReplayStep);
+                current.eventCount = 0;
+                flags = FRAME_END;
+            }
+
+            if (flags & FRAME_END) {
+                replayEnded = true;
+                replayEndStep = nextReplayStep;
+                nextReplayStep = UINT64_MAX;
+                replay.close();
+                return;
+            }
+            readNextReplayStep();
+        }
+
+        bool anyGamepad(int gamepad, const std::function<bool(const GamepadState &)> &test) {
+            if (gamepad >= 0)
+                return gamepad < InputState::MAX_GAMEPADS && test(current.gamepads[gamepad]);
+            for (auto &state : current.gamepads) {
+                if (state.connected && test(state))
+                    return true;
+            }
+            return false;
+        }
+
+        bool testAction(const std::string &action, uint8_t keyFlag, uint32_t InputState::*mouse,
+                        uint32_t GamepadState::*gamepad) {
+            auto found = actions.find(action);
+            if (found == actions.end())
+                return false;
+            for (auto &binding : found->second) {
+                switch (binding.type) {
+                    case Binding::Key:
+                        if (current.keys[binding.code] & keyFlag)
+                            return true;
+                        break;
+                    case Binding::MouseButton:
+                        if (current.*mouse & SDL_BUTTON(binding.code))
+                            return true;
+                        break;
+                    case Binding::Button:
+                        if (anyGamepad(binding.gamepad, [&](const GamepadState &state) {
+                                return (state.*gamepad & (1u << binding.code)) != 0;
+                            }))
+                            return true;
+                        break;
+                    default:
+                        break;
+                }
+            }
+            return false;
+        }
+    }
+
+    float Input::deadZone = 0.2f;
+
+    void Input::event(const SDL_Event &event) {
+        switch (event.type) {
+            case SDL_KEYDOWN:
+            case SDL_KEYUP: {
+                // key repeat isn't input, the key is still down
+                if (event.key.repeat)
+                    break;
+                int scancode = event.key.keysym.scancode;
+                if (scancode < 0 || scancode >= InputState::KEY_COUNT)
+                    break;
+                auto &key = live.keys[scancode];
+                if (event.type == SDL_KEYDOWN) {
+                    key |= InputState::KEY_DOWN | InputState::KEY_PRESSED;
+                    addEvent(InputEvent::KeyDown, 0, scancode, event.key.timestamp);
+                } else {
+                    key = (uint8_t) ((key & ~InputState::KEY_DOWN) | InputState::KEY_RELEASED);
+                    addEvent(InputEvent::KeyUp, 0, scancode, event.key.timestamp);
+                }
+                break;
+            }
+            case SDL_MOUSEMOTION:
+                live.mouseX = (float) event.motion.x;
+                live.mouseY = (float) event.motion.y;
+                break;
+            case SDL_MOUSEBUTTONDOWN:
+            case SDL_MOUSEBUTTONUP: {
+                uint32_t mask = SDL_BUTTON(event.button.button);
+                live.mouseX = (float) event.button.x;
+                live.mouseY = (float) event.button.y;
+                if (event.type == SDL_MOUSEBUTTONDOWN) {
+                    live.mouseButtons |= mask;
+                    live.mousePressed |= mask;
+                    addEvent(InputEvent::MouseDown, 0, event.button.button, event.button.timestamp);
+                } else {
+                    live.mouseButtons &= ~mask;
+                    live.mouseReleased |= mask;
+                    addEvent(InputEvent::MouseUp, 0, event.button.button, event.button.timestamp);
+                }
+                break;
+            }
+            case SDL_MOUSEWHEEL:
+                live.wheelX += (float) event.wheel.x;
+                live.wheelY += (float) event.wheel.y;
+                break;
+            case SDL_TEXTINPUT: {
+                size_t length = strlen(live.text);
+                size_t added = strlen(event.text.text);
+                // whole characters only, the rest of the step's text is dropped
+                if (length + added < InputState::TEXT_SIZE)
+                    memcpy(live.text + length, event.text.text, added + 1);
+                break;
+            }
+            case SDL_CONTROLLERDEVICEADDED: {
+                for (int i = 0; i < InputState::MAX_GAMEPADS; i++) {
+                    if (controllers[i])
+                        continue;
+                    controllers[i] = SDL_GameControllerOpen(event.cdevice.which);
+                    if (!controllers[i]) {
+                        ENGINE_LOG_WARN(Input, "Could not open gamepad {}: {}", event.cdevice.which, SDL_GetError());
+                        break;
+                    }
+                    controllerIds[i] = SDL_JoystickInstanceID(SDL_GameControllerGetJoystick(controllers[i]));
+                    live.gamepads[i] = GamepadState{};
+                    live.gamepads[i].connected = true;
+                    break;
+                }
+                break;
+            }
+            case SDL_CONTROLLERDEVICEREMOVED: {
+                int slot = gamepadSlot(event.cdevice.which);
+                if (slot < 0)
+                    break;
+                SDL_GameControllerClose(controllers[slot]);
+                controllers[slot] = nullptr;
+                // held buttons are released, so the game sees them go up
+                live.gamepads[slot].released |= live.gamepads[slot].buttons;
+                live.gamepads[slot].buttons = 0;
+                live.gamepads[slot].connected = false;
+                for (float &value : live.gamepads[slot].axes)
+                    value = 0.0f;
+                break;
+            }
+            case SDL_CONTROLLERBUTTONDOWN:
+            case SDL_CONTROLLERBUTTONUP: {
+                int slot = gamepadSlot(event.cbutton.which);
+                if (slot < 0 || event.cbutton.button >= 32)
+                    break;
+                auto &gamepad = live.gamepads[slot];
+                uint32_t mask = 1u << event.cbutton.button;
+                if (event.type == SDL_CONTROLLERBUTTONDOWN) {
+                    gamepad.buttons |= mask;
+                    gamepad.pressed |= mask;
+                    addEvent(InputEvent::GamepadDown, slot, event.cbutton.button, event.cbutton.timestamp);
+                } else {
+                    gamepad.buttons &= ~mask;
+                    gamepad.released |= mask;
+                    addEvent(InputEvent::GamepadUp, slot, event.cbutton.button, event.cbutton.timestamp);
+                }
+                break;
+            }
+            case SDL_CONTROLLERAXISMOTION: {
+                int slot = gamepadSlot(event.caxis.which);
+                if (slot < 0 || event.caxis.axis >= (int) GamepadAxis::Count)
+                    break;
+                live.gamepads[slot].axes[event.caxis.axis] = std::max(event.caxis.value / 32767.0f, -1.0f);
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+    void Input::poll() {
+        switch (source) {
+            case Source::Devices: {
+                uint32_t now = SDL_GetTicks();
+                current = live;
+                for (int i = 0; i < current.eventCount; i++)
+                    current.events[i].age = (float) (now - eventTimes[i]) / 1000.0f;
+                // the next step of the same frame only sees what's held
+                clearTransient(live);
+                break;
+            }
+            case Source::Replay:
+                while (nextReplayStep <= Time::steps)
+                    applyReplayFrame();
+                break;
+            case Source::Scripted:
+                break;
+        }
+
+        if (recording.is_open())
+            writeFrame(0);
+    }
 
     void Input::update() {
-        memcpy(&previousKeyboard, SDL_GetKeyboardState(nullptr), SDL_NUM_SCANCODES);
+        clearTransient(current);
+        // a replay clears its snapshot the same way, frames are diffed against what it will have
+        clearTransient(recorded);
     }
 
     bool Input::down(Key key) {
-        auto* state = SDL_GetKeyboardState(nullptr);
-        return state[key];
+        return current.keys[key] & InputState::KEY_DOWN;
     }
 
     bool Input::pressed(Key key) {
-        auto* state = SDL_GetKeyboardState(nullptr);
-        return state[key] && !previousKeyboard[key];
+        return current.keys[key] & InputState::KEY_PRESSED;
+    }
+
+    bool Input::released(Key key) {
+        return current.keys[key] & InputState::KEY_RELEASED;
+    }
+
+    bool Input::down(Engine::Mouse button) {
+        return current.mouseButtons & SDL_BUTTON(button);
     }
 
     bool Input::pressed(Engine::Mouse button) {
-        return SDL_GetMouseState(nullptr, nullptr) & SDL_BUTTON(button);
+        return current.mousePressed & SDL_BUTTON(button);
     }
 
-    std::pair<float, float> Input::getMousePosition() {
-        int x, y;
-        SDL_GetMouseState(&x, &y);
+    bool Input::released(Engine::Mouse button) {
+        return current.mouseReleased & SDL_BUTTON(button);
+    }
 
-        return std::pair(x, y);
+    std::pair<float, float> Input::getMousePosition() {
+        return std::pair(current.mouseX, current.mouseY);
     }
 
     float Input::getMouseX() {
-        return (float) getMousePosition().first;
+        return current.mouseX;
     }
 
     float Input::getMouseY() {
-        return (float) getMousePosition().second;
+        return current.mouseY;
+    }
+
+    std::pair<float, float> Input::getMouseWheel() {
+        return std::pair(current.wheelX, current.wheelY);
+    }
+
+    bool Input::connected(int gamepad) {
+        return gamepad >= 0 && gamepad < InputState::MAX_GAMEPADS && current.gamepads[gamepad].connected;
+    }
+
+    bool Input::down(GamepadButton button, int gamepad) {
+        return connected(gamepad) && (current.gamepads[gamepad].buttons & (1u << (int) button));
+    }
+
+    bool Input::pressed(GamepadButton button, int gamepad) {
+        return connected(gamepad) && (current.gamepads[gamepad].pressed & (1u << (int) button));
+    }
+
+    bool Input::released(GamepadButton button, int gamepad) {
+        // a gamepad unplugged during the step releases its buttons
+        return gamepad >= 0 && gamepad < InputState::MAX_GAMEPADS &&
+               (current.gamepads[gamepad].released & (1u << (int) button));
+    }
+
+    float Input::axis(GamepadAxis axis, int gamepad) {
+        if (!connected(gamepad))
+            return 0.0f;
+        float value = current.gamepads[gamepad].axes[(int) axis];
+        float magnitude = std::abs(value);
+        if (magnitude <= deadZone)
+            return 0.0f;
+        // rescaled so the output still starts at 0 right outside the dead zone
+        return std::copysign(std::min((magnitude - deadZone) / (1.0f - deadZone), 1.0f), value);
+    }
+
+    const char *Input::text() {
+        return current.text;
+    }
+
+    void Input::bindAction(const std::string &action, Key key) {
+        actions[action].push_back(Binding{Binding::Key, key, 0, -1});
+    }
+
+    void Input::bindAction(const std::string &action, Engine::Mouse button) {
+        actions[action].push_back(Binding{Binding::MouseButton, button, 0, -1});
+    }
+
+    void Input::bindAction(const std::string &action, GamepadButton button, int gamepad) {
+        actions[action].push_back(Binding{Binding::Button, (int) button, 0, gamepad});
+    }
+
+    void Input::bindAxis(const std::string &axis, Key negative, Key positive) {
+        axes[axis].push_back(Binding{Binding::KeyPair, negative, positive, -1});
+    }
+
+    void Input::bindAxis(const std::string &axis, GamepadAxis gamepadAxis, int gamepad) {
+        axes[axis].push_back(Binding{Binding::Axis, (int) gamepadAxis, 0, gamepad});
+    }
+
+    void Input::clearBindings() {
+        actions.clear();
+        axes.clear();
+    }
+
+    bool Input::down(const std::string &action) {
+        return testAction(action, InputState::KEY_DOWN, &InputState::mouseButtons, &GamepadState::buttons);
+    }
+
+    bool Input::pressed(const std::string &action) {
+        return testAction(action, InputState::KEY_PRESSED, &InputState::mousePressed, &GamepadState::pressed);
+    }
+
+    bool Input::released(const std::string &action) {
+        return testAction(action, InputState::KEY_RELEASED, &InputState::mouseReleased, &GamepadState::released);
+    }
+
+    float Input::axis(const std::string &name) {
+        auto found = axes.find(name);
+        if (found == axes.end())
+            return 0.0f;
+        float strongest = 0.0f;
+        auto consider = [&strongest](float value) {
+            if (std::abs(value) > std::abs(strongest))
+                strongest = value;
+        };
+        for (auto &binding : found->second) {
+            if (binding.type == Binding::KeyPair) {
+                consider((float) down((Key) binding.positive) - (float) down((Key) binding.code));
+            } else if (binding.gamepad >= 0) {
+                consider(axis((GamepadAxis) binding.code, binding.gamepad));
+            } else {
+                for (int i = 0; i < InputState::MAX_GAMEPADS; i++)
+                    consider(axis((GamepadAxis) binding.code, i));
+            }
+        }
+        return strongest;
+    }
+
+    void Input::setSource(Source value) {
+        source = value;
+    }
+
+    Input::Source Input::getSource() {
+        return source;
+    }
+
+    void Input::setKey(Key key, bool down) {
+        if (source != Source::Scripted)
+            return;
+        auto &value = current.keys[key];
+        bool wasDown = value & InputState::KEY_DOWN;
+        if (down && !wasDown)
+            value |= InputState::KEY_DOWN | InputState::KEY_PRESSED;
+        else if (!down && wasDown)
+            value = (uint8_t) ((value & ~InputState::KEY_DOWN) | InputState::KEY_RELEASED);
+    }
+
+    void Input::setMouseButton(Engine::Mouse button, bool down) {
+        if (source != Source::Scripted)
+            return;
+        uint32_t mask = SDL_BUTTON(button);
+        bool wasDown = current.mouseButtons & mask;
+        if (down && !wasDown) {
+            current.mouseButtons |= mask;
+            current.mousePressed |= mask;
+        } else if (!down && wasDown) {
+            current.mouseButtons &= ~mask;
+            current.mouseReleased |= mask;
+        }
+    }
+
+    void Input::setMousePosition(float x, float y) {
+        if (source != Source::Scripted)
+            return;
+        current.mouseX = x;
+        current.mouseY = y;
+    }
+
+    const InputState &Input::state() {
+        return current;
+    }
+
+    bool Input::startRecording(const std::string &path, uint32_t seed) {
+        stopRecording();
+        recording.open(path, std::ios::binary | std::ios::trunc);
+        if (!recording.is_open()) {
+            ENGINE_LOG_ERROR(Input, "Could not open {} for recording", path);
+            return false;
+        }
+        recording.write(RECORDING_MAGIC, sizeof(RECORDING_MAGIC));
+        write(recording, RECORDING_VERSION);
+        write(recording, seed);
+        recorded = InputState{};
+        ENGINE_LOG_INFO(Input, "Recording input to {} (seed {})", path, seed);
+        return true;
+    }
+
+    void Input::stopRecording() {
+        if (!recording.is_open())
+            return;
+        writeFrame(FRAME_END);
+        recording.close();
+    }
+
+    bool Input::startReplay(const std::string &path, uint32_t &seed) {
+        replay.close();
+        replay.clear();
+        replay.open(path, std::ios::binary);
+        if (!replay.is_open()) {
+            ENGINE_LOG_ERROR(Input, "Could not open replay {}", path);
+            return false;
+        }
+
+        char magic[4];
+        uint32_t version = 0;
+        if (!replay.read(magic, sizeof(magic)) || memcmp(magic, RECORDING_MAGIC, sizeof(magic)) != 0 ||
+            !read(replay, version) || version != RECORDING_VERSION || !read(replay, seed)) {
+            ENGINE_LOG_ERROR(Input, "{} is not a valid input recording", path);
+            replay.close();
+            return false;
+        }
+
+        current = InputState{};
+        replayEnded = false;
+        source = Source::Replay;
+        readNextReplayStep();
+        ENGINE_LOG_INFO(Input, "Replaying input from {} (seed {})", path, seed);
+        return true;
+    }
+
+    bool Input::replayFinished() {
+        return source == Source::Replay && replayEnded && Time::steps >= replayEndStep;
     }
 }
@@ -1,21 +1,172 @@
 #include "Log.h"
+#include "spdlog/async.h"
+#include "spdlog/details/file_helper.h"
+#include "spdlog/sinks/base_sink.h"
 #include "spdlog/sinks/stdout_color_sinks.h"
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 
 namespace Engine {
 
-    std::shared_ptr<spdlog::logger> Log::coreLogger;
-    std::shared_ptr<spdlog::logger> Log::clientLogger;
+    namespace {
+
+        const char *CATEGORY_NAMES[] = {"ENGINE", "APP", "GRAPHICS", "AUDIO", "INPUT", "ECS", "CONTENT"};
+
+        // Writes messages as JSON lines (runs on the logging thread, behind Sink's mutex)
+        class JsonSink : public spdlog::sinks::base_sink<spdlog::details::null_mutex> {
+        public:
+            explicit JsonSink(const std::string &path) {
+                file.open(path, true);
+            }
+
+        protected:
+            void sink_it_(const spdlog::details::log_msg &msg) override {
+                using namespace std::chrono;
+                auto millis = duration_cast<milliseconds>(msg.time.time_since_epoch()).count();
+                auto level = spdlog::level::to_string_view(msg.level);
+
+                buffer.clear();
+                fmt::format_to(buffer, "{{\"time\":{},\"level\":\"{}\",\"category\":\"{}\",\"thread\":{}",
+                               millis, fmt::string_view(level.data(), level.size()),
+                               fmt::string_view(msg.logger_name.data(), msg.logger_name.size()), msg.thread_id);
+                if (!msg.source.empty())
+                    fmt::format_to(buffer, ",\"file\":\"{}\",\"line\":{}", msg.source.filename, msg.source.line);
+                buffer.append(fmt::string_view(",\"message\":\""));
+                escape(msg.payload);
+                buffer.append(fmt::string_view("\"}\n"));
+                file.write(buffer);
+            }
+
+            void flush_() override {
+                file.flush();
+            }
+
+        private:
+            spdlog::details::file_helper file;
+            spdlog::memory_buf_t buffer;
+
+            void escape(spdlog::string_view_t text) {
+                for (char ch : text) {
+                    if (ch == '"' || ch == '\\') {
+                        buffer.push_back('\\');
+                        buffer.push_back(ch);
+                    } else if ((unsigned char) ch < 0x20) {
+                        fmt::format_to(buffer, "\\u{:04x}", (int) ch);
+                    } else {
+                        buffer.push_back(ch);
+                    }
+                }
+            }
+        };
+
+        // Every logger writes here: applies the per call site rate limit and forwards to the console / file
+        class Sink : public spdlog::sinks::base_sink<std::mutex> {
+        public:
+            void add(std::shared_ptr<spdlog::sinks::sink> sink) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                sinks.push_back(std::move(sink));
+            }
+
+        protected:
+            void sink_it_(const spdlog::details::log_msg &msg) override {
+                if (msg.source.empty()) {
+                    forward(msg);
+                    return;
+                }
+
+                // filenames are string literals, the pointer identifies the file
+                auto key = (uint64_t) (uintptr_t) msg.source.filename * 31 + (uint64_t) msg.source.line;
+                auto &window = windows[key];
+                if (msg.time - window.start >= std::chrono::seconds(1)) {
+                    if (window.dropped > 0) {
+                        auto text = fmt::format("{} messages from {}:{} were dropped", window.dropped,
+                                                msg.source.filename, msg.source.line);
+                        forward(spdlog::details::log_msg(msg.source, msg.logger_name, spdlog::level::warn, text));
+                    }
+                    window = Window{msg.time};
+                }
+
+                if (window.count++ < Log::RATE_LIMIT)
+                    forward(msg);
+                else
+                    window.dropped++;
+            }
+
+            void flush_() override {
+                for (auto &sink : sinks)
+                    sink->flush();
+            }
+
+        private:
+            struct Window {
+                spdlog::log_clock::time_point start;
+                int count = 0;
+                int dropped = 0;
+            };
+
+            std::vector<std::shared_ptr<spdlog::sinks::sink>> sinks;
+            std::unordered_map<uint64_t, Window> windows;
+
+            void forward(const spdlog::details::log_msg &msg) {
+                for (auto &sink : sinks) {
+                    if (sink->should_log(msg.level))
+                        sink->log(msg);
+                }
+            }
+        };
+
+        std::shared_ptr<Sink> sink;
+    }
+
+    std::array<std::shared_ptr<spdlog::logger>, (size_t) Log::Category::Count> Log::loggers;
 
     void Log::init() {
-        spdlog::set_pattern("%^[%T] %n: %v%$");
-        coreLogger = spdlog::stdout_color_mt("ENGINE");
-        coreLogger->set_level(spdlog::level::level_enum::trace);
-        clientLogger = spdlog::stdout_color_mt("APP");
-        clientLogger->set_level(spdlog::level::level_enum::trace);
+        spdlog::init_thread_pool(QUEUE_SIZE, 1);
+
+        auto console = std::make_shared<spdlog::sinks::stdout_color_sink_mt>();
+        console->set_pattern("%^[%T] %n: %v%$");
+        sink = std::make_shared<Sink>();
+        sink->add(console);
+
+        for (size_t i = 0; i < loggers.size(); i++) {
+            auto logger = std::make_shared<spdlog::async_logger>(CATEGORY_NAMES[i], sink, spdlog::thread_pool(),
+                                                                 spdlog::async_overflow_policy::overrun_oldest);
+            logger->set_level(spdlog::level::level_enum::trace);
+            // the sinks are flushed after errors, so they reach the file even if a crash follows
+            logger->flush_on(spdlog::level::err);
+            spdlog::register_logger(logger);
+            loggers[i] = logger;
+        }
+    }
+
+    bool Log::openFile(const std::string &path) {
+        try {
+            sink->add(std::make_shared<JsonSink>(path));
+        } catch (const spdlog::spdlog_ex &exception) {
+            ENGINE_CORE_ERROR("Unable to open the log file {}: {}", path, exception.what());
+            return false;
+        }
+        return true;
+    }
+
+    void Log::shutdown() {
+        // messages logged after this (static destructors) are written right away, on the calling thread
+        for (auto &logger : loggers) {
+            auto synchronous = std::make_shared<spdlog::logger>(logger->name(), sink);
+            synchronous->set_level(logger->level());
+            logger = synchronous;
+        }
+        // the thread pool writes out its queue before it stops
+        spdlog::shutdown();
+    }
+
+    void Log::setLevel(Category category, spdlog::level::level_enum level) {
+        get(category)->set_level(level);
     }
 
     Log::Log() = default;
 
     Log::~Log() = default;
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,259 @@
+#include "Profiler.h"
+#include "Log.h"
+#include "imgui.h"
+#include <json/json.h>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <algorithm>
+
+using json = nlohmann::json;
+
+namespace Engine
+{
+    namespace
+    {
+        struct ThreadBuffer
+        {
+            uint32_t id = 0;
+            std::string name;
+            uint32_t depth = 0;
+            // written only by the owning thread, the release store publishes the event
+            std::atomic<uint64_t> head{0};
+            Profiler::Event events[Profiler::CAPACITY];
+        };
+
+        std::mutex registryMutex;
+        // Buffers are never freed, a thread that exits still shows up in the timeline / trace
+        std::vector<std::unique_ptr<ThreadBuffer>> registry;
+        std::atomic<bool> paused{false};
+
+        uint64_t frameStarts[Profiler::FRAME_HISTORY]{};
+        std::atomic<uint64_t> frameCount{0};
+
+        thread_local ThreadBuffer *localBuffer = nullptr;
+
+        ThreadBuffer &threadBuffer()
+        {
+            if (!localBuffer)
+            {
+                std::lock_guard<std::mutex> lock(registryMutex);
+                auto &buffer = registry.emplace_back(new ThreadBuffer());
+                buffer->id = (uint32_t)registry.size() - 1;
+                buffer->name = "Thread " + std::to_string(buffer->id);
+                localBuffer = buffer.get();
+            }
+            return *localBuffer;
+        }
+
+        // Stable, cheap color per zone name (names are static strings so the pointer is enough)
+        ImU32 zoneColor(const char *name)
+        {
+            auto hash = (uint32_t)(((uintptr_t)name >> 3) * 2654435761u);
+            return IM_COL32(80 + (hash & 0x7F), 80 + ((hash >> 8) & 0x7F), 80 + ((hash >> 16) & 0x7F), 255);
+        }
+
+        // Copies the events still held in the ring buffer, oldest first
+        void readEvents(const ThreadBuffer &buffer, std::vector<Profiler::Event> &out)
+        {
+            uint64_t head = buffer.head.load(std::memory_order_acquire);
+            uint64_t count = std::min<uint64_t>(head, Profiler::CAPACITY);
+            out.clear();
+            out.reserve(count);
+            for (uint64_t i = head - count; i < head; i++)
+                out.push_back(buffer.events[i % Profiler::CAPACITY]);
+        }
+    }
+
+    Profiler::Zone::Zone(const char *name) : name{paused.load(std::memory_order_relaxed) ? nullptr : name},
+                                             start{now()}
+    {
+        threadBuffer().depth++;
+    }
+
+    Profiler::Zone::~Zone()
+    {
+        auto &buffer = threadBuffer();
+        buffer.depth--;
+        if (!name)
+            return;
+
+        uint64_t head = buffer.head.load(std::memory_order_relaxed);
+        auto &event = buffer.events[head % CAPACITY];
+        event.name = name;
+        event.start = start;
+        event.end = now();
+        event.depth = buffer.depth;
+        buffer.head.store(head + 1, std::memory_order_release);
+    }
+
+    uint64_t Profiler::now()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
+
+    void Profiler::frame()
+    {
+        if (paused.load(std::memory_order_relaxed))
+            return;
+        auto count = frameCount.load(std::memory_order_relaxed);
+        frameStarts[count % FRAME_HISTORY] = now();
+        frameCount.store(count + 1, std::memory_order_release);
+    }
+
+    void Profiler::setThreadName(const std::string &name)
+    {
+        auto &buffer = threadBuffer();
+        std::lock_guard<std::mutex> lock(registryMutex);
+        buffer.name = name;
+    }
+
+    void Profiler::setPaused(bool value)
+    {
+        paused.store(value);
+    }
+
+    bool Profiler::isPaused()
+    {
+        return paused.load();
+    }
+
+    void Profiler::drawImGui()
+    {
+        ImGui::Begin("Profiler");
+
+        bool pause = isPaused();
+        if (ImGui::Checkbox("Pause", &pause))
+            setPaused(pause);
+        ImGui::SameLine();
+        if (ImGui::Button("Export trace"))
+        {
+            if (exportChromeTrace("trace.json"))
+                ENGINE_CORE_INFO("Profiler trace written to trace.json");
+        }
+
+        uint64_t frames = frameCount.load(std::memory_order_acquire);
+        if (frames < 2)
+        {
+            ImGui::Text("Waiting for frames...");
+            ImGui::End();
+            return;
+        }
+
+        // Frame time graph
+        {
+            float times[FRAME_HISTORY]{};
+            int count = (int)std::min<uint64_t>(frames - 1, FRAME_HISTORY - 1);
+            for (int i = 0; i < count; i++)
+            {
+                uint64_t frame = frames - count + i;
+                times[i] = (frameStarts[frame % FRAME_HISTORY] - frameStarts[(frame - 1) % FRAME_HISTORY]) / 1000000.0f;
+            }
+            char overlay[32];
+            snprintf(overlay, sizeof(overlay), "%.2f ms", times[count - 1]);
+            ImGui::PlotLines("##frames", times, count, 0, overlay, 0.0f, 33.3f, ImVec2(0, 60));
+        }
+
+        // Timeline of the last complete frame
+        uint64_t frameStart = frameStarts[(frames - 2) % FRAME_HISTORY];
+        uint64_t frameEnd = frameStarts[(frames - 1) % FRAME_HISTORY];
+        float frameDuration = (float)(frameEnd - frameStart);
+        const float rowHeight = ImGui::GetTextLineHeight() + 4.0f;
+
+        std::vector<Event> events;
+        std::lock_guard<std::mutex> lock(registryMutex);
+        for (auto &buffer : registry)
+        {
+            readEvents(*buffer, events);
+
+            uint32_t maxDepth = 0;
+            for (auto &event : events)
+            {
+                if (event.end >= frameStart && event.start <= frameEnd)
+                    maxDepth = std::max(maxDepth, event.depth);
+            }
+
+            ImGui::Text("%s", buffer->name.c_str());
+            ImVec2 origin = ImGui::GetCursorScreenPos();
+            float width = std::max(ImGui::GetContentRegionAvail().x, 100.0f);
+            ImGui::InvisibleButton(buffer->name.c_str(), ImVec2(width, rowHeight * (maxDepth + 1)));
+
+            auto *drawList = ImGui::GetWindowDrawList();
+            ImVec2 mouse = ImGui::GetMousePos();
+            for (auto &event : events)
+            {
+                if (event.end < frameStart || event.start > frameEnd)
+                    continue;
+
+                float x0 = origin.x + width * (std::max(event.start, frameStart) - frameStart) / frameDuration;
+                float x1 = origin.x + width * (std::min(event.end, frameEnd) - frameStart) / frameDuration;
+                float y0 = origin.y + rowHeight * event.depth;
+                ImVec2 min{x0, y0};
+                ImVec2 max{std::max(x1, x0 + 1.0f), y0 + rowHeight - 1.0f};
+
+                drawList->AddRectFilled(min, max, zoneColor(event.name));
+                drawList->PushClipRect(min, max, true);
+                drawList->AddText(ImVec2(x0 + 2.0f, y0 + 2.0f), IM_COL32_WHITE, event.name);
+                drawList->PopClipRect();
+
+                if (mouse.x >= min.x && mouse.x < max.x && mouse.y >= min.y && mouse.y < max.y)
+                    ImGui::SetTooltip("%s: %.3f ms", event.name, (event.end - event.start) / 1000000.0f);
+            }
+        }
+
+        ImGui::End();
+    }
+
+    bool Profiler::exportChromeTrace(const std::string &path)
+    {
+        json trace;
+        auto &traceEvents = trace["traceEvents"] = json::array();
+
+        std::vector<Event> events;
+        uint64_t base = UINT64_MAX;
+        {
+            std::lock_guard<std::mutex> lock(registryMutex);
+            for (auto &buffer : registry)
+            {
+                readEvents(*buffer, events);
+                if (!events.empty())
+                    base = std::min(base, events.front().start);
+            }
+
+            for (auto &buffer : registry)
+            {
+                traceEvents.push_back({{"name", "thread_name"},
+                                       {"ph", "M"},
+                                       {"pid", 0},
+                                       {"tid", buffer->id},
+                                       {"args", {{"name", buffer->name}}}});
+
+                readEvents(*buffer, events);
+                for (auto &event : events)
+                {
+                    traceEvents.push_back({{"name", event.name},
+                                           {"cat", "engine"},
+                                           {"ph", "X"},
+                                           {"pid", 0},
+                                           {"tid", buffer->id},
+                                           {"ts", (event.start - base) / 1000.0},
+                                           {"dur", (event.end - event.start) / 1000.0}});
+                }
+            }
+        }
+
+        std::ofstream writer(path);
+        if (!writer.is_open())
+        {
+            ENGINE_CORE_ERROR("Could not write profiler trace {}", path);
+            return false;
+        }
+        writer << trace;
+        return true;
+    }
+}
@@ -3,47 +3,51 @@
 //
 
 #include "TexturePacker.h"
+#include "ImageOps.h"
+#include <algorithm>
 
-void Engine::TexturePacker::addEntry(int id, int w, int h, Engine::Color *color)
+void Engine::TexturePacker::addEntry(int id, int w, int h, const Engine::Color *color)
 {
     entries.emplace_back(id, w, h, color);
 }
 
-void set_pixels(Engine::Color *dst, const Engine::RectI &rect, Engine::Color *data, int w)
+std::shared_ptr<Engine::Texture> Engine::TexturePacker::pack()
 {
-    for (int y = 0; y < rect.h; y++)
-    {
-        int to = rect.x + (rect.y + y) * w;
-        int from = (y * rect.w);
-        memcpy(dst + to, data + from, sizeof(Engine::Color) * rect.w);
-    }
+    int width, height;
+    auto data = packPixels(width, height);
+    return Engine::Texture::create(width, height, (unsigned char *)data.data());
 }
 
-std::shared_ptr<Engine::Texture> Engine::TexturePacker::pack()
+std::vector<Engine::Color> Engine::TexturePacker::packPixels(int &width, int &height, int maxWidth)
 {
-
-    // Todo: just list all textures horizontally for now
+    // Todo: rows in the order the entries were added for now
     //  doesn't even consider full alhpa?
-    // Find the tallest image
-    int maxHeight = 0;
-    int widthSum = 0;
+    // Place every entry first, each row is as tall as its tallest entry
+    width = 0;
+    height = 0;
+    int x = 0, rowHeight = 0;
     for (auto &entry : entries)
     {
-        if (entry.h > maxHeight)
-            maxHeight = entry.h;
-        widthSum += entry.w;
+        if (x > 0 && x + entry.w > maxWidth)
+        {
+            height += rowHeight;
+            x = 0;
+            rowHeight = 0;
+        }
+        entry.rect = Engine::Rect(x, height, entry.w, entry.h);
+        x += entry.w;
+        rowHeight = std::max(rowHeight, entry.h);
+        width = std::max(width, x);
     }
+    height += rowHeight;
 
-    Engine::Color data[widthSum * maxHeight];
-    int x = 0;
+    std::vector<Engine::Color> data((size_t)width * height);
     for (auto &entry : entries)
     {
-        entry.rect = Engine::Rect(x, 0, entry.w, entry.h);
-        set_pixels(data, Engine::RectI(x, 0, entry.w, entry.h), entry.color, widthSum);
-        x += entry.w;
+        auto *target = data.data() + (size_t)entry.rect.y * width + (size_t)entry.rect.x;
+        Engine::ImageOps::blit(target, width, entry.color, entry.w, entry.w, entry.h);
     }
-
-    return Engine::Texture::create(widthSum, maxHeight, (unsigned char *)data);
+    return data;
 }
 
 Engine::Rect *Engine::TexturePacker::getEntryRect(int id)
@@ -61,11 +65,3 @@ void Engine::TexturePacker::clear()
     entries.clear();
 }
 
-Engine::TexturePacker::Entry::~Entry()
-{
-    if (color)
-    {
-        delete[] color;
-        color = nullptr;
-    }
-}
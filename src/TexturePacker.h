@@ -1,5 +1,6 @@
 #pragma once
 
+#include <climits>
 #include <vector>
 #include <rect.h>
 #include "Texture.h"
@@ -13,39 +14,14 @@ namespace Engine
     {
 
     private:
+        // Entries only reference their pixels, they must stay valid until pack() returns
         struct Entry
         {
-            Entry(int id, int w, int h, Engine::Color *color) : id{id}, w{w}, h{h}, color{color} {}
-
-            // copy constructor
-            Entry(const Entry &other)
-            {
-                this->rect = other.rect;
-                this->id = other.id;
-                this->w = other.w;
-                this->h = other.h;
-                this->color = new Color[w * h];
-                memcpy(this->color, other.color, sizeof(Color) * h * w);
-            };
-            Entry &operator=(const Entry &other) = delete;
-
-            // move constructor
-            Entry(Entry &&other)
-            {
-                this->rect = other.rect;
-                this->id = other.id;
-                this->w = other.w;
-                this->h = other.h;
-                this->color = other.color;
-                other.color = nullptr;
-            }
-            Entry &operator=(Entry &&other) = delete;
+            Entry(int id, int w, int h, const Engine::Color *color) : id{id}, w{w}, h{h}, color{color} {}
 
             int id, w, h;
-            Engine::Color *color;
+            const Engine::Color *color;
             Engine::Rect rect;
-
-            ~Entry();
         };
 
         std::vector<Entry> entries;
@@ -53,10 +29,14 @@ namespace Engine
     public:
         Engine::Rect *getEntryRect(int id);
 
-        void addEntry(int id, int w, int h, Engine::Color *color);
+        void addEntry(int id, int w, int h, const Engine::Color *color);
 
         std::shared_ptr<Engine::Texture> pack();
 
+        // Lays the entries out like pack() but returns the pixels instead of uploading them.
+        // Entries are placed left to right in rows no wider than `maxWidth` (wider entries get a row of their own).
+        std::vector<Engine::Color> packPixels(int &width, int &height, int maxWidth = INT_MAX);
+
         void clear();
     };
 
@@ -0,0 +1,278 @@
+#include "Audio.h"
+#include "AudioBackend.h"
+#include "Application.h"
+#include "Content.h"
+#include "Log.h"
+#include "time/time.h"
+#include <algorithm>
+#include <array>
+#include <vector>
+
+namespace Engine
+{
+    float Audio::range = 400.0f;
+
+    namespace
+    {
+        struct Sound
+        {
+            std::string file;
+            void *data;
+            Audio::Bus bus;
+            int priority;
+        };
+
+        struct Slot
+        {
+            bool active = false;
+            // bumped every time the slot is reused, so old handles stop matching
+            uint32_t generation = 0;
+            SoundId sound = Audio::INVALID_SOUND;
+            int priority = 0;
+            uint64_t started = 0;
+            float volume = 1.0f;
+            bool spatial = false;
+            glm::vec2 position{};
+            // volume, position or a bus changed since the voice was last mixed
+            bool dirty = false;
+        };
+
+        std::unique_ptr<AudioBackend> backend;
+        std::vector<Sound> bank;
+        std::array<Slot, Audio::MAX_VOICES> slots;
+        std::array<float, (size_t)Audio::Bus::Count> buses{1.0f, 1.0f, 1.0f};
+        float master = 1.0f;
+        glm::vec2 listener{};
+        uint64_t playCount = 0;
+
+        Slot *slotOf(Voice voice)
+        {
+            uint32_t index = (voice.id & 0xFF) - 1;
+            if (!voice.valid() || index >= Audio::MAX_VOICES)
+                return nullptr;
+            Slot &slot = slots[index];
+            return slot.active && slot.generation == voice.id >> 8 ? &slot : nullptr;
+        }
+
+        // The voice for a new sound: a free one, else the least important (oldest first) unless it outranks the sound
+        int acquire(int priority)
+        {
+            int victim = -1;
+            for (int i = 0; i < Audio::MAX_VOICES; i++)
+            {
+                Slot &slot = slots[i];
+                if (!slot.active)
+                    return i;
+                if (victim < 0 || slot.priority < slots[victim].priority ||
+                    (slot.priority == slots[victim].priority && slot.started < slots[victim].started))
+                    victim = i;
+            }
+            if (slots[victim].priority > priority)
+                return -1;
+            backend->stop(victim);
+            return victim;
+        }
+
+        void mix(int index)
+        {
+            Slot &slot = slots[index];
+            float volume = slot.volume * buses[(size_t)bank[slot.sound].bus] * master;
+            float pan = 0.0f;
+            if (slot.spatial)
+            {
+                glm::vec2 offset = slot.position - listener;
+                volume *= std::clamp(1.0f - glm::length(offset) / Audio::range, 0.0f, 1.0f);
+                pan = std::clamp(offset.x / Audio::range, -1.0f, 1.0f);
+            }
+            backend->mix(index, volume, pan);
+            slot.dirty = false;
+        }
+
+        Voice start(SoundId sound, float volume, bool loop, bool spatial, const glm::vec2 &position)
+        {
+            if (!backend || sound >= bank.size() || !bank[sound].data)
+                return Voice{};
+
+            int index = acquire(bank[sound].priority);
+            if (index < 0)
+                return Voice{};
+
+            Slot &slot = slots[index];
+            slot.active = true;
+            slot.generation = (slot.generation + 1) & 0xFFFFFF;
+            slot.sound = sound;
+            slot.priority = bank[sound].priority;
+            slot.started = playCount++;
+            slot.volume = volume;
+            slot.spatial = spatial;
+            slot.position = position;
+            // set before playing so the first samples come out at the right volume
+            mix(index);
+            backend->play(index, bank[sound].data, loop);
+            return Voice{(slot.generation << 8) | (uint32_t)(index + 1)};
+        }
+
+        void markDirty()
+        {
+            for (auto &slot : slots)
+                slot.dirty = slot.active;
+        }
+    }
+
+    void Audio::init()
+    {
+        backend = Application::isHeadless() ? AudioBackend::createNull() : AudioBackend::createMixer();
+        if (!backend->open(MAX_VOICES))
+        {
+            // no device (or no sound card), the game keeps running silently
+            ENGINE_LOG_WARN(Audio, "Audio disabled, sounds won't be heard");
+            backend = AudioBackend::createNull();
+            backend->open(MAX_VOICES);
+        }
+        backend->setMusicVolume(buses[(size_t)Bus::Music] * master);
+    }
+
+    void Audio::shutdown()
+    {
+        if (!backend)
+            return;
+        backend->close();
+        for (auto &sound : bank)
+        {
+            if (sound.data)
+                backend->free(sound.data);
+        }
+        bank.clear();
+        slots = {};
+        backend = nullptr;
+    }
+
+    void Audio::update()
+    {
+        if (!backend)
+            return;
+        backend->update(Time::delta);
+        for (int i = 0; i < MAX_VOICES; i++)
+        {
+            Slot &slot = slots[i];
+            if (!slot.active)
+                continue;
+            if (!backend->playing(i))
+                slot.active = false;
+            else if (slot.dirty)
+                mix(i);
+        }
+    }
+
+    SoundId Audio::load(const std::string &file, Bus bus, int priority)
+    {
+        ENGINE_ASSERT(backend, "Audio::load called before Audio::init");
+        SoundId id = find(file);
+        if (id != INVALID_SOUND)
+            return id;
+        void *data = backend->load(Content::path() + file);
+        if (!data)
+            return INVALID_SOUND;
+        bank.push_back(Sound{file, data, bus, priority});
+        return (SoundId)(bank.size() - 1);
+    }
+
+    SoundId Audio::find(const std::string &file)
+    {
+        for (size_t i = 0; i < bank.size(); i++)
+        {
+            if (bank[i].file == file)
+                return (SoundId)i;
+        }
+        return INVALID_SOUND;
+    }
+
+    Voice Audio::play(SoundId sound, float volume, bool loop)
+    {
+        return start(sound, volume, loop, false, glm::vec2{});
+    }
+
+    Voice Audio::playAt(SoundId sound, const glm::vec2 &position, float volume, bool loop)
+    {
+        return start(sound, volume, loop, true, position);
+    }
+
+    void Audio::stop(Voice voice)
+    {
+        if (Slot *slot = slotOf(voice))
+        {
+            backend->stop((int)(slot - slots.data()));
+            slot->active = false;
+        }
+    }
+
+    bool Audio::isPlaying(Voice voice)
+    {
+        return slotOf(voice) != nullptr;
+    }
+
+    void Audio::setPosition(Voice voice, const glm::vec2 &position)
+    {
+        Slot *slot = slotOf(voice);
+        if (!slot || (slot->spatial && slot->position == position))
+            return;
+        slot->spatial = true;
+        slot->position = position;
+        slot->dirty = true;
+    }
+
+    void Audio::setVolume(Voice voice, float volume)
+    {
+        if (Slot *slot = slotOf(voice))
+        {
+            slot->volume = volume;
+            slot->dirty = true;
+        }
+    }
+
+    void Audio::setListener(const glm::vec2 &position)
+    {
+        if (listener == position)
+            return;
+        listener = position;
+        for (auto &slot : slots)
+            slot.dirty |= slot.active && slot.spatial;
+    }
+
+    void Audio::setBusVolume(Bus bus, float volume)
+    {
+        buses[(size_t)bus] = volume;
+        if (bus == Bus::Music && backend)
+            backend->setMusicVolume(volume * master);
+        markDirty();
+    }
+
+    float Audio::getBusVolume(Bus bus)
+    {
+        return buses[(size_t)bus];
+    }
+
+    void Audio::setMasterVolume(float volume)
+    {
+        master = volume;
+        if (backend)
+            backend->setMusicVolume(buses[(size_t)Bus::Music] * master);
+        markDirty();
+    }
+
+    bool Audio::playMusic(const std::string &file, bool loop)
+    {
+        return backend && backend->playMusic(Content::path() + file, loop);
+    }
+
+    void Audio::stopMusic()
+    {
+        if (backend)
+            backend->stopMusic();
+    }
+
+    int Audio::activeVoices()
+    {
+        return (int)std::count_if(slots.begin(), slots.end(), [](const Slot &slot) { return slot.active; });
+    }
+}
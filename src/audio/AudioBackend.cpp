@@ -0,0 +1,232 @@
+#include "AudioBackend.h"
+#include "Log.h"
+#include <SDL_mixer.h>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+namespace Engine
+{
+    namespace
+    {
+        class MixerBackend : public AudioBackend
+        {
+        public:
+            bool open(int voices) override
+            {
+                if (Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 512) == -1)
+                {
+                    ENGINE_LOG_ERROR(Audio, "Unable to open the audio device: {}", SDL_GetError());
+                    return false;
+                }
+                Mix_AllocateChannels(voices);
+                return true;
+            }
+
+            void close() override
+            {
+                stopMusic();
+                Mix_HaltChannel(-1);
+                Mix_CloseAudio();
+            }
+
+            void *load(const std::string &path) override
+            {
+                // decoded and converted to the device format here, playing is a copy into the mix
+                Mix_Chunk *chunk = Mix_LoadWAV(path.c_str());
+                if (!chunk)
+                    ENGINE_LOG_ERROR(Audio, "Unable to load the sound {}: {}", path, SDL_GetError());
+                return chunk;
+            }
+
+            void free(void *sound) override
+            {
+                Mix_FreeChunk((Mix_Chunk *)sound);
+            }
+
+            void play(int voice, void *sound, bool loop) override
+            {
+                Mix_PlayChannel(voice, (Mix_Chunk *)sound, loop ? -1 : 0);
+            }
+
+            void stop(int voice) override
+            {
+                Mix_HaltChannel(voice);
+            }
+
+            bool playing(int voice) override
+            {
+                return Mix_Playing(voice) != 0;
+            }
+
+            void mix(int voice, float volume, float pan) override
+            {
+                Mix_Volume(voice, (int)(std::clamp(volume, 0.0f, 1.0f) * MIX_MAX_VOLUME));
+                // balance: the centre plays both sides at full volume
+                auto left = (Uint8)(255 * std::clamp(1.0f - pan, 0.0f, 1.0f));
+                auto right = (Uint8)(255 * std::clamp(1.0f + pan, 0.0f, 1.0f));
+                Mix_SetPanning(voice, left, right);
+            }
+
+            bool playMusic(const std::string &path, bool loop) override
+            {
+                stopMusic();
+                // Mix_Music decodes while it plays, on the mixer thread
+                music = Mix_LoadMUS(path.c_str());
+                if (!music)
+                {
+                    ENGINE_LOG_ERROR(Audio, "Unable to load the music {}: {}", path, SDL_GetError());
+                    return false;
+                }
+                return Mix_PlayMusic(music, loop ? -1 : 1) == 0;
+            }
+
+            void stopMusic() override
+            {
+                if (!music)
+                    return;
+                Mix_HaltMusic();
+                Mix_FreeMusic(music);
+                music = nullptr;
+            }
+
+            void setMusicVolume(float volume) override
+            {
+                Mix_VolumeMusic((int)(std::clamp(volume, 0.0f, 1.0f) * MIX_MAX_VOLUME));
+            }
+
+        private:
+            Mix_Music *music = nullptr;
+        };
+
+        class NullBackend : public AudioBackend
+        {
+        public:
+            struct Sound
+            {
+                float duration;
+            };
+
+            bool open(int voices) override
+            {
+                this->voices.assign(voices, Playing{});
+                return true;
+            }
+
+            void close() override
+            {
+                voices.clear();
+            }
+
+            void *load(const std::string &path) override
+            {
+                std::ifstream file{path, std::ios::binary};
+                if (!file)
+                {
+                    ENGINE_LOG_ERROR(Audio, "Unable to load the sound {}", path);
+                    return nullptr;
+                }
+                return new Sound{wavDuration(file)};
+            }
+
+            void free(void *sound) override
+            {
+                delete (Sound *)sound;
+            }
+
+            void play(int voice, void *sound, bool loop) override
+            {
+                voices[voice] = Playing{true, loop, ((Sound *)sound)->duration};
+            }
+
+            void stop(int voice) override
+            {
+                voices[voice].active = false;
+            }
+
+            bool playing(int voice) override
+            {
+                return voices[voice].active;
+            }
+
+            void mix(int, float, float) override
+            {
+            }
+
+            bool playMusic(const std::string &path, bool) override
+            {
+                return std::ifstream(path).good();
+            }
+
+            void stopMusic() override
+            {
+            }
+
+            void setMusicVolume(float) override
+            {
+            }
+
+            void update(float seconds) override
+            {
+                for (auto &voice : voices)
+                {
+                    voice.remaining -= seconds;
+                    if (!voice.loop && voice.remaining <= 0.0f)
+                        voice.active = false;
+                }
+            }
+
+        private:
+            struct Playing
+            {
+                bool active = false;
+                bool loop = false;
+                float remaining = 0.0f;
+            };
+
+            std::vector<Playing> voices;
+
+            // Length of a RIFF WAVE file, 0 for anything else
+            static float wavDuration(std::ifstream &file)
+            {
+                char header[12];
+                if (!file.read(header, sizeof(header)) || memcmp(header, "RIFF", 4) != 0 || memcmp(header + 8, "WAVE", 4) != 0)
+                    return 0.0f;
+
+                uint32_t byteRate = 0;
+                char chunk[8];
+                while (file.read(chunk, sizeof(chunk)))
+                {
+                    uint32_t size;
+                    memcpy(&size, chunk + 4, 4);
+                    if (memcmp(chunk, "fmt ", 4) == 0)
+                    {
+                        char format[16];
+                        if (size < sizeof(format) || !file.read(format, sizeof(format)))
+                            return 0.0f;
+                        memcpy(&byteRate, format + 8, 4);
+                        size -= sizeof(format);
+                    }
+                    else if (memcmp(chunk, "data", 4) == 0)
+                    {
+                        return byteRate > 0 ? (float)size / (float)byteRate : 0.0f;
+                    }
+                    // chunks are padded to an even size
+                    file.seekg(size + (size & 1), std::ios::cur);
+                }
+                return 0.0f;
+            }
+        };
+    }
+
+    std::unique_ptr<AudioBackend> AudioBackend::createMixer()
+    {
+        return std::unique_ptr<AudioBackend>(new MixerBackend());
+    }
+
+    std::unique_ptr<AudioBackend> AudioBackend::createNull()
+    {
+        return std::unique_ptr<AudioBackend>(new NullBackend());
+    }
+}
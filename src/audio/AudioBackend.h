@@ -0,0 +1,48 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+namespace Engine
+{
+    // What Audio needs from the device: voices (channels) that play decoded sounds, and a music stream
+    class AudioBackend
+    {
+    public:
+        virtual ~AudioBackend() = default;
+
+        // Opens the device with `voices` channels, false if it can't be opened
+        virtual bool open(int voices) = 0;
+
+        virtual void close() = 0;
+
+        // Decodes a whole sound, nullptr if the file can't be read
+        virtual void *load(const std::string &path) = 0;
+
+        virtual void free(void *sound) = 0;
+
+        virtual void play(int voice, void *sound, bool loop) = 0;
+
+        virtual void stop(int voice) = 0;
+
+        [[nodiscard]] virtual bool playing(int voice) = 0;
+
+        // `volume` from 0 to 1, `pan` from -1 (left) to 1 (right)
+        virtual void mix(int voice, float volume, float pan) = 0;
+
+        virtual bool playMusic(const std::string &path, bool loop) = 0;
+
+        virtual void stopMusic() = 0;
+
+        virtual void setMusicVolume(float volume) = 0;
+
+        // Time passed since the last update, the null backend ends its voices with it
+        virtual void update(float) {}
+
+        // SDL_mixer
+        static std::unique_ptr<AudioBackend> createMixer();
+
+        // No device, voices last as long as their sound (WAV headers are read for the duration)
+        static std::unique_ptr<AudioBackend> createNull();
+    };
+}
@@ -42,8 +42,9 @@ void CameraComponent::shouldFitToBounds(bool value)
 const glm::mat3x2 &CameraComponent::getMatrix()
 {
     // 2 is the translation column
-    matrix[2].x = -entity->position.x + screenSize.x / 2.0;
-    matrix[2].y = -entity->position.y + screenSize.y / 2.0;
+    auto position = entity->renderPosition();
+    matrix[2].x = -position.x + screenSize.x / 2.0;
+    matrix[2].y = -position.y + screenSize.y / 2.0;
     return matrix;
 }
 
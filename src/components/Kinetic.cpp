@@ -1,5 +1,6 @@
 #include "components/Kinetic.h"
 #include "Ecs.h"
+#include "time/time.h"
 
 bool Kinetic::moveX(int amount) {
     if (amount == 0) return false;
@@ -86,12 +87,15 @@ void Kinetic::render(Engine::Batch &batch) {
 }
 
 void Kinetic::update() {
+    // speed and gravity are expressed per 1/60th of a second
+    float steps = Engine::Time::delta * 60.0f;
+
     // apply friction
     if (!onGround()) {
-        speed.y += gravity;
+        speed.y += gravity * steps;
     }
 
-    auto total = remainder + speed;
+    auto total = remainder + speed * steps;
     auto move = glm::ivec2((int) total.x, (int) total.y);
 
     remainder.x = total.x - (int) move.x;
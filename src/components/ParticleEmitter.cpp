@@ -0,0 +1,189 @@
+#include "ParticleEmitter.h"
+#include "Ecs.h"
+#include "Batch.h"
+#include "Content.h"
+#include "Sprite.h"
+#include "time/time.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define ENGINE_PARTICLES_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define ENGINE_PARTICLES_NEON
+#endif
+
+namespace {
+    // rand() keeps effects the same between runs started with the same --seed
+    inline float randomRange(float min, float max) {
+        return min + (max - min) * ((float) std::rand() / (float) RAND_MAX);
+    }
+
+    inline uint8_t mix(uint8_t from, uint8_t to, float t) {
+        return (uint8_t) ((float) from + ((float) to - (float) from) * t);
+    }
+
+    // Fixed step used by warmUp
+    constexpr float WARM_UP_STEP = 1.0f / 60.0f;
+}
+
+Engine::ParticleEmitter::ParticleEmitter(const std::string &sprite, size_t capacity)
+        : spriteName{sprite}, capacity{capacity},
+          x(capacity), y(capacity), previousX(capacity), previousY(capacity), velocityX(capacity), velocityY(capacity), age(capacity), ageRate(capacity) {
+    instances.reserve(capacity);
+}
+
+Engine::ParticleEmitter::~ParticleEmitter() = default;
+
+void Engine::ParticleEmitter::burst(int count) {
+    auto origin = glm::vec2(entity->position) + offset;
+    auto emitted = std::min((size_t) std::max(count, 0), capacity - alive);
+    for (size_t i = alive; i < alive + emitted; i++) {
+        float direction = angle + randomRange(-spread, spread);
+        float speed = randomRange(minSpeed, maxSpeed);
+        x[i] = origin.x + randomRange(-0.5f, 0.5f) * area.x;
+        y[i] = origin.y + randomRange(-0.5f, 0.5f) * area.y;
+        previousX[i] = x[i];
+        previousY[i] = y[i];
+        velocityX[i] = std::cos(direction) * speed;
+        velocityY[i] = std::sin(direction) * speed;
+        age[i] = 0.0f;
+        ageRate[i] = 1.0f / std::max(randomRange(minLife, maxLife), 0.001f);
+    }
+    alive += emitted;
+}
+
+void Engine::ParticleEmitter::warmUp(float seconds) {
+    for (float elapsed = 0.0f; elapsed < seconds; elapsed += WARM_UP_STEP)
+        simulate(WARM_UP_STEP);
+}
+
+void Engine::ParticleEmitter::reset() {
+    alive = 0;
+    pending = 0.0f;
+}
+
+bool Engine::ParticleEmitter::awake() {
+    // without a texture the particles are still simulated, just not drawn
+    auto *sprite = Content::findSprite(spriteName);
+    if (!sprite)
+        return Component::awake();
+    if (sprite->getAnimations().empty() || sprite->getAnimation()->frames.empty()) {
+        ENGINE_LOG_ERROR(Ecs, "Sprite {} has no frame to draw particles with", spriteName);
+        return Component::awake();
+    }
+    texture = &sprite->getAnimation()->frames[0].texture;
+    return Component::awake();
+}
+
+bool Engine::ParticleEmitter::isFinished() const {
+    return alive == 0 && (!emitting || rate <= 0.0f);
+}
+
+void Engine::ParticleEmitter::update() {
+    simulate(Time::delta);
+}
+
+void Engine::ParticleEmitter::simulate(float delta) {
+    const float damping = std::max(0.0f, 1.0f - drag * delta);
+    const float gravityX = gravity.x * delta;
+    const float gravityY = gravity.y * delta;
+
+    float *px = x.data(), *py = y.data();
+    float *prevX = previousX.data(), *prevY = previousY.data();
+    float *vx = velocityX.data(), *vy = velocityY.data();
+    float *pAge = age.data();
+    const float *pRate = ageRate.data();
+
+    size_t i = 0;
+#if defined(ENGINE_PARTICLES_SSE2)
+    const __m128 dt = _mm_set1_ps(delta);
+    const __m128 damp = _mm_set1_ps(damping);
+    const __m128 gx = _mm_set1_ps(gravityX), gy = _mm_set1_ps(gravityY);
+    for (; i + 4 <= alive; i += 4) {
+        __m128 velX = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(vx + i), gx), damp);
+        __m128 velY = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(vy + i), gy), damp);
+        _mm_storeu_ps(vx + i, velX);
+        _mm_storeu_ps(vy + i, velY);
+        __m128 posX = _mm_loadu_ps(px + i), posY = _mm_loadu_ps(py + i);
+        _mm_storeu_ps(prevX + i, posX);
+        _mm_storeu_ps(prevY + i, posY);
+        _mm_storeu_ps(px + i, _mm_add_ps(posX, _mm_mul_ps(velX, dt)));
+        _mm_storeu_ps(py + i, _mm_add_ps(posY, _mm_mul_ps(velY, dt)));
+        _mm_storeu_ps(pAge + i, _mm_add_ps(_mm_loadu_ps(pAge + i), _mm_mul_ps(_mm_loadu_ps(pRate + i), dt)));
+    }
+#elif defined(ENGINE_PARTICLES_NEON)
+    const float32x4_t gx = vdupq_n_f32(gravityX), gy = vdupq_n_f32(gravityY);
+    for (; i + 4 <= alive; i += 4) {
+        float32x4_t velX = vmulq_n_f32(vaddq_f32(vld1q_f32(vx + i), gx), damping);
+        float32x4_t velY = vmulq_n_f32(vaddq_f32(vld1q_f32(vy + i), gy), damping);
+        vst1q_f32(vx + i, velX);
+        vst1q_f32(vy + i, velY);
+        float32x4_t posX = vld1q_f32(px + i), posY = vld1q_f32(py + i);
+        vst1q_f32(prevX + i, posX);
+        vst1q_f32(prevY + i, posY);
+        vst1q_f32(px + i, vmlaq_n_f32(posX, velX, delta));
+        vst1q_f32(py + i, vmlaq_n_f32(posY, velY, delta));
+        vst1q_f32(pAge + i, vmlaq_n_f32(vld1q_f32(pAge + i), vld1q_f32(pRate + i), delta));
+    }
+#endif
+    for (; i < alive; i++) {
+        vx[i] = (vx[i] + gravityX) * damping;
+        vy[i] = (vy[i] + gravityY) * damping;
+        prevX[i] = px[i];
+        prevY[i] = py[i];
+        px[i] += vx[i] * delta;
+        py[i] += vy[i] * delta;
+        pAge[i] += pRate[i] * delta;
+    }
+
+    // dead particles are replaced by the last one, the arrays stay packed
+    for (i = 0; i < alive;) {
+        if (pAge[i] < 1.0f) {
+            i++;
+            continue;
+        }
+        alive--;
+        px[i] = px[alive];
+        py[i] = py[alive];
+        prevX[i] = prevX[alive];
+        prevY[i] = prevY[alive];
+        vx[i] = vx[alive];
+        vy[i] = vy[alive];
+        pAge[i] = pAge[alive];
+        ageRate[i] = ageRate[alive];
+    }
+
+    if (emitting && rate > 0.0f) {
+        pending += rate * delta;
+        int count = (int) pending;
+        pending -= (float) count;
+        burst(count);
+    }
+}
+
+void Engine::ParticleEmitter::render(Engine::Batch &batch) {
+    if (alive == 0 || !texture)
+        return;
+    auto size = glm::vec2{texture->width(), texture->height()};
+    const float alpha = Time::alpha;
+
+    instances.resize(alive);
+    for (size_t i = 0; i < alive; i++) {
+        float t = age[i];
+        float scale = startScale + (endScale - startScale) * t;
+        auto &instance = instances[i];
+        instance.sprite = texture;
+        // centered on the particle
+        auto position = glm::vec2{previousX[i] + (x[i] - previousX[i]) * alpha,
+                                  previousY[i] + (y[i] - previousY[i]) * alpha};
+        instance.position = position - size * (scale * 0.5f);
+        instance.scale = glm::vec2{scale, scale};
+        instance.color = Color(mix(startColor.r, endColor.r, t), mix(startColor.g, endColor.g, t),
+                               mix(startColor.b, endColor.b, t), mix(startColor.a, endColor.a, t));
+    }
+    batch.texBatch(instances.data(), alive);
+}
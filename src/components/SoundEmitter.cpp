@@ -0,0 +1,27 @@
+#include "SoundEmitter.h"
+#include "Ecs.h"
+
+Engine::SoundEmitter::SoundEmitter(SoundId sound, float volume, bool loop) : sound{sound}, volume{volume}, loop{loop} {}
+
+Engine::SoundEmitter::~SoundEmitter() {
+    Audio::stop(voice);
+}
+
+void Engine::SoundEmitter::play() {
+    Audio::stop(voice);
+    voice = Audio::playAt(sound, entity->position, volume, loop);
+}
+
+void Engine::SoundEmitter::stop() {
+    Audio::stop(voice);
+    voice = Voice{};
+}
+
+bool Engine::SoundEmitter::isPlaying() const {
+    return Audio::isPlaying(voice);
+}
+
+void Engine::SoundEmitter::update() {
+    if (voice.valid())
+        Audio::setPosition(voice, entity->position);
+}
@@ -2,69 +2,147 @@
 #include <math/Utils.h>
 #include "SpriteComponent.h"
 #include "Ecs.h"
+#include "Entity.hpp"
 #include "Sprite.h"
 #include "Content.h"
 #include "Batch.h"
+#include "Transform.h"
+#include "Animators.h"
 
 Engine::SpriteComponent::SpriteComponent(const std::string &spriteName) : spriteName{spriteName}
 {
 }
 
+Engine::SpriteComponent::~SpriteComponent()
+{
+    if (destroyed)
+        *destroyed = true;
+    if (animators)
+        animators->destroy(handle);
+}
+
 bool Engine::SpriteComponent::awake()
 {
+    sprite = Content::findSprite(spriteName);
+    ENGINE_ASSERT(sprite, "SpriteComponent needs a sprite that exists");
+    animators = &entity->getWorld().getAnimators();
+    handle = animators->create(this);
+    // play() may have been called before the component was added, its name is only checked now
+    animation = sprite->getAnimation(animationName);
+    if (!animation)
+    {
+        ENGINE_LOG_WARN(Ecs, "Sprite {} has no animation {}, playing its first one", spriteName, animationName);
+        animation = sprite->getAnimation();
+        animationName = animation->name;
+    }
+    animators->setAnimation(handle, animation);
+    animators->setHasEvents(handle, !events.empty());
     return Component::awake();
 }
 
 void Engine::SpriteComponent::play(const std::string &animationName)
 {
-    if (this->animationName != animationName)
+    if (this->animationName == animationName)
+        return;
+    if (!animators)
     {
-        frameIndex = 0;
-        frameCounter = 0.0f;
+        // checked by awake()
         this->animationName = animationName;
+        return;
     }
+    const Animation *found = sprite->getAnimation(animationName);
+    if (!found)
+    {
+        ENGINE_LOG_WARN(Ecs, "Sprite {} has no animation {}", spriteName, animationName);
+        return;
+    }
+    this->animationName = animationName;
+    animation = found;
+    animators->setAnimation(handle, animation);
 }
-void Engine::SpriteComponent::setColor(Engine::Color color) {
-    this->color = color;
+
+void Engine::SpriteComponent::setSpeed(float speed)
+{
+    animators->setSpeed(handle, speed);
 }
 
-void Engine::SpriteComponent::render(Engine::Batch &batch) {
-    auto &texture = getAnimation()->frames[frameIndex].texture;
-    batch.pushMatrix(Engine::Math::transform(entity->position, getSprite()->pivot, scale, rotation));
-    batch.tex(texture, glm::vec2(0), color);
-    batch.popMatrix();
+float Engine::SpriteComponent::getSpeed() const
+{
+    return animators->getSpeed(handle);
+}
+
+void Engine::SpriteComponent::seek(float millis)
+{
+    animators->seek(handle, millis);
+}
+
+int Engine::SpriteComponent::getFrame() const
+{
+    return animators->getFrame(handle);
 }
 
-void Engine::SpriteComponent::update()
+void Engine::SpriteComponent::onFrame(const std::string &animation, int frame, std::function<void()> callback)
 {
-    frameCounter += FRAME_DURATION;
-    if (frameCounter > getAnimation()->frames[frameIndex].durationMillis)
+    events.push_back(FrameEvent{animation, frame, std::move(callback)});
+    if (animators)
+        animators->setHasEvents(handle, true);
+}
+
+void Engine::SpriteComponent::fireFrameEvents(uint32_t from, uint32_t to)
+{
+    // every timeline entry entered after `from`, up to and including `to` (wrapping around the loop).
+    // The callbacks are copied first: they may add events (growing `events`) or destroy this component
+    std::vector<std::function<void()>> callbacks;
+    auto &timeline = animation->timeline;
+    for (uint32_t at = from; at != to;)
+    {
+        at = (at + 1) % (uint32_t)timeline.size();
+        int frame = timeline[at];
+        for (auto &event : events)
+        {
+            if (event.frame == frame && event.animation == animation->name)
+                callbacks.push_back(event.callback);
+        }
+    }
+
+    bool wasDestroyed = false;
+    destroyed = &wasDestroyed;
+    for (auto &callback : callbacks)
     {
-        frameIndex++;
-        frameCounter = 0.0f;
-        if (frameIndex >= getAnimation()->frames.size())
-            frameIndex = 0;
+        callback();
+        if (wasDestroyed)
+            return;
     }
+    destroyed = nullptr;
+}
+
+void Engine::SpriteComponent::setColor(Engine::Color color) {
+    this->color = color;
+}
+
+void Engine::SpriteComponent::render(Engine::Batch &batch) {
+    auto &texture = animation->frames[animators->getFrame(handle)].texture;
+    auto &pivot = sprite->pivot;
+    if (auto *transform = entity->get<Transform>()) {
+        // the entity's Transform already places it, the sprite only adds its pivot (and its own scale / rotation)
+        if (scale == glm::vec2{1.0f, 1.0f} && rotation == 0.0f)
+            batch.tex(texture, -glm::vec2(pivot), color, transform->getMatrix());
+        else
+            batch.tex(texture, glm::vec2(0), color,
+                      transform->getMatrix() * glm::mat3x3(Engine::Math::transform({}, pivot, scale, rotation)));
+        return;
+    }
+    batch.tex(texture, glm::vec2(0), color, Engine::Math::transform(entity->renderPosition(), pivot, scale, rotation));
 }
 
 int Engine::SpriteComponent::getCurrentAnimDuration()
 {
-    return getAnimation()->duration;
+    return animation->duration;
 }
 
 // todo: getCurrentAnimSize doesn't work becaue the packer packs alpha values
 glm::ivec2 Engine::SpriteComponent::getCurrentAnimSize()
 {
-    auto texture = getAnimation()->frames[frameIndex].texture;
+    auto &texture = animation->frames[animators->getFrame(handle)].texture;
     return glm::ivec2{texture.width(), texture.height()};
 }
-
-Engine::Sprite *Engine::SpriteComponent::getSprite()
-{
-    return Content::findSprite(spriteName);
-}
-
-Engine::Animation *Engine::SpriteComponent::getAnimation()
-{
-    return getSprite()->getAnimation(animationName);
-}
\ No newline at end of file
@@ -16,7 +16,8 @@ void TileMapComponent::setCell(unsigned int x, unsigned int y, const Engine::Sub
 
 void TileMapComponent::render(Engine::Batch &batch)
 {
-    batch.pushMatrix(glm::mat3x2{1.0f, 0.0f, 0.0f, 1.0f, entity->position.x, entity->position.y});
+    auto position = entity->renderPosition();
+    batch.pushMatrix(glm::mat3x2{1.0f, 0.0f, 0.0f, 1.0f, position.x, position.y});
     for (int i = 0; i < columns; i++)
     {
         for (int j = 0; j < rows; j++)
@@ -37,7 +38,7 @@ bool TileMapComponent::awake()
     if (!mapInfo)
         return false;
     tmx::Map map;
-    ENGINE_INFO("Loading map: {}", mapInfo->fileName);
+    ENGINE_LOG_INFO(Content, "Loading map: {}", mapInfo->fileName);
     map.load(mapInfo->fileName);
 
     entity->position.x = mapInfo->rect.left();
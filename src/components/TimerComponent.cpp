@@ -1,9 +1,10 @@
 #include "TimerComponent.h"
 #include "Ecs.h"
+#include "time/time.h"
 
 void Engine::TimerComponent::update() {
     if (internalTimer > 0) {
-        internalTimer -= 1000.0f / 60;
+        internalTimer -= Time::delta * 1000.0f;
         if (internalTimer <= 0) {
             if (timerAction) { 
                 // when timerAction retuns false, it means this component was deleted
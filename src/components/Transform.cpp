@@ -0,0 +1,65 @@
+#include "Transform.h"
+#include "Transforms.h"
+#include "Ecs.h"
+
+Engine::Transform::Transform(const glm::vec2 &position, float rotation, const glm::vec2 &scale)
+        : initialPosition{position}, initialRotation{rotation}, initialScale{scale} {}
+
+Engine::Transform::~Transform() {
+    if (transforms)
+        transforms->destroy(handle);
+}
+
+bool Engine::Transform::awake() {
+    transforms = &entity->getWorld().getTransforms();
+    handle = transforms->create(this, entity);
+    transforms->setPosition(handle, initialPosition);
+    transforms->setRotation(handle, initialRotation);
+    transforms->setScale(handle, initialScale);
+    return Component::awake();
+}
+
+void Engine::Transform::setParent(Transform *parent) {
+    ENGINE_ASSERT(!parent || parent->transforms == transforms, "A Transform's parent must be in the same World");
+    transforms->setParent(handle, parent ? parent->handle : Transforms::NONE);
+}
+
+Engine::Transform *Engine::Transform::getParent() const {
+    return transforms->getParent(handle);
+}
+
+void Engine::Transform::setPosition(const glm::vec2 &position) {
+    transforms->setPosition(handle, position);
+}
+
+glm::vec2 Engine::Transform::getPosition() const {
+    return transforms->getPosition(handle);
+}
+
+void Engine::Transform::setRotation(float radians) {
+    transforms->setRotation(handle, radians);
+}
+
+float Engine::Transform::getRotation() const {
+    return transforms->getRotation(handle);
+}
+
+void Engine::Transform::setScale(const glm::vec2 &scale) {
+    transforms->setScale(handle, scale);
+}
+
+glm::vec2 Engine::Transform::getScale() const {
+    return transforms->getScale(handle);
+}
+
+void Engine::Transform::setOrigin(const glm::vec2 &origin) {
+    transforms->setOrigin(handle, origin);
+}
+
+glm::vec2 Engine::Transform::getOrigin() const {
+    return transforms->getOrigin(handle);
+}
+
+glm::mat3x2 Engine::Transform::getMatrix() const {
+    return transforms->matrix(handle);
+}
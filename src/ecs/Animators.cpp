@@ -0,0 +1,169 @@
+#include "Animators.h"
+#include "SpriteComponent.h"
+#include "Sprite.h"
+#include "Log.h"
+#include "Profiler.h"
+#include <cmath>
+
+namespace Engine
+{
+    uint32_t Animators::create(SpriteComponent *owner)
+    {
+        uint32_t handle;
+        if (freeHandles.empty())
+        {
+            handle = (uint32_t)indices.size();
+            indices.push_back(NONE);
+            generations.push_back(0);
+        }
+        else
+        {
+            handle = freeHandles.back();
+            freeHandles.pop_back();
+        }
+        indices[handle] = (uint32_t)this->owner.size();
+
+        this->handle.push_back(handle);
+        this->owner.push_back(owner);
+        animation.push_back(nullptr);
+        time.push_back(0.0f);
+        speed.push_back(1.0f);
+        position.push_back(0);
+        frame.push_back(0);
+        hasEvents.push_back(0);
+        return handle;
+    }
+
+    void Animators::destroy(uint32_t handle)
+    {
+        // the last animator takes the destroyed one's place
+        uint32_t index = indices[handle];
+        uint32_t last = (uint32_t)owner.size() - 1;
+        if (index != last)
+        {
+            this->handle[index] = this->handle[last];
+            owner[index] = owner[last];
+            animation[index] = animation[last];
+            time[index] = time[last];
+            speed[index] = speed[last];
+            position[index] = position[last];
+            frame[index] = frame[last];
+            hasEvents[index] = hasEvents[last];
+            indices[this->handle[index]] = index;
+        }
+        this->handle.pop_back();
+        owner.pop_back();
+        animation.pop_back();
+        time.pop_back();
+        speed.pop_back();
+        position.pop_back();
+        frame.pop_back();
+        hasEvents.pop_back();
+
+        indices[handle] = NONE;
+        generations[handle]++;
+        freeHandles.push_back(handle);
+    }
+
+    void Animators::setAnimation(uint32_t handle, const Animation *animation)
+    {
+        uint32_t index = indices[handle];
+        this->animation[index] = animation;
+        seek(handle, 0.0f);
+    }
+
+    const Animation *Animators::getAnimation(uint32_t handle) const
+    {
+        return animation[indices[handle]];
+    }
+
+    void Animators::seek(uint32_t handle, float millis)
+    {
+        uint32_t index = indices[handle];
+        const Animation *current = animation[index];
+        if (!current || current->duration <= 0)
+        {
+            time[index] = 0.0f;
+            position[index] = 0;
+            frame[index] = 0;
+            return;
+        }
+        millis = std::fmod(millis, (float)current->duration);
+        if (millis < 0.0f)
+            millis += (float)current->duration;
+        time[index] = millis;
+        position[index] = (uint32_t)current->seek(millis);
+        frame[index] = current->timeline[position[index]];
+    }
+
+    float Animators::getTime(uint32_t handle) const
+    {
+        return time[indices[handle]];
+    }
+
+    void Animators::setSpeed(uint32_t handle, float speed)
+    {
+        ENGINE_ASSERT(speed >= 0.0f, "Animations can't play backwards, use a Reverse animation");
+        this->speed[indices[handle]] = speed;
+    }
+
+    float Animators::getSpeed(uint32_t handle) const
+    {
+        return speed[indices[handle]];
+    }
+
+    int Animators::getFrame(uint32_t handle) const
+    {
+        return frame[indices[handle]];
+    }
+
+    void Animators::setHasEvents(uint32_t handle, bool hasEvents)
+    {
+        this->hasEvents[indices[handle]] = hasEvents ? 1 : 0;
+    }
+
+    void Animators::update(float delta)
+    {
+        ENGINE_PROFILE_SCOPE("Animators::update");
+        const float millis = delta * 1000.0f;
+
+        fired.clear();
+        size_t count = owner.size();
+        for (size_t i = 0; i < count; i++)
+        {
+            const Animation *current = animation[i];
+            if (!current || current->duration <= 0)
+                continue;
+
+            float t = time[i] + millis * speed[i];
+            if (t >= (float)current->duration)
+                t = std::fmod(t, (float)current->duration);
+            time[i] = t;
+
+            // most steps stay on the same entry, the search only runs when it ended
+            uint32_t at = position[i];
+            const auto &ends = current->timelineEnds;
+            if (t < (float)ends[at] && (at == 0 || t >= (float)ends[at - 1]))
+                continue;
+
+            uint32_t next = (uint32_t)current->seek(t);
+            if (next == at)
+                continue;
+            if (hasEvents[i])
+                fired.push_back(Fired{handle[i], generations[handle[i]], current, at, next});
+            position[i] = next;
+            frame[i] = current->timeline[next];
+        }
+
+        // events run after the pass, they may add or destroy sprites, or play another animation: those sprites'
+        // collected events are skipped
+        for (auto &event : fired)
+        {
+            if (generations[event.handle] != event.generation)
+                continue;
+            uint32_t index = indices[event.handle];
+            if (animation[index] == event.animation)
+                owner[index]->fireFrameEvents(event.from, event.to);
+        }
+    }
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace Engine
+{
+    struct Animation;
+    class SpriteComponent;
+
+    // The playback state of every SpriteComponent in a World, one array per field (indexed the same way).
+    // update() advances all of them in one pass: the time goes forward by the step's delta (scaled by the animator's
+    // speed), wraps around the animation's loop and the frame is found with a binary search in the animation's
+    // timeline. Animators with frame events are collected during the pass and their events fired after it.
+    // SpriteComponents hold a handle, which stays the same when the arrays are compacted.
+    class Animators
+    {
+    public:
+        static constexpr uint32_t NONE = UINT32_MAX;
+
+        uint32_t create(SpriteComponent *owner);
+        void destroy(uint32_t handle);
+
+        // Plays `animation` from its start
+        void setAnimation(uint32_t handle, const Animation *animation);
+        [[nodiscard]] const Animation *getAnimation(uint32_t handle) const;
+
+        // Millis into the loop, wrapped, the frame is updated right away
+        void seek(uint32_t handle, float millis);
+        [[nodiscard]] float getTime(uint32_t handle) const;
+
+        // 1 is the speed the animation was made at, 0 pauses it (negative speeds aren't supported)
+        void setSpeed(uint32_t handle, float speed);
+        [[nodiscard]] float getSpeed(uint32_t handle) const;
+
+        // Index in the animation's frames
+        [[nodiscard]] int getFrame(uint32_t handle) const;
+
+        // Only animators with events are collected (and their owners called) when their frame changes
+        void setHasEvents(uint32_t handle, bool hasEvents);
+
+        void update(float delta);
+
+        [[nodiscard]] size_t size() const { return owner.size(); }
+
+    private:
+        // handle -> index in the arrays
+        std::vector<uint32_t> indices;
+        // handle -> times it was destroyed, a reused handle doesn't match what was collected for its previous owner
+        std::vector<uint32_t> generations;
+        std::vector<uint32_t> freeHandles;
+
+        std::vector<uint32_t> handle;
+        std::vector<SpriteComponent *> owner;
+        std::vector<const Animation *> animation;
+        // millis into the loop
+        std::vector<float> time;
+        std::vector<float> speed;
+        // entry of the animation's timeline being played, and the frame it shows
+        std::vector<uint32_t> position;
+        std::vector<int> frame;
+        std::vector<uint8_t> hasEvents;
+
+        struct Fired
+        {
+            uint32_t handle;
+            uint32_t generation;
+            // from and to are entries of this animation's timeline
+            const Animation *animation;
+            uint32_t from;
+            uint32_t to;
+        };
+        // reused by every update
+        std::vector<Fired> fired;
+    };
+}
@@ -4,7 +4,11 @@
 
 #include "Ecs.h"
 #include "Batch.h"
-#include "iostream"
+#include "Profiler.h"
+#include "Transforms.h"
+#include "Animators.h"
+#include "time/time.h"
+#include <typeinfo>
 
 // WORLD
 Engine::Entity *Engine::World::addEntity(glm::vec2 position)
@@ -15,15 +19,12 @@ Engine::Entity *Engine::World::addEntity(glm::vec2 position)
 
 void Engine::World::destroyEntity(Engine::Entity *entity)
 {
-    ENGINE_ASSERT(entity->world == this, "Entity does not belong to this world")
+    ENGINE_ASSERT(entity->world == this, "Entity does not belong to this world");
     auto &components = entity->getComponents();
-    std::cout << "deleting entity @" << entity << "component count: " << components.size() << std::endl;
-     
+    ENGINE_LOG_TRACE(Ecs, "Destroying entity @{} ({} components)", (void *)entity, components.size());
+
     for (int32_t i = components.size() - 1; i >= 0; i--)
-    {
-        std::cout << i << std::endl;
         destroyComponent(components[i]);
-    }
 
     entities.erase(std::remove(entities.begin(), entities.end(), entity), entities.end());
     delete entity;
@@ -31,8 +32,24 @@ void Engine::World::destroyEntity(Engine::Entity *entity)
 
 void Engine::World::update()
 {
+    ENGINE_PROFILE_SCOPE("World::update");
+
+    // snapshot the state this step starts from so rendering can interpolate towards the new one
+    for (auto *entity : entities)
+    {
+        entity->previousPosition = entity->position;
+        entity->tracked = true;
+    }
+
+    animators->update(Time::delta);
+
     for (size_t typeIndex = 0; typeIndex < Component::Types::count(); typeIndex++)
     {
+        if (components[typeIndex].empty())
+            continue;
+
+        // typeid names are static strings, one zone per component type
+        ENGINE_PROFILE_SCOPE(typeid(*components[typeIndex].back()).name());
         for (int i = components[typeIndex].size() - 1; i >= 0; i--)
         {
             auto *component = components[typeIndex][i];
@@ -42,20 +59,20 @@ void Engine::World::update()
     }
 }
 
-Engine::World::World()
+Engine::World::World() : transforms{std::make_unique<Transforms>()}, animators{std::make_unique<Animators>()}
 {
-    ENGINE_CORE_INFO("World()");
+    ENGINE_LOG_INFO(Ecs, "World()");
 }
 
 Engine::World::~World()
 {
     clear();
-    ENGINE_CORE_INFO("~World()");
+    ENGINE_LOG_INFO(Ecs, "~World()");
 }
 
 void Engine::World::clear()
 {
-    ENGINE_CORE_INFO("Clearing world, entities: {}", entities.size());
+    ENGINE_LOG_INFO(Ecs, "Clearing world, entities: {}", entities.size());
     for (int i = entities.size() - 1; i >= 0; i--)
         destroyEntity(entities[i]);
 }
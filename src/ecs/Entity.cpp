@@ -1,5 +1,6 @@
 #include "Entity.h"
 #include "Entity.hpp"
+#include "time/time.h"
 
 void Engine::Entity::destroy() {
     // todo: maybe this should be "marked for destroy"
@@ -30,4 +31,18 @@ void Engine::Entity::remove(Engine::Component *component)
     }
     // Remove it from the world (we keep it both places for easier iteration)
     world->destroyComponent(component);
-}
\ No newline at end of file
+}
+
+glm::vec2 Engine::Entity::renderPosition() const
+{
+    // entities created during the last step have no previous state yet
+    if (!tracked)
+        return position;
+    return glm::mix(glm::vec2(previousPosition), glm::vec2(position), Time::alpha);
+}
+
+void Engine::Entity::teleport(glm::ivec2 target)
+{
+    position = target;
+    previousPosition = target;
+}
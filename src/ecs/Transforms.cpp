@@ -0,0 +1,321 @@
+#include "Transforms.h"
+#include "Entity.h"
+#include "Log.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace Engine
+{
+    namespace
+    {
+        template <class T>
+        void permute(std::vector<T> &values, const std::vector<uint32_t> &order)
+        {
+            std::vector<T> sorted;
+            sorted.reserve(order.size());
+            for (auto index : order)
+                sorted.push_back(values[index]);
+            values = std::move(sorted);
+        }
+    }
+
+    uint32_t Transforms::create(Transform *owner, Entity *entity)
+    {
+        uint32_t handle;
+        if (freeHandles.empty())
+        {
+            handle = (uint32_t)indices.size();
+            indices.push_back(NONE);
+        }
+        else
+        {
+            handle = freeHandles.back();
+            freeHandles.pop_back();
+        }
+        indices[handle] = (uint32_t)this->owner.size();
+
+        this->handle.push_back(handle);
+        this->owner.push_back(owner);
+        this->entity.push_back(entity);
+        parent.push_back(NONE);
+        x.push_back(0.0f);
+        y.push_back(0.0f);
+        rotation.push_back(0.0f);
+        cos.push_back(1.0f);
+        sin.push_back(0.0f);
+        scaleX.push_back(1.0f);
+        scaleY.push_back(1.0f);
+        originX.push_back(0.0f);
+        originY.push_back(0.0f);
+        dirty.push_back(1);
+        offsetX.push_back(0.0f);
+        offsetY.push_back(0.0f);
+        for (auto *values : {&worldA, &worldB, &worldC, &worldD, &worldTx, &worldTy})
+            values->push_back(0.0f);
+        version.push_back(0);
+        parentVersion.push_back(0);
+
+        // roots have to stay in front of every child
+        reorder = true;
+        return handle;
+    }
+
+    void Transforms::destroy(uint32_t handle)
+    {
+        uint32_t index = indices[handle];
+        // children become roots, placed at their own entity's position
+        for (size_t i = 0; i < owner.size(); i++)
+        {
+            if (parent[i] == index)
+            {
+                parent[i] = NONE;
+                dirty[i] = 1;
+            }
+        }
+        // the entry is dropped when the arrays are next sorted
+        owner[index] = nullptr;
+        entity[index] = nullptr;
+        indices[handle] = NONE;
+        freeHandles.push_back(handle);
+        reorder = true;
+    }
+
+    bool Transforms::setParent(uint32_t handle, uint32_t parentHandle)
+    {
+        uint32_t index = indices[handle];
+        uint32_t parentIndex = parentHandle == NONE ? NONE : indices[parentHandle];
+        for (uint32_t ancestor = parentIndex; ancestor != NONE; ancestor = parent[ancestor])
+        {
+            if (ancestor == index)
+            {
+                ENGINE_LOG_ERROR(Ecs, "A Transform can't be parented to itself or one of its children");
+                return false;
+            }
+        }
+        if (parent[index] == parentIndex)
+            return true;
+        parent[index] = parentIndex;
+        dirty[index] = 1;
+        reorder = true;
+        return true;
+    }
+
+    Transform *Transforms::getParent(uint32_t handle) const
+    {
+        uint32_t index = parent[indices[handle]];
+        return index == NONE ? nullptr : owner[index];
+    }
+
+    void Transforms::setPosition(uint32_t handle, const glm::vec2 &position)
+    {
+        uint32_t index = indices[handle];
+        x[index] = position.x;
+        y[index] = position.y;
+        dirty[index] = 1;
+    }
+
+    void Transforms::setRotation(uint32_t handle, float radians)
+    {
+        uint32_t index = indices[handle];
+        rotation[index] = radians;
+        // kept so the update pass has no trigonometry to do
+        cos[index] = std::cos(radians);
+        sin[index] = std::sin(radians);
+        dirty[index] = 1;
+    }
+
+    void Transforms::setScale(uint32_t handle, const glm::vec2 &scale)
+    {
+        uint32_t index = indices[handle];
+        scaleX[index] = scale.x;
+        scaleY[index] = scale.y;
+        dirty[index] = 1;
+    }
+
+    void Transforms::setOrigin(uint32_t handle, const glm::vec2 &origin)
+    {
+        uint32_t index = indices[handle];
+        originX[index] = origin.x;
+        originY[index] = origin.y;
+        dirty[index] = 1;
+    }
+
+    glm::vec2 Transforms::getPosition(uint32_t handle) const
+    {
+        uint32_t index = indices[handle];
+        return {x[index], y[index]};
+    }
+
+    float Transforms::getRotation(uint32_t handle) const
+    {
+        return rotation[indices[handle]];
+    }
+
+    glm::vec2 Transforms::getScale(uint32_t handle) const
+    {
+        uint32_t index = indices[handle];
+        return {scaleX[index], scaleY[index]};
+    }
+
+    glm::vec2 Transforms::getOrigin(uint32_t handle) const
+    {
+        uint32_t index = indices[handle];
+        return {originX[index], originY[index]};
+    }
+
+    glm::mat3x2 Transforms::matrix(uint32_t handle)
+    {
+        if (reorder)
+            sort();
+        uint32_t index = indices[handle];
+
+        // parents first, a child is only up to date once they are
+        chain.clear();
+        for (uint32_t at = index; at != NONE; at = parent[at])
+            chain.push_back(at);
+        for (auto at = chain.rbegin(); at != chain.rend(); at++)
+        {
+            if (isDirty(*at))
+                recompute(*at);
+        }
+        return glm::mat3x2{worldA[index], worldB[index], worldC[index], worldD[index], worldTx[index], worldTy[index]};
+    }
+
+    void Transforms::update()
+    {
+        ENGINE_PROFILE_SCOPE("Transforms::update");
+        if (reorder)
+            sort();
+
+        // parents come before their children, a recomputed parent makes its children dirty before they're checked
+        size_t count = owner.size();
+        for (uint32_t i = 0; i < count; i++)
+        {
+            if (isDirty(i))
+                recompute(i);
+        }
+    }
+
+    bool Transforms::isDirty(uint32_t index) const
+    {
+        if (dirty[index])
+            return true;
+        uint32_t p = parent[index];
+        if (p != NONE)
+            return parentVersion[index] != version[p];
+        glm::vec2 offset = entity[index]->renderPosition();
+        return offset.x != offsetX[index] || offset.y != offsetY[index];
+    }
+
+    void Transforms::recompute(uint32_t index)
+    {
+        // position * rotation * scale * -origin, written out
+        float a = cos[index] * scaleX[index];
+        float b = sin[index] * scaleX[index];
+        float c = -sin[index] * scaleY[index];
+        float d = cos[index] * scaleY[index];
+        float tx = x[index] - (a * originX[index] + c * originY[index]);
+        float ty = y[index] - (b * originX[index] + d * originY[index]);
+
+        uint32_t p = parent[index];
+        if (p == NONE)
+        {
+            // roots are placed at their entity's position
+            glm::vec2 offset = entity[index]->renderPosition();
+            offsetX[index] = offset.x;
+            offsetY[index] = offset.y;
+            worldA[index] = a;
+            worldB[index] = b;
+            worldC[index] = c;
+            worldD[index] = d;
+            worldTx[index] = tx + offset.x;
+            worldTy[index] = ty + offset.y;
+        }
+        else
+        {
+            float pa = worldA[p], pb = worldB[p], pc = worldC[p], pd = worldD[p];
+            worldA[index] = pa * a + pc * b;
+            worldB[index] = pb * a + pd * b;
+            worldC[index] = pa * c + pc * d;
+            worldD[index] = pb * c + pd * d;
+            worldTx[index] = pa * tx + pc * ty + worldTx[p];
+            worldTy[index] = pb * tx + pd * ty + worldTy[p];
+            parentVersion[index] = version[p];
+        }
+        version[index]++;
+        dirty[index] = 0;
+    }
+
+    void Transforms::sort()
+    {
+        reorder = false;
+        size_t count = owner.size();
+
+        std::vector<uint32_t> depth(count, NONE);
+        std::vector<uint32_t> chain;
+        for (size_t i = 0; i < count; i++)
+        {
+            uint32_t index = (uint32_t)i;
+            while (depth[index] == NONE && parent[index] != NONE)
+            {
+                chain.push_back(index);
+                index = parent[index];
+            }
+            uint32_t known = depth[index] == NONE ? 0 : depth[index];
+            depth[index] = known;
+            while (!chain.empty())
+            {
+                depth[chain.back()] = ++known;
+                chain.pop_back();
+            }
+        }
+
+        std::vector<uint32_t> order;
+        order.reserve(count);
+        for (uint32_t i = 0; i < count; i++)
+        {
+            if (owner[i])
+                order.push_back(i);
+        }
+        std::stable_sort(order.begin(), order.end(), [&depth](uint32_t a, uint32_t b)
+                         { return depth[a] < depth[b]; });
+
+        std::vector<uint32_t> remap(count, NONE);
+        for (uint32_t i = 0; i < order.size(); i++)
+            remap[order[i]] = i;
+
+        permute(handle, order);
+        permute(owner, order);
+        permute(entity, order);
+        permute(parent, order);
+        permute(x, order);
+        permute(y, order);
+        permute(rotation, order);
+        permute(cos, order);
+        permute(sin, order);
+        permute(scaleX, order);
+        permute(scaleY, order);
+        permute(originX, order);
+        permute(originY, order);
+        permute(dirty, order);
+        permute(offsetX, order);
+        permute(offsetY, order);
+        permute(worldA, order);
+        permute(worldB, order);
+        permute(worldC, order);
+        permute(worldD, order);
+        permute(worldTx, order);
+        permute(worldTy, order);
+        permute(version, order);
+        permute(parentVersion, order);
+
+        for (uint32_t i = 0; i < order.size(); i++)
+        {
+            if (parent[i] != NONE)
+                parent[i] = remap[parent[i]];
+            indices[handle[i]] = i;
+        }
+    }
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "glm/glm.hpp"
+
+namespace Engine
+{
+    class Entity;
+    class Transform;
+
+    // The data of every Transform in a World, one array per field (indexed the same way).
+    // Arrays are kept ordered by depth in the hierarchy, so a parent always comes before its children.
+    // World matrices are computed lazily: a Transform is dirty when its own values changed, when its parent's world
+    // matrix was recomputed after its own (each world matrix has a version, children remember their parent's, so the
+    // flag reaches every child without walking the hierarchy down) or, for roots, when its entity's render position
+    // moved (the entity was moved or Time::alpha changed). Only dirty Transforms are recomputed.
+    // Transform components hold a handle, which stays the same when the arrays are reordered.
+    class Transforms
+    {
+    public:
+        static constexpr uint32_t NONE = UINT32_MAX;
+
+        uint32_t create(Transform *owner, Entity *entity);
+        void destroy(uint32_t handle);
+
+        // Returns false if `parent` is `handle` or one of its descendants
+        bool setParent(uint32_t handle, uint32_t parent);
+        [[nodiscard]] Transform *getParent(uint32_t handle) const;
+
+        void setPosition(uint32_t handle, const glm::vec2 &position);
+        void setRotation(uint32_t handle, float radians);
+        void setScale(uint32_t handle, const glm::vec2 &scale);
+        void setOrigin(uint32_t handle, const glm::vec2 &origin);
+
+        [[nodiscard]] glm::vec2 getPosition(uint32_t handle) const;
+        [[nodiscard]] float getRotation(uint32_t handle) const;
+        [[nodiscard]] glm::vec2 getScale(uint32_t handle) const;
+        [[nodiscard]] glm::vec2 getOrigin(uint32_t handle) const;
+
+        // Local to world, recomputing the matrices of `handle` and its parents first if they are dirty
+        glm::mat3x2 matrix(uint32_t handle);
+
+        // Recomputes every dirty world matrix in one pass
+        void update();
+
+        [[nodiscard]] size_t size() const { return owner.size(); }
+
+    private:
+        // handle -> index in the arrays
+        std::vector<uint32_t> indices;
+        std::vector<uint32_t> freeHandles;
+
+        std::vector<uint32_t> handle;
+        std::vector<Transform *> owner;
+        std::vector<Entity *> entity;
+        // index of the parent, NONE for roots
+        std::vector<uint32_t> parent;
+
+        std::vector<float> x, y;
+        std::vector<float> rotation, cos, sin;
+        std::vector<float> scaleX, scaleY;
+        std::vector<float> originX, originY;
+
+        // the values above changed since the world matrix was computed
+        std::vector<uint8_t> dirty;
+        // the entity render position a root's world matrix was computed with
+        std::vector<float> offsetX, offsetY;
+        // world matrices, columns (a, b), (c, d), (tx, ty)
+        std::vector<float> worldA, worldB, worldC, worldD, worldTx, worldTy;
+        // bumped every time the world matrix is recomputed, and the parent's when it was
+        std::vector<uint32_t> version;
+        std::vector<uint32_t> parentVersion;
+
+        // the hierarchy changed, the arrays have to be reordered before the next update
+        bool reorder = false;
+        // reused by matrix(), a Transform and its parents
+        std::vector<uint32_t> chain;
+
+        [[nodiscard]] bool isDirty(uint32_t index) const;
+        void recompute(uint32_t index);
+
+        // Drops destroyed transforms and sorts the arrays by depth
+        void sort();
+    };
+}
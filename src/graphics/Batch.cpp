@@ -5,6 +5,20 @@
 #include "iostream"
 #include "Utils.h"
 #include "DefaultShader.h"
+#include "ShaderCache.h"
+#include "Profiler.h"
+#include "GpuProfiler.h"
+#include "Application.h"
+#include <algorithm>
+#include "ImageOps.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define ENGINE_BATCH_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define ENGINE_BATCH_NEON
+#endif
 
 namespace Engine
 {
@@ -13,7 +27,7 @@ namespace Engine
             {0, VertexType::Float2, false}, // position
             {1, VertexType::Float2, false}, // uv
             {2, VertexType::UByte4, true},  // color
-            {3, VertexType::UByte4, true},  // type (mult, wash, fill)
+            {3, VertexType::UByte4, true},  // type (mult, wash, fill, layer)
         });
 
     Batch::Batch()
@@ -177,14 +191,30 @@ namespace Engine
         if ((m_batches.empty() && m_currentBatch.elements <= 0) || m_indices.empty())
             return;
 
+        // Headless: the batch is still built (and has to be cleared by the caller), it just never reaches a GPU
+        if (Application::isHeadless())
+            return;
+
+        ENGINE_PROFILE_SCOPE("Batch::render");
+        ENGINE_GPU_PROFILE_SCOPE("Batch::render");
+
         // define defaults
         {
             if (!m_mesh)
                 m_mesh = std::shared_ptr<Mesh>{new Mesh()};
             if (!mDefaultMaterial)
             {
-                auto mDefaultShader = std::shared_ptr<Shader>(new Shader(shader_data));
-                mDefaultMaterial = std::shared_ptr<Material>(new Material(mDefaultShader));
+                // compiled by ShaderCache::warmUp while loading, this is just a lookup
+                mDefaultMaterial = std::shared_ptr<Material>(new Material(ShaderCache::get(shader_data)));
+            }
+            if (!mDefaultArrayMaterial)
+            {
+                mDefaultArrayMaterial = std::shared_ptr<Material>(new Material(ShaderCache::get(array_shader_data)));
+            }
+            if (!mDefaultDistanceFieldMaterial)
+            {
+                mDefaultDistanceFieldMaterial =
+                    std::shared_ptr<Material>(new Material(ShaderCache::get(distance_field_shader_data)));
             }
         }
 
@@ -234,7 +264,12 @@ namespace Engine
     {
         pass.material = b.material;
         if (!pass.material)
-            pass.material = mDefaultMaterial;
+        {
+            if (b.texture && b.texture->isArray())
+                pass.material = mDefaultArrayMaterial;
+            else
+                pass.material = b.distanceField ? mDefaultDistanceFieldMaterial : mDefaultMaterial;
+        }
 
         // upload the texture in the batch when using the default material
         // (or a custom material with a shader containing a "u_texture" uniform)
@@ -282,7 +317,7 @@ namespace Engine
         m_currentBatch.layer = 0;
         m_currentBatch.elements = 0;
         m_currentBatch.offset = 0;
-        m_currentBatch.blend = BlendMode::Normal;
+        m_currentBatch.blend = Texture::isPremultipliedAlpha() ? BlendMode::Premultiplied : BlendMode::Normal;
         m_currentBatch.material.reset();
         m_currentBatch.texture.reset();
         m_currentBatch.sampler = defaultSampler;
@@ -293,6 +328,18 @@ namespace Engine
         m_color_mode_stack.clear();
         m_layer_stack.clear();
         m_batches.clear();
+
+        m_frame++;
+        if (m_frame % TEXT_CACHE_FRAMES == 0)
+        {
+            for (auto it = m_text_cache.begin(); it != m_text_cache.end();)
+            {
+                if (m_frame - it->second.lastFrame > TEXT_CACHE_FRAMES)
+                    it = m_text_cache.erase(it);
+                else
+                    ++it;
+            }
+        }
     }
 
     void Batch::dispose()
@@ -308,9 +355,113 @@ namespace Engine
         m_batches.clear();
 
         mDefaultMaterial.reset();
+        mDefaultArrayMaterial.reset();
+        mDefaultDistanceFieldMaterial.reset();
         m_mesh.reset();
     }
 
+    void Batch::flushCurrentBatch()
+    {
+        if (m_currentBatch.elements > 0)
+        {
+            appendBatch(m_currentBatch);
+            m_currentBatch.offset += m_currentBatch.elements;
+            m_currentBatch.elements = 0;
+        }
+    }
+
+    void Batch::appendBatch(const DrawBatch &batch)
+    {
+        if (!m_batches.empty())
+        {
+            auto &last = m_batches.back();
+            bool sameState = last.layer == batch.layer &&
+                             last.material == batch.material &&
+                             last.blend == batch.blend &&
+                             last.texture == batch.texture &&
+                             last.sampler == batch.sampler &&
+                             last.flipVertically == batch.flipVertically &&
+                             last.distanceField == batch.distanceField;
+            if (sameState && last.offset + last.elements == batch.offset)
+            {
+                last.elements += batch.elements;
+                return;
+            }
+        }
+        m_batches.push_back(batch);
+    }
+
+    void Batch::merge(std::vector<const Batch *> batches)
+    {
+        ENGINE_PROFILE_SCOPE("Batch::merge");
+        std::stable_sort(batches.begin(), batches.end(), [](const Batch *a, const Batch *b)
+                         { return a->sortKey < b->sortKey; });
+
+        flushCurrentBatch();
+
+        size_t vertexCount = m_vertices.size();
+        size_t indexCount = m_indices.size();
+        for (auto *batch : batches)
+        {
+            vertexCount += batch->m_vertices.size();
+            indexCount += batch->m_indices.size();
+        }
+        m_vertices.reserve(vertexCount);
+        m_indices.reserve(indexCount);
+
+        for (auto *batch : batches)
+        {
+            ENGINE_ASSERT(batch != this, "A Batch can't be merged into itself");
+            auto baseVertex = (uint32_t)m_vertices.size();
+            // DrawBatch offsets count triangles
+            int baseTriangle = (int)(m_indices.size() / 3);
+
+            m_vertices.insert(m_vertices.end(), batch->m_vertices.begin(), batch->m_vertices.end());
+            for (auto index : batch->m_indices)
+                m_indices.push_back(index + baseVertex);
+
+            for (auto &recorded : batch->m_batches)
+            {
+                if (recorded.elements <= 0)
+                    continue;
+                DrawBatch rebased = recorded;
+                rebased.offset += baseTriangle;
+                appendBatch(rebased);
+            }
+            if (batch->m_currentBatch.elements > 0)
+            {
+                DrawBatch rebased = batch->m_currentBatch;
+                rebased.offset += baseTriangle;
+                appendBatch(rebased);
+            }
+        }
+
+        // keep recording after the merged geometry, with this Batch's own state
+        m_currentBatch.offset = (int)(m_indices.size() / 3);
+        m_currentBatch.elements = 0;
+    }
+
+    Batch::Vertex *Batch::appendQuads(size_t count)
+    {
+        auto first = (uint32_t)m_vertices.size();
+        auto indexStart = m_indices.size();
+        // one resize each, the new elements are left uninitialised for the caller to write
+        m_indices.resize(indexStart + count * 6);
+        m_vertices.resize(first + count * 4);
+
+        uint32_t *index = m_indices.data() + indexStart;
+        for (uint32_t v = first; v < first + count * 4; v += 4, index += 6)
+        {
+            index[0] = v + 0;
+            index[1] = v + 1;
+            index[2] = v + 2;
+            index[3] = v + 0;
+            index[4] = v + 2;
+            index[5] = v + 3;
+        }
+        return m_vertices.data() + first;
+    }
+
     void Batch::quad(const glm::vec2 &pos0,
                      const glm::vec2 &pos1,
                      const glm::vec2 &pos2,
@@ -321,24 +472,8 @@ namespace Engine
         // Two triangles
         m_currentBatch.elements += 2;
 
-        // Add 6 indices to m_indices
-        m_indices.reserve(m_indices.size() + 6);
-
-        m_indices.push_back(m_vertices.size() + 0);
-        m_indices.push_back(m_vertices.size() + 1);
-        m_indices.push_back(m_vertices.size() + 2);
-        m_indices.push_back(m_vertices.size() + 0);
-        m_indices.push_back(m_vertices.size() + 2);
-        m_indices.push_back(m_vertices.size() + 3);
-
         // Add 4 vertices (make sure to use the matrix)
-        // Resize m_vertices to have 4 additial spaces [..., _, _, _, _]
-        m_vertices.resize(m_vertices.size() + 4);
-
-        // [..., _, _, _, _]
-        //                ^ m_vertices.back()
-        //   ^ m_vertices.back() - 4
-        auto *p = &m_vertices.back() - 4;
+        auto *p = appendQuads(1);
         const glm::vec2 *positions[4] = {&pos0, &pos1, &pos2, &pos3};
         glm::vec2 uvs[4]{
             {0.0f, 0.0f},
@@ -347,16 +482,18 @@ namespace Engine
             {0.0f, 1.0f},
         };
         uint8_t uvi = 0;
+        auto vertex_color = vertexColor(color);
         for (auto &position : positions)
         {
-            ++p;
             p->position = m_matrix * glm::vec3(*position, 1.0);
-            p->color = color;
+            p->color = vertex_color;
             p->texture = uvs[uvi];
             uvi++;
             p->wash = 255;
             p->fill = 255;
             p->mult = 0;
+            p->layer = 0;
+            ++p;
         }
     }
 
@@ -376,24 +513,8 @@ namespace Engine
 
         m_currentBatch.elements += 2; // Two triangles
 
-        // Add 6 indices to m_indices
-        m_indices.reserve(m_indices.size() + 6);
-
-        m_indices.push_back(m_vertices.size() + 0);
-        m_indices.push_back(m_vertices.size() + 1);
-        m_indices.push_back(m_vertices.size() + 2);
-        m_indices.push_back(m_vertices.size() + 0);
-        m_indices.push_back(m_vertices.size() + 2);
-        m_indices.push_back(m_vertices.size() + 3);
-
         // Add 4 vertices (make sure to use the matrix)
-
-        // yeah, I don't think you can do this (reserve).
-        // It breaks the std::vector API. How will it know that size changed?
-        // m_vertices.reserve(m_vertices.size() + 4);
-
-        m_vertices.resize(m_vertices.size() + 4);
-        auto *p = &m_vertices.back() - 4;
+        auto *p = appendQuads(1);
 
         glm::vec2 positions[4]{
             glm::vec2{0, 0},
@@ -417,20 +538,31 @@ namespace Engine
         }
 
         auto wash = m_color_mode == ColorMode::Wash ? 255 : 0;
-        auto mult = m_color_mode == ColorMode::Normal ? 255 : 0;
-        for (int i = 0; i < 4; i++)
+        auto mult = m_color_mode != ColorMode::Wash ? 255 : 0;
+        auto vertex_color = vertexColor(color);
+        for (int i = 0; i < 4; i++, p++)
         {
-            ++p;
             p->position = m_matrix * glm::vec3(position + positions[i], 1.0f);
-            p->color = color;
+            p->color = vertex_color;
             p->texture = uvs[i];
             p->wash = wash;
             p->fill = 0;
             p->mult = mult;
+            p->layer = 0;
         }
     }
 
     void Batch::tex(const Subtexture &sprite, const glm::vec2 &position, const Color &color)
+    {
+        texQuad(sprite, position, color, m_matrix);
+    }
+
+    void Batch::tex(const Subtexture &sprite, const glm::vec2 &position, const Color &color, const glm::mat3x2 &matrix)
+    {
+        texQuad(sprite, position, color, m_matrix * glm::mat3x3(matrix));
+    }
+
+    void Batch::texQuad(const Subtexture &sprite, const glm::vec2 &position, const Color &color, const glm::mat3x2 &matrix)
     {
         if (!sprite.texture)
             return;
@@ -438,61 +570,156 @@ namespace Engine
 
         m_currentBatch.elements += 2; // Two triangles
 
-        // Add 6 indices to m_indices
-        m_indices.reserve(m_indices.size() + 6);
-
-        m_indices.push_back(m_vertices.size() + 0);
-        m_indices.push_back(m_vertices.size() + 1);
-        m_indices.push_back(m_vertices.size() + 2);
-        m_indices.push_back(m_vertices.size() + 0);
-        m_indices.push_back(m_vertices.size() + 2);
-        m_indices.push_back(m_vertices.size() + 3);
-
         // Add 4 vertices (make sure to use the matrix)
-        m_vertices.resize(m_vertices.size() + 4);
-        auto *p = &m_vertices.back() - 4;
-
-        // Todo: perhaps calculate the texture UVs once, instead of on every frame?
-        // put the UVs in the sprite.
-
-        auto textureSize = glm::vec2{
-            (float)sprite.texture->getWidth(),
-            (float)sprite.texture->getHeight(),
-        };
+        auto *p = appendQuads(1);
 
         glm::vec2 positions[4]{
             glm::vec2{0, 0},
             glm::vec2(sprite.width(), 0.0f),
             glm::vec2{sprite.width(), sprite.height()},
             glm::vec2(0.0f, sprite.height())};
-        glm::vec2 uvs[4]{
-            sprite.rect.top_left(),
-            sprite.rect.top_right(),
-            sprite.rect.bottom_right(),
-            sprite.rect.bottom_left(),
-        };
+        glm::vec2 uv0 = sprite.uv0;
+        glm::vec2 uv1 = sprite.uv1;
         if (m_currentBatch.flipVertically)
         {
-            for (int i = 0; i < 4; i++)
-            {
-                uvs[i].y = 1.0 - uvs[i].y;
-            }
+            uv0.y = 1.0f - uv0.y;
+            uv1.y = 1.0f - uv1.y;
         }
+        glm::vec2 uvs[4]{uv0, {uv1.x, uv0.y}, uv1, {uv0.x, uv1.y}};
 
         auto wash = m_color_mode == ColorMode::Wash ? 255 : 0;
-        auto mult = m_color_mode == ColorMode::Normal ? 255 : 0;
-        for (int i = 0; i < 4; i++)
+        auto mult = m_color_mode != ColorMode::Wash ? 255 : 0;
+        auto vertex_color = vertexColor(color);
+        for (int i = 0; i < 4; i++, p++)
         {
-            ++p;
-            p->position = m_matrix * glm::vec3(position + positions[i], 1.0f);
-            p->color = color;
-            p->texture = uvs[i] / textureSize;
+            p->position = matrix * glm::vec3(position + positions[i], 1.0f);
+            p->color = vertex_color;
+            p->texture = uvs[i];
             p->mult = mult;
             p->wash = wash;
             p->fill = 0;
+            p->layer = (uint8_t)sprite.layer;
+        }
+    }
+
+    void Batch::texBatch(const SpriteInstance *instances, size_t count)
+    {
+        const float a = m_matrix[0].x, b = m_matrix[0].y;
+        const float c = m_matrix[1].x, d = m_matrix[1].y;
+        const float tx = m_matrix[2].x, ty = m_matrix[2].y;
+        auto wash = (uint8_t)(m_color_mode == ColorMode::Wash ? 255 : 0);
+        auto mult = (uint8_t)(m_color_mode != ColorMode::Wash ? 255 : 0);
+
+        size_t start = 0;
+        while (start < count)
+        {
+            // a run of instances drawn with the same texture
+            const auto &texture = instances[start].sprite->texture;
+            size_t end = start + 1;
+            while (end < count && instances[end].sprite->texture == texture)
+                end++;
+            if (!texture)
+            {
+                start = end;
+                continue;
+            }
+
+            setTexture(texture);
+            bool flip = m_currentBatch.flipVertically;
+            m_currentBatch.elements += (int)(end - start) * 2;
+            Vertex *p = appendQuads(end - start);
+
+#if defined(ENGINE_BATCH_SSE2)
+            const __m128 ma = _mm_set1_ps(a), mb = _mm_set1_ps(b);
+            const __m128 mc = _mm_set1_ps(c), md = _mm_set1_ps(d);
+            const __m128 mtx = _mm_set1_ps(tx), mty = _mm_set1_ps(ty);
+#elif defined(ENGINE_BATCH_NEON)
+            const float32x4_t mtx = vdupq_n_f32(tx), mty = vdupq_n_f32(ty);
+#endif
+
+            for (size_t i = start; i < end; i++, p += 4)
+            {
+                const SpriteInstance &instance = instances[i];
+                const Subtexture &sprite = *instance.sprite;
+                float x0 = instance.position.x;
+                float y0 = instance.position.y;
+                float x1 = x0 + sprite.width() * instance.scale.x;
+                float y1 = y0 + sprite.height() * instance.scale.y;
+
+                // the 4 corners (top left, top right, bottom right, bottom left) are transformed together
+#if defined(ENGINE_BATCH_SSE2)
+                __m128 xs = _mm_setr_ps(x0, x1, x1, x0);
+                __m128 ys = _mm_setr_ps(y0, y0, y1, y1);
+                __m128 xt = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ma, xs), _mm_mul_ps(mc, ys)), mtx);
+                __m128 yt = _mm_add_ps(_mm_add_ps(_mm_mul_ps(mb, xs), _mm_mul_ps(md, ys)), mty);
+                __m128 first = _mm_unpacklo_ps(xt, yt);
+                __m128 second = _mm_unpackhi_ps(xt, yt);
+                _mm_storel_pi((__m64 *)&p[0].position, first);
+                _mm_storeh_pi((__m64 *)&p[1].position, first);
+                _mm_storel_pi((__m64 *)&p[2].position, second);
+                _mm_storeh_pi((__m64 *)&p[3].position, second);
+#elif defined(ENGINE_BATCH_NEON)
+                const float cornersX[4] = {x0, x1, x1, x0};
+                const float cornersY[4] = {y0, y0, y1, y1};
+                float32x4_t xs = vld1q_f32(cornersX);
+                float32x4_t ys = vld1q_f32(cornersY);
+                float32x4_t xt = vmlaq_n_f32(vmlaq_n_f32(mtx, xs, a), ys, c);
+                float32x4_t yt = vmlaq_n_f32(vmlaq_n_f32(mty, xs, b), ys, d);
+                float32x4x2_t zipped = vzipq_f32(xt, yt);
+                vst1_f32(&p[0].position.x, vget_low_f32(zipped.val[0]));
+                vst1_f32(&p[1].position.x, vget_high_f32(zipped.val[0]));
+                vst1_f32(&p[2].position.x, vget_low_f32(zipped.val[1]));
+                vst1_f32(&p[3].position.x, vget_high_f32(zipped.val[1]));
+#else
+                const float cornersX[4] = {x0, x1, x1, x0};
+                const float cornersY[4] = {y0, y0, y1, y1};
+                for (int v = 0; v < 4; v++)
+                {
+                    p[v].position.x = a * cornersX[v] + c * cornersY[v] + tx;
+                    p[v].position.y = b * cornersX[v] + d * cornersY[v] + ty;
+                }
+#endif
+
+                glm::vec2 uv0 = sprite.uv0;
+                glm::vec2 uv1 = sprite.uv1;
+                if (flip)
+                {
+                    uv0.y = 1.0f - uv0.y;
+                    uv1.y = 1.0f - uv1.y;
+                }
+                p[0].texture = uv0;
+                p[1].texture = {uv1.x, uv0.y};
+                p[2].texture = uv1;
+                p[3].texture = {uv0.x, uv1.y};
+
+                auto color = vertexColor(instance.color);
+                auto layer = (uint8_t)sprite.layer;
+                for (int v = 0; v < 4; v++)
+                {
+                    p[v].color = color;
+                    p[v].mult = mult;
+                    p[v].wash = wash;
+                    p[v].fill = 0;
+                    p[v].layer = layer;
+                }
+            }
+            start = end;
         }
     }
 
+    Color Batch::vertexColor(const Color &color) const
+    {
+        if (!Texture::isPremultipliedAlpha())
+            return color;
+
+        Color result = color;
+        ImageOps::premultiply(&result, 1);
+        // alpha 0 turns Premultiplied blending into additive blending
+        if (m_color_mode == ColorMode::Additive)
+            result.a = 0;
+        return result;
+    }
+
     void Batch::circle(const glm::vec2 &center, float radius, int steps, Color color)
     {
         ENGINE_ASSERT(steps >= 3, "Circle must have at least 3 steps");
@@ -512,12 +739,9 @@ namespace Engine
         // one triangle
         m_currentBatch.elements += 1;
 
-        // Add 6 indices to m_indices
-        m_indices.reserve(m_indices.size() + 3);
-
-        m_indices.push_back(m_vertices.size() + 0);
-        m_indices.push_back(m_vertices.size() + 1);
-        m_indices.push_back(m_vertices.size() + 2);
+        // Add 3 indices to m_indices
+        auto first = (uint32_t)m_vertices.size();
+        m_indices.insert(m_indices.end(), {first + 0, first + 1, first + 2});
 
         // Add 4 vertices (make sure to use the matrix)
         // Resize m_vertices to have 4 additial spaces [..., _, _, _, _]
@@ -528,15 +752,17 @@ namespace Engine
         //   ^ m_vertices.back() - 3
         auto *p = &m_vertices.back() - 3;
         const glm::vec2 *positions[3] = {&pos0, &pos1, &pos2};
+        auto vertex_color = vertexColor(color);
         for (auto &position : positions)
         {
             ++p;
             p->position = m_matrix * glm::vec3(*position, 1.0);
-            p->color = color;
+            p->color = vertex_color;
             p->texture = glm::vec2(0.0f, 0.0f);
             p->wash = 255;
             p->fill = 255;
             p->mult = 0;
+            p->layer = 0;
         }
     }
 
@@ -553,32 +779,91 @@ namespace Engine
         quad(pos1, pos2, pos3, pos4, color);
     }
 
+    const TextLayout &Batch::layoutText(const Engine::Font &font, const std::string &text)
+    {
+        // reuses the key's buffer, drawing cached text doesn't allocate
+        thread_local TextKey key;
+        key.font = font.getId();
+        key.text = text;
+        auto it = m_text_cache.find(key);
+        if (it == m_text_cache.end())
+            it = m_text_cache.emplace(key, CachedText{font.layout(text), m_frame}).first;
+        else if (it->second.layout.generation != font.getGeneration())
+            it->second.layout = font.layout(text); // some of its glyphs were evicted from the font atlas
+        else
+            font.touch(it->second.layout);
+        it->second.lastFrame = m_frame;
+        return it->second.layout;
+    }
+
     void Batch::str(const Engine::Font &font, const std::string &text,
                     const glm::vec2 &position, const Color &color, float scale,
                     TextAlign align) {
+      if (text.empty())
+        return;
+      auto &layout = layoutText(font, text);
+      if (layout.glyphs.empty())
+        return;
 
       auto offset = 0.0f;
       if (align == TextAlign::CENTERED) {
-        offset = font.getWidth(text.c_str()) / 2.0f;
+        offset = layout.width / 2.0f;
       }
-      pushMatrix(Engine::Math::transform(
+      glm::mat3x2 matrix = m_matrix * glm::mat3x3(Engine::Math::transform(
           position + glm::vec2{0.0f, font.ascent + font.descent},
           {offset, 0.0f}, glm::vec2{scale, scale}));
 
-      auto txt = text.c_str();
-      float x = 0;
-      float y = 0;
-
-      while (*txt) {
-        auto character = font.getCharacter(txt);
-        x += character.offset_x; // this character left padding
-        y = character.offset_y;
-        tex(character.texture, glm::vec2{x, y}, color);
-        x += font.getAdvance(*txt, *(txt + 1)); // next character space
-        ++txt;
+      // distance fields need their shader and linear filtering, only for this string
+      auto sampler = m_currentBatch.sampler;
+      if (layout.distanceField) {
+        flushCurrentBatch();
+        m_currentBatch.distanceField = true;
+        m_currentBatch.sampler = TextureSampler(TextureFilter::Linear, TextureWrap::Clamp, TextureWrap::Clamp);
+      }
+
+      // one allocation for the whole string, the texture only changes between atlas pages
+      auto glyphCount = layout.glyphs.size();
+      auto *p = appendQuads(glyphCount);
+
+      uint8_t wash = m_color_mode == ColorMode::Wash ? 255 : 0;
+      uint8_t mult = m_color_mode != ColorMode::Wash ? 255 : 0;
+      auto vertex_color = vertexColor(color);
+      int texture = -1;
+      bool flip = false;
+      for (auto &glyph : layout.glyphs) {
+        if (glyph.texture != texture) {
+          texture = glyph.texture;
+          setTexture(layout.textures[texture]);
+          flip = m_currentBatch.flipVertically;
+        }
+        m_currentBatch.elements += 2; // Two triangles
+
+        glm::vec2 corners[4]{
+            glyph.position,
+            glyph.position + glm::vec2{glyph.size.x, 0.0f},
+            glyph.position + glyph.size,
+            glyph.position + glm::vec2{0.0f, glyph.size.y}};
+        glm::vec2 uvs[4]{
+            glyph.uv0,
+            {glyph.uv1.x, glyph.uv0.y},
+            glyph.uv1,
+            {glyph.uv0.x, glyph.uv1.y}};
+        for (int i = 0; i < 4; i++, p++) {
+          p->position = matrix * glm::vec3(corners[i], 1.0f);
+          p->texture = flip ? glm::vec2{uvs[i].x, 1.0f - uvs[i].y} : uvs[i];
+          p->color = vertex_color;
+          p->mult = mult;
+          p->wash = wash;
+          p->fill = 0;
+          p->layer = 0;
+        }
       }
 
-      popMatrix();
+      if (layout.distanceField) {
+        flushCurrentBatch();
+        m_currentBatch.distanceField = false;
+        m_currentBatch.sampler = sampler;
+      }
     }
 
     void Batch::str(const Engine::Font &font, const std::string &text, const glm::vec2 &position, const Color &color)
@@ -588,6 +873,6 @@ namespace Engine
 
     void Batch::str(const Engine::Font &font, const std::string &text, const glm::vec2 &position, const Color &color, float scale)
     {
-        str(font, text, position, color, 1.0f, TextAlign::LEFT);
+        str(font, text, position, color, scale, TextAlign::LEFT);
     }
 }
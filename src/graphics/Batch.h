@@ -1,6 +1,9 @@
 #pragma once
 
 #include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
 #include "Sampler.h"
 #include "FrameBuffer.h"
 #include "Texture.h"
@@ -23,10 +26,25 @@ namespace Engine
         Normal,
         // Ignores the texture color but still uses transparency, essentially
         // drawing the "shape" of the texture as a solid color
-        Wash
+        Wash,
+        // Adds the color on top of what's already there instead of blending over it.
+        // Needs the premultiplied alpha pipeline (BlendMode::Premultiplied), draws like Normal otherwise
+        Additive
+    };
+
+    // One sprite of a Batch::texBatch call
+    struct SpriteInstance
+    {
+        const Subtexture *sprite;
+        glm::vec2 position;
+        glm::vec2 scale{1.0f, 1.0f};
+        Color color;
     };
 
     // A 2D sprite batcher.
+    // Recording (every method but render()) only touches CPU memory, so Batches can be filled on worker threads,
+    // one Batch per thread, and merged into the Batch the render thread renders.
+    // The exception is str() with characters its Font hasn't rasterized yet, see Font.
     class Batch
     {
 
@@ -38,6 +56,9 @@ namespace Engine
         // Set on clear
         TextureSampler defaultSampler;
 
+        // Position of this Batch when merged into another one, lower keys are drawn first
+        int sortKey = 0;
+
         Batch();
 
         Batch(const Batch &other) = delete;
@@ -78,6 +99,12 @@ namespace Engine
 
         void dispose();
 
+        // Appends what `batches` recorded after what this Batch already holds, ordered by sortKey
+        // (Batches with the same key keep their order in the list, so the result is the same every frame).
+        // Consecutive draws with the same state are joined into one. The merged Batches are left untouched,
+        // they must not be recorded into while merging.
+        void merge(std::vector<const Batch *> batches);
+
         void quad(const glm::vec2 &pos0,
                   const glm::vec2 &pos1,
                   const glm::vec2 &pos2,
@@ -92,6 +119,15 @@ namespace Engine
 
         void tex(const Subtexture &sprite, const glm::vec2 &position, const Color &color);
 
+        // Draws with a precomputed matrix (ex. Transform::getMatrix()) applied after the current one,
+        // without pushing it on the stack
+        void tex(const Subtexture &sprite, const glm::vec2 &position, const Color &color, const glm::mat3x2 &matrix);
+
+        // Draws many sprites at once (ex. particles), the same as calling tex() for each of them with its size scaled
+        // by `scale`. Consecutive instances sharing a texture are written in one go, sort them by texture to get the
+        // fewest draw calls.
+        void texBatch(const SpriteInstance *instances, size_t count);
+
         void line(const glm::vec2& from, const glm::vec2& to, float t, Color color);
 
         void tri(glm::vec2 pos0, glm::vec2 pos1, glm::vec2 pos2, Color color);
@@ -102,6 +138,8 @@ namespace Engine
 
         // void circle(const glm::vec2& center, float radius, int steps, Color center_color, Color outer_color);
 
+        // Text is laid out once and drawn from the layout while the same string is drawn every frame
+        // (layouts not drawn for TEXT_CACHE_FRAMES clears are dropped)
         enum TextAlign { LEFT, CENTERED };
         void str(const Engine::Font &font, const std::string &text, const glm::vec2 &position, const Color &color);
         void str(const Engine::Font &font, const std::string &text, const glm::vec2 &position, const Color &color, float scale);
@@ -109,18 +147,43 @@ namespace Engine
 
 
     private:
+        // No initialisers: every field is written when the vertex is added
         struct Vertex
         {
             glm::vec2 position;
-            glm::vec2 texture{0};
+            glm::vec2 texture;
             Color color;
 
             // these unsigned int get interpeted as floats in the fragment shader
             // they are meant to be values between (0 - 255) with represents (0.0 to 1.0) in floats
-            uint8_t mult = 255;
-            uint8_t wash = 0;
-            uint8_t fill = 0;
-            uint8_t pad = 0;
+            uint8_t mult;
+            uint8_t wash;
+            uint8_t fill;
+            // texture array layer (0 - 255), the array shader scales it back from the normalised value
+            uint8_t layer;
+        };
+
+        // Default-initialises instead of value-initialising, so growing the vertex and index arrays doesn't
+        // zero memory that's about to be written
+        template <class T>
+        struct UninitializedAllocator : std::allocator<T>
+        {
+            template <class U>
+            struct rebind
+            {
+                using other = UninitializedAllocator<U>;
+            };
+
+            UninitializedAllocator() = default;
+
+            template <class U>
+            UninitializedAllocator(const UninitializedAllocator<U> &) {}
+
+            template <class U>
+            void construct(U *p) { ::new ((void *)p) U; }
+
+            template <class U, class... Args>
+            void construct(U *p, Args &&...args) { ::new ((void *)p) U(std::forward<Args>(args)...); }
         };
 
         struct DrawBatch
@@ -133,14 +196,19 @@ namespace Engine
             std::shared_ptr<Texture> texture;
             TextureSampler sampler;
             bool flipVertically;
+            // text from a distance field Font
+            bool distanceField;
 
             DrawBatch() : layer(0),
                           offset(0),
                           elements(0),
-                          flipVertically(false) {}
+                          flipVertically(false),
+                          distanceField(false) {}
         };
 
         std::shared_ptr<Material> mDefaultMaterial; // used when the DrawBatch doesn't specify a material
+        std::shared_ptr<Material> mDefaultArrayMaterial; // same, for texture arrays
+        std::shared_ptr<Material> mDefaultDistanceFieldMaterial; // same, for distance field text
 
         /**
          * The mesh never changes, we could initialise it this here even,
@@ -152,15 +220,59 @@ namespace Engine
         uint8_t m_tex_mult;
         uint8_t m_tex_wash;
         DrawBatch m_currentBatch;
-        std::vector<Vertex> m_vertices;
-        std::vector<uint32_t> m_indices;
+        std::vector<Vertex, UninitializedAllocator<Vertex>> m_vertices;
+        std::vector<uint32_t, UninitializedAllocator<uint32_t>> m_indices;
         std::vector<glm::mat3x2> m_matrix_stack;
         // A drawbatch specifies a 'material', a 'texture' and the # number of triangles(elements) to draw using those
         // The actual vertices and indices are stored in the parent Batch (this object)
         std::vector<DrawBatch> m_batches;
 
+        static constexpr uint32_t TEXT_CACHE_FRAMES = 60;
+
+        struct TextKey
+        {
+            uint32_t font;
+            std::string text;
+
+            bool operator==(const TextKey &other) const { return font == other.font && text == other.text; }
+        };
+
+        struct TextKeyHash
+        {
+            size_t operator()(const TextKey &key) const { return std::hash<std::string>()(key.text) ^ key.font; }
+        };
+
+        struct CachedText
+        {
+            TextLayout layout;
+            uint32_t lastFrame;
+        };
+
+        // Per Batch, so worker threads recording their own Batch don't share it
+        std::unordered_map<TextKey, CachedText, TextKeyHash> m_text_cache;
+        // incremented on clear()
+        uint32_t m_frame = 0;
+
+        const TextLayout &layoutText(const Engine::Font &font, const std::string &text);
+
         void render_single_batch(RenderPass &pass, const DrawBatch &b, const glm::mat4x4 &matrix);
 
+        // Moves the current batch to m_batches if it has anything to draw (joining it with the previous one if possible)
+        void flushCurrentBatch();
+
+        // Adds a recorded batch (with offset already rebased) to m_batches, joining it with the previous one if possible
+        void appendBatch(const DrawBatch &batch);
+
+        // Color written to the vertices, premultiplied when the premultiplied alpha pipeline is enabled
+        Color vertexColor(const Color &color) const;
+
+        // Appends `count` quads: their indices are written, their 4 vertices each are left for the caller to fill.
+        // Doesn't count the triangles in the current batch.
+        Vertex *appendQuads(size_t count);
+
+        // A textured quad transformed by `matrix` alone (it already includes the current matrix)
+        void texQuad(const Subtexture &sprite, const glm::vec2 &position, const Color &color, const glm::mat3x2 &matrix);
+
         std::vector<ColorMode> m_color_mode_stack;
         std::vector<BlendMode> m_blend_stack;
         std::vector<std::shared_ptr<Engine::Material>> m_material_stack;
@@ -2,8 +2,6 @@
 
 namespace Engine {
 
-    Color::Color() : r(0), g(0), b(0), a(0) {}
-
     Color::Color(int rgb) :
             r((uint8_t) ((rgb & 0xFF0000) >> 16)),
             g((uint8_t) ((rgb & 0x00FF00) >> 8)),
@@ -1,6 +1,8 @@
 #pragma once
 #include "Shader.h"
 
+// Every term is linear in the texture and vertex colors, so the same shader works for straight
+// and premultiplied alpha (see Texture::setPremultipliedAlpha), only the blend mode changes.
 static const Engine::ShaderData shader_data = {
     // vertex shader
     "#version 330\n"
@@ -37,4 +39,118 @@ static const Engine::ShaderData shader_data = {
     "		v_type.y * color.a * v_col + \n"
     // fill (passed in color)
     "		v_type.z * v_col;\n"
-    "}"};
\ No newline at end of file
+    "}"};
+
+// Same as shader_data, for texture arrays: the layer comes from the 4th component of a_type
+static const Engine::ShaderData array_shader_data = {
+    // vertex shader
+    "#version 330\n"
+    "uniform mat4 u_matrix;\n"
+    "layout(location=0) in vec2 a_position;\n"
+    "layout(location=1) in vec2 a_tex;\n"
+    "layout(location=2) in vec4 a_color;\n"
+    "layout(location=3) in vec4 a_type;\n"
+    "out vec3 v_tex;\n"
+    "out vec4 v_col;\n"
+    "out vec4 v_type;\n"
+    "void main(void)\n"
+    "{\n"
+    "	gl_Position = u_matrix * vec4(a_position.xy, 0, 1);\n"
+    "	v_tex = vec3(a_tex, floor(a_type.w * 255.0 + 0.5));\n"
+    "	v_col = a_color;\n"
+    "	v_type = a_type;\n"
+    "}",
+
+    // fragment shader
+    "#version 330\n"
+    "uniform sampler2DArray u_texture;\n"
+    "in vec3 v_tex;\n"
+    "in vec4 v_col;\n"
+    "in vec4 v_type;\n"
+    "out vec4 o_color;\n"
+    "void main(void)\n"
+    "{\n"
+    "	vec4 color = texture(u_texture, v_tex);\n"
+    "	o_color = \n"
+    "		v_type.x * color * v_col + \n"
+    "		v_type.y * color.a * v_col + \n"
+    "		v_type.z * v_col;\n"
+    "}"};
+
+// Presenter's sharp bilinear upscale: texels are flat in their center and blended over roughly one output pixel at
+// their edges, so non integer scales look even without the blur of plain bilinear filtering.
+// Needs a linear sampler. u_scale is the number of output pixels per texel.
+static const Engine::ShaderData sharp_bilinear_shader_data = {
+    // vertex shader
+    "#version 330\n"
+    "layout(location=0) in vec2 a_position;\n"
+    "out vec2 v_tex;\n"
+    "void main(void)\n"
+    "{\n"
+    "	gl_Position = vec4(a_position, 0, 1);\n"
+    "	v_tex = a_position * 0.5 + 0.5;\n"
+    "}",
+
+    // fragment shader
+    "#version 330\n"
+    "uniform sampler2D u_texture;\n"
+    "uniform vec2 u_size;\n"
+    "uniform vec2 u_scale;\n"
+    "in vec2 v_tex;\n"
+    "out vec4 o_color;\n"
+    "void main(void)\n"
+    "{\n"
+    "	vec2 texel = v_tex * u_size;\n"
+    "	vec2 center = fract(texel) - 0.5;\n"
+    "	vec2 inner = 0.5 - 0.5 / u_scale;\n"
+    "	vec2 offset = (center - clamp(center, -inner, inner)) * u_scale + 0.5;\n"
+    "	o_color = texture(u_texture, (floor(texel) + offset) / u_size);\n"
+    "}"};
+
+// Batch text with distance field fonts (Font::Mode::DistanceField), the texture alpha is the distance to the
+// glyph outline (0.5 on it). Needs a linear sampler. The default material draws plain text, for outlines and glows
+// push a Material with this shader and set:
+//   u_outline_width  how far out the outline reaches, in field units (0 - 0.5, 0.5 is Font::DISTANCE_FIELD_PADDING)
+//   u_outline_color  premultiplied when the premultiplied alpha pipeline is enabled
+//   u_softness       blurs the outer edge of the outline, a wide soft outline is a glow
+static const Engine::ShaderData distance_field_shader_data = {
+    // vertex shader (same as shader_data)
+    "#version 330\n"
+    "uniform mat4 u_matrix;\n"
+    "layout(location=0) in vec2 a_position;\n"
+    "layout(location=1) in vec2 a_tex;\n"
+    "layout(location=2) in vec4 a_color;\n"
+    "layout(location=3) in vec4 a_type;\n"
+    "out vec2 v_tex;\n"
+    "out vec4 v_col;\n"
+    "out vec4 v_type;\n"
+    "void main(void)\n"
+    "{\n"
+    "	gl_Position = u_matrix * vec4(a_position.xy, 0, 1);\n"
+    "	v_tex = a_tex;\n"
+    "	v_col = a_color;\n"
+    "	v_type = a_type;\n"
+    "}",
+
+    // fragment shader
+    "#version 330\n"
+    "uniform sampler2D u_texture;\n"
+    "uniform float u_outline_width;\n"
+    "uniform vec4 u_outline_color;\n"
+    "uniform float u_softness;\n"
+    "in vec2 v_tex;\n"
+    "in vec4 v_col;\n"
+    "in vec4 v_type;\n"
+    "out vec4 o_color;\n"
+    "void main(void)\n"
+    "{\n"
+    "	float distance = texture(u_texture, v_tex).a;\n"
+    // about one output pixel of antialiasing at any scale
+    "	float edge = max(fwidth(distance) * 0.5, 0.001);\n"
+    "	float fill = smoothstep(0.5 - edge, 0.5 + edge, distance);\n"
+    "	float outer = 0.5 - u_outline_width;\n"
+    "	float outline = smoothstep(outer - edge - u_softness, outer + edge, distance);\n"
+    "	vec4 color = v_col * fill + u_outline_color * max(outline - fill, 0.0);\n"
+    // multiply and wash draw the glyph in the vertex color, fill draws the whole quad
+    "	o_color = (v_type.x + v_type.y) * color + v_type.z * v_col;\n"
+    "}"};
@@ -32,16 +32,12 @@ namespace Engine
 
         [[nodiscard]] int width() const override
         {
-            int width, height;
-            SDL_GL_GetDrawableSize(Application::get().window, &width, &height);
-            return width;
+            return Application::get().width();
         }
 
         [[nodiscard]] int height() const override
         {
-            int width, height;
-            SDL_GL_GetDrawableSize(Application::get().window, &width, &height);
-            return height;
+            return Application::get().height();
         }
     };
 }
@@ -53,7 +49,9 @@ Engine::FrameBuffer::FrameBuffer(int width, int height, const Engine::TextureFor
     this->mWidth = width;
     this->mHeight = height;
 
-    glBindFramebuffer(GL_FRAMEBUFFER, id);
+    bool headless = Application::isHeadless();
+    if (!headless)
+        glBindFramebuffer(GL_FRAMEBUFFER, id);
 
     for (int i = 0; i < attachmentCount; i++)
     {
@@ -61,6 +59,9 @@ Engine::FrameBuffer::FrameBuffer(int width, int height, const Engine::TextureFor
         tex->framebufferParent = true;
         mAttachments.push_back(tex);
 
+        if (headless)
+            continue;
+
         if (textureFormats[i] != TextureFormat::DepthStencil)
         {
             glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + i, GL_TEXTURE_2D, tex->getId(), 0);
@@ -110,8 +111,9 @@ Engine::FrameBuffer::create(int width, int height, const TextureFormat *textureF
     ENGINE_ASSERT(depthCount <= 1, "FrameBuffer can only have 1 Depth/Stencil Texture");
     ENGINE_ASSERT(colorCount <= MAX_ATTACHMENTS - 1, "Exceeded maximum Color textureFormat count");
 
-    GLuint id;
-    glGenFramebuffers(1, &id);
+    GLuint id = 0;
+    if (!Application::isHeadless())
+        glGenFramebuffers(1, &id);
 
     auto *frameBuffer = new Engine::FrameBuffer(width, height, textureFormat, textureCount, id);
     return std::shared_ptr<Engine::FrameBuffer>{frameBuffer};
@@ -153,6 +155,8 @@ int Engine::FrameBuffer::height() const
 
 void Engine::FrameBuffer::clear() const
 {
+    if (Application::isHeadless())
+        return;
     glBindFramebuffer(GL_FRAMEBUFFER, id);
     glDisable(GL_SCISSOR_TEST);
     glClearColor(0.0f / 255.0f, 0.0f / 255.0f, 0.0f / 255.0f, 255.0f / 255.0f);
@@ -161,13 +165,22 @@ void Engine::FrameBuffer::clear() const
 
 void Engine::FrameBuffer::clear(Engine::Color color) const
 {
+    if (Application::isHeadless())
+        return;
     glBindFramebuffer(GL_FRAMEBUFFER, id);
     glDisable(GL_SCISSOR_TEST);
     glClearColor(color.r / 255.0f, color.g / 255.0f, color.b / 255.0f, color.a / 255.0f);
     glClear(GL_COLOR_BUFFER_BIT);
 }
 
+GLuint Engine::FrameBuffer::getId() const
+{
+    return id;
+}
+
 void Engine::FrameBuffer::bind() const
 {
+    if (Application::isHeadless())
+        return;
     glBindFramebuffer(GL_FRAMEBUFFER, id);
 }
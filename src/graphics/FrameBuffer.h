@@ -60,6 +60,9 @@ namespace Engine {
         // Gets the height of the FrameBuffer
         [[nodiscard]] virtual int height() const;
 
+        // GL name of the framebuffer object, 0 for the BackBuffer
+        [[nodiscard]] GLuint getId() const;
+
         void bind() const;
 
         // Clears the FrameBuffer
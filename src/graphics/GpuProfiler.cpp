@@ -0,0 +1,202 @@
+#include "GpuProfiler.h"
+#include "Profiler.h"
+#include "imgui.h"
+#include "Application.h"
+
+namespace Engine
+{
+    namespace
+    {
+        struct Pass
+        {
+            GpuProfiler::PassStats stats;
+            GLuint query = 0;
+            uint64_t cpuStart = 0;
+        };
+
+        struct FrameSlot
+        {
+            std::vector<Pass> passes;
+            // number of passes issued this frame, passes[] is only ever grown so query objects get re-used
+            size_t count = 0;
+        };
+
+        FrameSlot slots[GpuProfiler::FRAME_LATENCY];
+        uint64_t currentFrame = 0;
+        // depth of nested begin/end calls, only the outermost one issues a query
+        int depth = 0;
+        std::vector<GpuProfiler::PassStats> latest;
+
+        FrameSlot &currentSlot()
+        {
+            return slots[currentFrame % GpuProfiler::FRAME_LATENCY];
+        }
+
+        Pass *currentPass()
+        {
+            auto &slot = currentSlot();
+            if (depth == 0 || slot.count == 0)
+                return nullptr;
+            return &slot.passes[slot.count - 1];
+        }
+    }
+
+    void GpuProfiler::beginPass(const char *name)
+    {
+        if (Application::isHeadless())
+            return;
+        if (depth++ > 0)
+            return;
+
+        auto &slot = currentSlot();
+        if (slot.count == slot.passes.size())
+            slot.passes.emplace_back();
+
+        auto &pass = slot.passes[slot.count++];
+        if (pass.query == 0)
+            glGenQueries(1, &pass.query);
+
+        pass.stats = PassStats();
+        pass.stats.name = name;
+        pass.cpuStart = Profiler::now();
+        glBeginQuery(GL_TIME_ELAPSED, pass.query);
+    }
+
+    void GpuProfiler::endPass()
+    {
+        if (depth == 0 || --depth > 0)
+            return;
+
+        glEndQuery(GL_TIME_ELAPSED);
+        auto &slot = currentSlot();
+        auto &pass = slot.passes[slot.count - 1];
+        pass.stats.cpuMillis = (Profiler::now() - pass.cpuStart) / 1000000.0f;
+    }
+
+    void GpuProfiler::countDraw(int64_t vertices)
+    {
+        if (auto *pass = currentPass())
+        {
+            pass->stats.drawCalls++;
+            pass->stats.vertices += vertices;
+        }
+    }
+
+    void GpuProfiler::countTextureBind()
+    {
+        if (auto *pass = currentPass())
+            pass->stats.textureBinds++;
+    }
+
+    void GpuProfiler::frame()
+    {
+        // a pass left open would bleed into the next frame
+        while (depth > 0)
+            endPass();
+
+        currentFrame++;
+
+        // this slot was submitted FRAME_LATENCY - 1 frames ago, by now its results should be ready.
+        // If the GPU is even further behind we drop the frame instead of waiting for it.
+        auto &slot = currentSlot();
+        bool available = slot.count > 0;
+        for (size_t i = 0; i < slot.count && available; i++)
+        {
+            GLint ready = 0;
+            glGetQueryObjectiv(slot.passes[i].query, GL_QUERY_RESULT_AVAILABLE, &ready);
+            available = ready != 0;
+        }
+
+        if (available)
+        {
+            latest.clear();
+            for (size_t i = 0; i < slot.count; i++)
+            {
+                auto &pass = slot.passes[i];
+                GLuint64 nanoseconds = 0;
+                glGetQueryObjectui64v(pass.query, GL_QUERY_RESULT, &nanoseconds);
+                pass.stats.gpuMillis = nanoseconds / 1000000.0f;
+                latest.push_back(pass.stats);
+            }
+        }
+        slot.count = 0;
+    }
+
+    const std::vector<GpuProfiler::PassStats> &GpuProfiler::results()
+    {
+        return latest;
+    }
+
+    void GpuProfiler::drawImGui()
+    {
+        // Appends to the CPU profiler window
+        ImGui::Begin("Profiler");
+        if (ImGui::BeginTable("gpu passes", 6, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+        {
+            ImGui::TableSetupColumn("Pass");
+            ImGui::TableSetupColumn("GPU ms");
+            ImGui::TableSetupColumn("CPU ms");
+            ImGui::TableSetupColumn("Draws");
+            ImGui::TableSetupColumn("Vertices");
+            ImGui::TableSetupColumn("Binds");
+            ImGui::TableHeadersRow();
+
+            PassStats total;
+            for (auto &pass : latest)
+            {
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::Text("%s", pass.name.c_str());
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", pass.gpuMillis);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", pass.cpuMillis);
+                ImGui::TableNextColumn();
+                ImGui::Text("%u", pass.drawCalls);
+                ImGui::TableNextColumn();
+                ImGui::Text("%llu", (unsigned long long)pass.vertices);
+                ImGui::TableNextColumn();
+                ImGui::Text("%u", pass.textureBinds);
+
+                total.gpuMillis += pass.gpuMillis;
+                total.cpuMillis += pass.cpuMillis;
+                total.drawCalls += pass.drawCalls;
+                total.vertices += pass.vertices;
+                total.textureBinds += pass.textureBinds;
+            }
+
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("Total");
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", total.gpuMillis);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", total.cpuMillis);
+            ImGui::TableNextColumn();
+            ImGui::Text("%u", total.drawCalls);
+            ImGui::TableNextColumn();
+            ImGui::Text("%llu", (unsigned long long)total.vertices);
+            ImGui::TableNextColumn();
+            ImGui::Text("%u", total.textureBinds);
+
+            ImGui::EndTable();
+        }
+        ImGui::End();
+    }
+
+    void GpuProfiler::shutdown()
+    {
+        for (auto &slot : slots)
+        {
+            for (auto &pass : slot.passes)
+            {
+                if (pass.query != 0)
+                    glDeleteQueries(1, &pass.query);
+            }
+            slot.passes.clear();
+            slot.count = 0;
+        }
+        latest.clear();
+        depth = 0;
+    }
+}
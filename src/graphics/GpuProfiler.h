@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <glad/glad.h>
+#include "Profiler.h"
+
+// Like the CPU profiler, GPU passes and counters are only recorded when built with ENGINE_PROFILE.
+#ifdef ENGINE_PROFILE
+#define ENGINE_GPU_PROFILE_SCOPE(name) ::Engine::GpuProfiler::Scope ENGINE_PROFILE_CONCAT(gpuProfileScope, __LINE__){name}
+#define ENGINE_GPU_PROFILE_DRAW(vertices) ::Engine::GpuProfiler::countDraw(vertices)
+#define ENGINE_GPU_PROFILE_TEXTURE_BIND() ::Engine::GpuProfiler::countTextureBind()
+#else
+#define ENGINE_GPU_PROFILE_SCOPE(name)
+#define ENGINE_GPU_PROFILE_DRAW(vertices)
+#define ENGINE_GPU_PROFILE_TEXTURE_BIND()
+#endif
+
+namespace Engine
+{
+    // Measures GPU time per named pass with GL_TIME_ELAPSED queries.
+    // Query results are read FRAME_LATENCY frames after being issued so reading them never stalls the pipeline.
+    // Timer queries can't be nested: a pass opened while another one is running is merged into the outer pass.
+    class GpuProfiler
+    {
+    public:
+        static constexpr int FRAME_LATENCY = 4;
+
+        struct PassStats
+        {
+            std::string name;
+            float gpuMillis = 0.0f;
+            float cpuMillis = 0.0f;
+            uint32_t drawCalls = 0;
+            uint64_t vertices = 0;
+            uint32_t textureBinds = 0;
+        };
+
+        class Scope
+        {
+        public:
+            explicit Scope(const char *name) { beginPass(name); }
+            ~Scope() { endPass(); }
+
+            Scope(const Scope &) = delete;
+            Scope &operator=(const Scope &) = delete;
+        };
+
+        static void beginPass(const char *name);
+        static void endPass();
+
+        // Attributes a draw call / texture bind to the pass currently open (if any)
+        static void countDraw(int64_t vertices);
+        static void countTextureBind();
+
+        // Must be called once per frame, after the frame was submitted. Collects the results that are ready.
+        static void frame();
+
+        // Passes of the most recent frame whose results are available
+        static const std::vector<PassStats> &results();
+
+        // Adds a per-pass table to the profiler window
+        static void drawImGui();
+
+        // Deletes the query objects (needs the GL context)
+        static void shutdown();
+
+    private:
+        GpuProfiler() = default;
+    };
+}
@@ -38,7 +38,7 @@ int calc_uniform_size(const UniformInfo &uniform)
         components = 16;
         break;
     default:
-        ENGINE_CORE_ERROR("Unexpected Uniform Type");
+        ENGINE_LOG_ERROR(Graphics, "Unexpected Uniform Type");
         break;
     }
 
@@ -120,7 +120,7 @@ void Engine::Material::setTexture(const char *name, const std::shared_ptr<Textur
             break;
     }
 
-    ENGINE_CORE_WARN("No texture unform {} at index {} exists", name, arrayIndex);
+    ENGINE_LOG_WARN(Graphics, "No texture unform {} at index {} exists", name, arrayIndex);
 }
 
 void Material::setTexture(int slot, const std::shared_ptr<Texture> &texture, int index)
@@ -166,7 +166,7 @@ std::shared_ptr<Texture> Material::getTexture(const char *name, int index) const
             break;
     }
 
-    ENGINE_CORE_ERROR("No Texture Uniform {} at index {} exists", name, index);
+    ENGINE_LOG_ERROR(Graphics, "No Texture Uniform {} at index {} exists", name, index);
     return std::shared_ptr<Texture>();
 }
 
@@ -195,7 +195,7 @@ void Material::setUniform(const char *name, const float *value, int64_t length)
             auto max = calc_uniform_size(uniform);
             if (length > max)
             {
-                ENGINE_CORE_WARN("Exceeding length of Uniform '%s' (%i / %i)", name, length, max);
+                ENGINE_LOG_WARN(Graphics, "Exceeding length of Uniform '%s' (%i / %i)", name, length, max);
                 length = max;
             }
 
@@ -207,7 +207,7 @@ void Material::setUniform(const char *name, const float *value, int64_t length)
         index++;
     }
 
-    ENGINE_CORE_WARN("No Uniform {} exists", name);
+    ENGINE_LOG_WARN(Graphics, "No Uniform {} exists", name);
 }
 
 const float *Material::getValue(const char *name, int64_t *length) const
@@ -235,7 +235,7 @@ const float *Material::getValue(const char *name, int64_t *length) const
     }
 
     *length = 0;
-    ENGINE_CORE_WARN("Could not get Uniform, '%s' does not exists", name);
+    ENGINE_LOG_WARN(Graphics, "Could not get Uniform, '%s' does not exists", name);
     return nullptr;
 }
 
@@ -275,7 +275,7 @@ void Material::setSampler(const char *name, const TextureSampler &sampler, int i
             break;
     }
 
-    ENGINE_CORE_WARN("No Sampler Uniform '%s' at index [%i] exists", name, index);
+    ENGINE_LOG_WARN(Graphics, "No Sampler Uniform '%s' at index [%i] exists", name, index);
 }
 
 void Material::setSampler(int slot, const TextureSampler &sampler, int index)
@@ -321,7 +321,7 @@ TextureSampler Material::getSampler(const char *name, int index) const
             break;
     }
 
-    ENGINE_CORE_WARN("No Sampler Uniform '%s' at index [%i] exists", name, index);
+    ENGINE_LOG_WARN(Graphics, "No Sampler Uniform '%s' at index [%i] exists", name, index);
     return TextureSampler();
 }
 
@@ -351,7 +351,7 @@ TextureSampler Material::getSampler(int slot, int index) const
         s++;
     }
 
-    ENGINE_CORE_WARN("No Sampler Uniform {} at index {} exists", slot, index);
+    ENGINE_LOG_WARN(Graphics, "No Sampler Uniform {} at index {} exists", slot, index);
     return TextureSampler();
 }
 
@@ -391,6 +391,6 @@ std::shared_ptr<Texture> Material::getTexture(int slot, int index) const
         s++;
     }
 
-    ENGINE_CORE_WARN("No Texture Uniform [{}] at index [{}] exists", slot, index);
+    ENGINE_LOG_WARN(Graphics, "No Texture Uniform [{}] at index [{}] exists", slot, index);
     return std::shared_ptr<Texture>();
 };
\ No newline at end of file
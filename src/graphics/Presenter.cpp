@@ -0,0 +1,146 @@
+#include "Presenter.h"
+#include "Application.h"
+#include "DefaultShader.h"
+#include "Profiler.h"
+#include "GpuProfiler.h"
+#include "renderpass.h"
+#include "ShaderCache.h"
+#include <algorithm>
+#include <cmath>
+#include <glad/glad.h>
+
+namespace Engine
+{
+    namespace
+    {
+        // Opaque copy, the source alpha doesn't leak the letterbox color into the picture
+        const BlendMode Replace = BlendMode(BlendOp::Add, BlendFactor::One, BlendFactor::Zero);
+
+        const VertexFormat quadFormat = VertexFormat({{0, VertexType::Float2, false}});
+    }
+
+    void Presenter::setSource(const std::shared_ptr<FrameBuffer> &frameBuffer)
+    {
+        if (frameBuffer != mSource)
+            mDirty = true;
+        mSource = frameBuffer;
+    }
+
+    const std::shared_ptr<FrameBuffer> &Presenter::getSource() const
+    {
+        return mSource;
+    }
+
+    void Presenter::invalidate()
+    {
+        mDirty = true;
+    }
+
+    bool Presenter::needsPresent(int windowWidth, int windowHeight) const
+    {
+        return !onDemand || mDirty || windowWidth != mPresentedWidth || windowHeight != mPresentedHeight;
+    }
+
+    void Presenter::updateViewport(int targetWidth, int targetHeight)
+    {
+        int width = mSource->width();
+        int height = mSource->height();
+
+        float scale = std::min(targetWidth / (float)width, targetHeight / (float)height);
+        if (scaling == Scaling::Integer && scale >= 1.0f)
+            scale = std::floor(scale);
+
+        float scaledWidth = std::round(width * scale);
+        float scaledHeight = std::round(height * scale);
+        mViewport = Rect(std::floor((targetWidth - scaledWidth) * 0.5f), std::floor((targetHeight - scaledHeight) * 0.5f),
+                         scaledWidth, scaledHeight);
+    }
+
+    void Presenter::present(const std::shared_ptr<FrameBuffer> &target)
+    {
+        mDirty = false;
+        mPresentedWidth = target->width();
+        mPresentedHeight = target->height();
+        if (!mSource || Application::isHeadless())
+            return;
+
+        ENGINE_PROFILE_SCOPE("Presenter::present");
+        ENGINE_GPU_PROFILE_SCOPE("Present");
+
+        updateViewport(target->width(), target->height());
+        if (mViewport.w <= 0 || mViewport.h <= 0)
+            return;
+
+        // only the letterbox bars need clearing, the picture is drawn over the rest
+        if (mViewport.w < target->width() || mViewport.h < target->height())
+            target->clear(letterbox);
+
+        int width = mSource->width();
+        int height = mSource->height();
+        // GL viewports start at the bottom left
+        int x0 = (int)mViewport.x;
+        int y0 = target->height() - (int)(mViewport.y + mViewport.h);
+        int x1 = x0 + (int)mViewport.w;
+        int y1 = y0 + (int)mViewport.h;
+
+        bool wholeScale = (int)mViewport.w % width == 0 && (int)mViewport.h % height == 0;
+        if (!sharpBilinear || wholeScale)
+        {
+            // both FrameBuffer contents and the window are stored bottom up, no flip needed
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, mSource->getId());
+            glBindFramebuffer(GL_DRAW_FRAMEBUFFER, target->getId());
+            glDisable(GL_SCISSOR_TEST);
+            glBlitFramebuffer(0, 0, width, height, x0, y0, x1, y1, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+            return;
+        }
+
+        if (!mMaterial)
+        {
+            static const float vertices[] = {-1.0f, -1.0f, 1.0f, -1.0f, 1.0f, 1.0f, -1.0f, 1.0f};
+            static const uint16_t indices[] = {0, 1, 2, 0, 2, 3};
+            mMesh = std::shared_ptr<Mesh>{new Mesh()};
+            mMesh->vertex_data(quadFormat, vertices, 4);
+            mMesh->index_data(IndexFormat::UInt16, indices, 6);
+            mMaterial = std::shared_ptr<Material>(new Material(ShaderCache::get(sharp_bilinear_shader_data)));
+        }
+
+        float size[] = {(float)width, (float)height};
+        float scale[] = {mViewport.w / width, mViewport.h / height};
+        mMaterial->setTexture("u_texture", mSource->attachment(0));
+        mMaterial->setSampler("u_texture", TextureSampler(TextureFilter::Linear, TextureWrap::Clamp, TextureWrap::Clamp));
+        mMaterial->setUniform("u_size", size, 2);
+        mMaterial->setUniform("u_scale", scale, 2);
+
+        RenderPass pass;
+        pass.target = target;
+        pass.mesh = mMesh;
+        pass.material = mMaterial;
+        pass.blend = Replace;
+        pass.has_viewport = true;
+        pass.viewport = Rect((float)x0, (float)y0, mViewport.w, mViewport.h);
+        pass.index_start = 0;
+        pass.index_count = 6;
+        pass.perform();
+    }
+
+    const Rect &Presenter::getViewport() const
+    {
+        return mViewport;
+    }
+
+    glm::vec2 Presenter::toSource(const glm::vec2 &position) const
+    {
+        if (!mSource || mViewport.w <= 0 || mViewport.h <= 0)
+            return position;
+        return {(position.x - mViewport.x) * mSource->width() / mViewport.w,
+                (position.y - mViewport.y) * mSource->height() / mViewport.h};
+    }
+
+    void Presenter::dispose()
+    {
+        mMaterial.reset();
+        mMesh.reset();
+        mSource.reset();
+    }
+}
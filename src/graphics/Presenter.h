@@ -0,0 +1,79 @@
+#pragma once
+
+#include <memory>
+#include <glm/glm.hpp>
+#include "Color.h"
+#include "FrameBuffer.h"
+#include "Material.h"
+#include "mesh.h"
+#include "rect.h"
+
+namespace Engine
+{
+    // Presents a low resolution FrameBuffer on the window, owned by the Application (Application::presenter()).
+    // The source is scaled by whole pixels when possible and centered, the rest of the window is letterboxed.
+    // Without a shader the copy is a single glBlitFramebuffer, with sharpBilinear it's one fullscreen quad.
+    class Presenter
+    {
+    public:
+        enum class Scaling
+        {
+            // Largest whole scale that fits the window (falls back to Fit if the window is smaller than the source)
+            Integer,
+            // Largest scale that fits the window while keeping the aspect ratio
+            Fit
+        };
+
+        Scaling scaling = Scaling::Integer;
+
+        // Fit scaling with nearest filtering makes some pixels wider than others, sharp bilinear only blends
+        // the pixel edges so they all look the same size. No effect on whole scales.
+        bool sharpBilinear = false;
+
+        Color letterbox = Color(0, 0, 0, 255);
+
+        // When set, frames are only presented after invalidate() (or a window resize / ImGui window).
+        // Frames that aren't presented skip the swap too, the window keeps showing the previous one.
+        bool onDemand = false;
+
+        Presenter() = default;
+
+        Presenter(const Presenter &) = delete;
+
+        Presenter &operator=(const Presenter &) = delete;
+
+        // The FrameBuffer to present, nullptr if the game draws straight to the BackBuffer
+        void setSource(const std::shared_ptr<FrameBuffer> &frameBuffer);
+
+        [[nodiscard]] const std::shared_ptr<FrameBuffer> &getSource() const;
+
+        // Marks the source as changed, it will be presented on the next frame
+        void invalidate();
+
+        // True if the next frame has to be presented
+        [[nodiscard]] bool needsPresent(int windowWidth, int windowHeight) const;
+
+        // Draws the source to `target`, the Application presents to the BackBuffer before drawing ImGui
+        void present(const std::shared_ptr<FrameBuffer> &target);
+
+        // Where the source was last drawn, in target pixels (origin at the top left)
+        [[nodiscard]] const Rect &getViewport() const;
+
+        // Converts a position in target pixels (ex. the mouse, scaled to drawable pixels on high DPI displays) to source pixels
+        [[nodiscard]] glm::vec2 toSource(const glm::vec2 &position) const;
+
+        // Releases the GL objects of the sharp bilinear path (needs the GL context)
+        void dispose();
+
+    private:
+        std::shared_ptr<FrameBuffer> mSource;
+        std::shared_ptr<Mesh> mMesh;
+        std::shared_ptr<Material> mMaterial;
+        Rect mViewport;
+        bool mDirty = true;
+        int mPresentedWidth = 0;
+        int mPresentedHeight = 0;
+
+        void updateViewport(int targetWidth, int targetHeight);
+    };
+}
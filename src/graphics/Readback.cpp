@@ -0,0 +1,352 @@
+#include "Readback.h"
+#include "Application.h"
+#include "ImageWriter.h"
+#include "Log.h"
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <glad/glad.h>
+
+namespace Engine
+{
+    namespace
+    {
+        // Waiting on a fence is split in slices so a lost context doesn't hang the application
+        constexpr GLuint64 WAIT_SLICE_NANOSECONDS = 100000000;
+
+        typedef std::function<void(Readback::Image &&)> Callback;
+
+        struct Buffer
+        {
+            GLuint id = 0;
+            size_t capacity = 0;
+        };
+
+        struct Request
+        {
+            Buffer buffer;
+            GLsync fence = nullptr;
+            int width = 0;
+            int height = 0;
+            bool flip = false;
+            uint64_t frame = 0;
+            Callback resolve;
+        };
+
+        std::vector<Buffer> freeBuffers;
+        std::vector<Request> pending;
+        uint64_t currentFrame = 0;
+        // textures are attached to this framebuffer to be read
+        GLuint attachmentFrameBuffer = 0;
+
+        // Encoder thread, started with the first capture
+        std::thread worker;
+        std::mutex workerMutex;
+        std::condition_variable workerWake;
+        std::deque<std::function<void()>> jobs;
+        bool stopping = false;
+
+        void runWorker()
+        {
+            while (true)
+            {
+                std::function<void()> job;
+                {
+                    std::unique_lock<std::mutex> lock{workerMutex};
+                    workerWake.wait(lock, [] { return stopping || !jobs.empty(); });
+                    if (jobs.empty())
+                        return;
+                    job = std::move(jobs.front());
+                    jobs.pop_front();
+                }
+                job();
+            }
+        }
+
+        void post(std::function<void()> job)
+        {
+            {
+                std::lock_guard<std::mutex> lock{workerMutex};
+                if (!worker.joinable())
+                    worker = std::thread(runWorker);
+                jobs.push_back(std::move(job));
+            }
+            workerWake.notify_one();
+        }
+
+        // Binds a pixel pack buffer of at least `size` bytes
+        Buffer acquireBuffer(size_t size)
+        {
+            // a free buffer that fits, otherwise the last one is grown. Reads are usually the same size every frame.
+            int index = freeBuffers.empty() ? -1 : (int)freeBuffers.size() - 1;
+            for (int i = 0; i < (int)freeBuffers.size(); i++)
+            {
+                if (freeBuffers[i].capacity >= size)
+                {
+                    index = i;
+                    break;
+                }
+            }
+
+            Buffer buffer;
+            if (index >= 0)
+            {
+                buffer = freeBuffers[index];
+                freeBuffers.erase(freeBuffers.begin() + index);
+            }
+            else
+            {
+                glGenBuffers(1, &buffer.id);
+            }
+
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer.id);
+            if (buffer.capacity < size)
+            {
+                glBufferData(GL_PIXEL_PACK_BUFFER, (GLsizeiptr)size, nullptr, GL_STREAM_READ);
+                buffer.capacity = size;
+            }
+            return buffer;
+        }
+
+        void release(Request &request, Readback::Image &&image)
+        {
+            glDeleteSync(request.fence);
+            freeBuffers.push_back(request.buffer);
+            request.resolve(std::move(image));
+        }
+
+        void resolve(Request &request)
+        {
+            Readback::Image image;
+            image.width = request.width;
+            image.height = request.height;
+            image.pixels.resize((size_t)request.width * request.height);
+
+            size_t rowSize = (size_t)request.width * sizeof(Color);
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, request.buffer.id);
+            auto *data = (const unsigned char *)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0,
+                                                                 (GLsizeiptr)(rowSize * request.height), GL_MAP_READ_BIT);
+            if (data)
+            {
+                // GL returns the bottom row first
+                for (int y = 0; y < request.height; y++)
+                {
+                    int row = request.flip ? request.height - 1 - y : y;
+                    memcpy((void *)(image.pixels.data() + (size_t)y * request.width), data + row * rowSize, rowSize);
+                }
+                glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+            }
+            else
+            {
+                ENGINE_LOG_ERROR(Graphics, "Failed to map a readback buffer");
+                image = Readback::Image();
+            }
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+            release(request, std::move(image));
+        }
+
+        bool wait(GLsync fence)
+        {
+            while (true)
+            {
+                GLenum status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, WAIT_SLICE_NANOSECONDS);
+                if (status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED)
+                    return true;
+                if (status == GL_WAIT_FAILED)
+                    return false;
+            }
+        }
+
+        // Reads the framebuffer bound to GL_READ_FRAMEBUFFER into a pixel pack buffer
+        void issue(int width, int height, bool flip, Callback callback)
+        {
+            Request request;
+            request.buffer = acquireBuffer((size_t)width * height * sizeof(Color));
+            request.width = width;
+            request.height = height;
+            request.flip = flip;
+            request.frame = currentFrame;
+            request.resolve = std::move(callback);
+
+            glPixelStorei(GL_PACK_ALIGNMENT, 1);
+            // with a pixel pack buffer bound the last argument is an offset into it, the call doesn't wait for the GPU
+            glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+            request.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            pending.push_back(std::move(request));
+        }
+
+        void readTexture(const std::shared_ptr<Texture> &texture, bool flip, Callback callback)
+        {
+            if (!texture || texture->getId() == 0)
+            {
+                callback(Readback::Image());
+                return;
+            }
+            auto format = texture->getFormat();
+            if (format == TextureFormat::DepthStencil || Texture::isCompressed(format) || texture->isArray())
+            {
+                ENGINE_LOG_ERROR(Graphics, "Only color textures can be read back");
+                callback(Readback::Image());
+                return;
+            }
+
+            GLint previous = 0;
+            glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &previous);
+            if (attachmentFrameBuffer == 0)
+                glGenFramebuffers(1, &attachmentFrameBuffer);
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, attachmentFrameBuffer);
+            glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture->getId(), 0);
+            glReadBuffer(GL_COLOR_ATTACHMENT0);
+
+            issue(texture->getWidth(), texture->getHeight(), flip, std::move(callback));
+
+            glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, 0, 0);
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, previous);
+        }
+
+        void readFrameBuffer(const std::shared_ptr<FrameBuffer> &frameBuffer, int attachment, Callback callback)
+        {
+            if (Application::isHeadless() || !frameBuffer)
+            {
+                callback(Readback::Image());
+                return;
+            }
+
+            if (frameBuffer != FrameBuffer::BackBuffer())
+            {
+                ENGINE_ASSERT(attachment >= 0 && attachment < (int)frameBuffer->attachments().size(),
+                              "Invalid FrameBuffer attachment");
+                readTexture(frameBuffer->attachment(attachment), true, std::move(callback));
+                return;
+            }
+
+            GLint previous = 0;
+            glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &previous);
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+            glReadBuffer(GL_BACK);
+            issue(frameBuffer->width(), frameBuffer->height(), true, std::move(callback));
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, previous);
+        }
+    }
+
+    std::future<Readback::Image> Readback::read(const std::shared_ptr<Texture> &texture)
+    {
+        auto promise = std::make_shared<std::promise<Image>>();
+        auto future = promise->get_future();
+        Callback callback = [promise](Image &&image) { promise->set_value(std::move(image)); };
+        if (Application::isHeadless())
+            callback(Image());
+        else
+            readTexture(texture, texture && texture->isFramebuffer(), std::move(callback));
+        return future;
+    }
+
+    std::future<Readback::Image> Readback::read(const std::shared_ptr<FrameBuffer> &frameBuffer, int attachment)
+    {
+        auto promise = std::make_shared<std::promise<Image>>();
+        auto future = promise->get_future();
+        readFrameBuffer(frameBuffer, attachment, [promise](Image &&image) { promise->set_value(std::move(image)); });
+        return future;
+    }
+
+    std::future<bool> Readback::capture(const std::shared_ptr<FrameBuffer> &frameBuffer, const std::string &path,
+                                        Encoding encoding)
+    {
+        auto promise = std::make_shared<std::promise<bool>>();
+        auto future = promise->get_future();
+        readFrameBuffer(frameBuffer, 0, [promise, path, encoding](Image &&image) {
+            if (image.pixels.empty())
+            {
+                promise->set_value(false);
+                return;
+            }
+            // the GL thread only pays for copying the pixels out of the buffer, encoding happens on the worker
+            auto shared = std::make_shared<Image>(std::move(image));
+            post([promise, path, encoding, shared]() {
+                bool written = encoding == Encoding::PNG
+                                   ? ImageWriter::writePNG(path, shared->width, shared->height, shared->pixels.data())
+                                   : ImageWriter::writeRaw(path, shared->width, shared->height, shared->pixels.data());
+                promise->set_value(written);
+            });
+        });
+        return future;
+    }
+
+    void Readback::frame()
+    {
+        currentFrame++;
+
+        size_t kept = 0;
+        for (size_t i = 0; i < pending.size(); i++)
+        {
+            auto &request = pending[i];
+            bool late = currentFrame - request.frame >= FRAME_LATENCY;
+            bool ready;
+            if (late)
+            {
+                // the GPU is falling behind, waiting is better than piling up buffers
+                ready = wait(request.fence);
+            }
+            else
+            {
+                GLenum status = glClientWaitSync(request.fence, 0, 0);
+                ready = status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED;
+            }
+
+            if (ready)
+            {
+                resolve(request);
+            }
+            else if (late)
+            {
+                ENGINE_LOG_ERROR(Graphics, "Failed to wait for a readback");
+                release(request, Image());
+            }
+            else
+            {
+                if (kept != i)
+                    pending[kept] = std::move(request);
+                kept++;
+            }
+        }
+        pending.resize(kept);
+    }
+
+    void Readback::shutdown()
+    {
+        for (auto &request : pending)
+        {
+            if (wait(request.fence))
+                resolve(request);
+            else
+                release(request, Image());
+        }
+        pending.clear();
+
+        if (worker.joinable())
+        {
+            {
+                std::lock_guard<std::mutex> lock{workerMutex};
+                stopping = true;
+            }
+            workerWake.notify_one();
+            worker.join();
+            stopping = false;
+        }
+
+        for (auto &buffer : freeBuffers)
+            glDeleteBuffers(1, &buffer.id);
+        freeBuffers.clear();
+
+        if (attachmentFrameBuffer != 0)
+        {
+            glDeleteFramebuffers(1, &attachmentFrameBuffer);
+            attachmentFrameBuffer = 0;
+        }
+    }
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Color.h"
+#include "FrameBuffer.h"
+#include "Texture.h"
+
+namespace Engine
+{
+    // Asynchronous pixel readback. Reads are copied into a ring of pixel buffer objects and fenced,
+    // the returned futures resolve a few frames later once the GPU is done, so capturing never stalls the pipeline.
+    // Requests, frame() and shutdown() must all be made from the thread owning the GL context.
+    class Readback
+    {
+    public:
+        // Reads still pending after this many frames are waited on, which bounds the number of buffers in flight
+        static constexpr int FRAME_LATENCY = 3;
+
+        // Pixels are always RGBA8, rows top to bottom
+        struct Image
+        {
+            int width = 0;
+            int height = 0;
+            std::vector<Color> pixels;
+        };
+
+        enum class Encoding
+        {
+            PNG,
+            Raw
+        };
+
+        // Reads the first level of a color texture (R, RG, RGB or RGBA, channels the texture lacks read as 0, alpha as 255).
+        // FrameBuffer attachments are flipped so the first row is the top of what was drawn to them.
+        // Resolves to an empty Image when headless or if the texture can't be read.
+        static std::future<Image> read(const std::shared_ptr<Texture> &texture);
+
+        // Reads a color attachment of `frameBuffer`, or the window if it's the BackBuffer (read before the window is swapped).
+        // The back buffer of a hidden window (--offscreen) is undefined, render to a FrameBuffer to capture offscreen.
+        static std::future<Image> read(const std::shared_ptr<FrameBuffer> &frameBuffer, int attachment = 0);
+
+        // Reads `frameBuffer` like read() and writes it to `path` on a worker thread.
+        // Resolves to false if the read or the write failed.
+        static std::future<bool> capture(const std::shared_ptr<FrameBuffer> &frameBuffer, const std::string &path,
+                                         Encoding encoding = Encoding::PNG);
+
+        // Must be called once per frame, after the frame was submitted. Resolves the reads that are ready.
+        static void frame();
+
+        // Resolves every pending read, waits for the captures being written and deletes the buffers (needs the GL context)
+        static void shutdown();
+
+    private:
+        Readback() = default;
+    };
+}
@@ -0,0 +1,186 @@
+#include "RenderGraph.h"
+#include "GpuProfiler.h"
+#include "Log.h"
+#include "Profiler.h"
+#include <algorithm>
+
+namespace Engine
+{
+    const std::shared_ptr<FrameBuffer> &RenderGraph::Context::target() const
+    {
+        auto &pass = graph->mPasses[this->pass];
+        return graph->mResources[pass.output].frameBuffer;
+    }
+
+    const std::shared_ptr<Texture> &RenderGraph::Context::input(int index) const
+    {
+        auto &pass = graph->mPasses[this->pass];
+        ENGINE_ASSERT(index >= 0 && index < (int)pass.inputs.size(), "Invalid render graph pass input");
+        auto &resource = graph->mResources[pass.inputs[index]];
+        ENGINE_ASSERT(resource.frameBuffer, "Reading a render target no pass has drawn to");
+        ENGINE_ASSERT(resource.frameBuffer != FrameBuffer::BackBuffer(), "The back buffer can't be sampled");
+        return resource.frameBuffer->attachment(0);
+    }
+
+    RenderGraph::Resource RenderGraph::create(int width, int height, TextureFormat format)
+    {
+        ENGINE_ASSERT(width > 0 && height > 0, "Render target width and height must be larger than 0");
+        ENGINE_ASSERT(format != TextureFormat::DepthStencil && !Texture::isCompressed(format),
+                      "Render targets need a color format");
+        ResourceEntry resource;
+        resource.width = width;
+        resource.height = height;
+        resource.format = format;
+        mResources.push_back(resource);
+        return (Resource)mResources.size() - 1;
+    }
+
+    RenderGraph::Resource RenderGraph::import(const std::shared_ptr<FrameBuffer> &frameBuffer)
+    {
+        ENGINE_ASSERT(frameBuffer, "Trying to import an invalid FrameBuffer");
+        ResourceEntry resource;
+        resource.width = frameBuffer->width();
+        resource.height = frameBuffer->height();
+        resource.frameBuffer = frameBuffer;
+        resource.imported = true;
+        mResources.push_back(resource);
+        return (Resource)mResources.size() - 1;
+    }
+
+    void RenderGraph::addPass(const char *name, std::initializer_list<Resource> inputs, Resource output, Execute execute,
+                              Load load)
+    {
+        ENGINE_ASSERT(output >= 0 && output < (int)mResources.size(), "Invalid render graph pass output");
+        for (auto input : inputs)
+        {
+            ENGINE_ASSERT(input >= 0 && input < (int)mResources.size(), "Invalid render graph pass input");
+            ENGINE_ASSERT(input != output, "A pass can't sample the target it draws to");
+        }
+        mPasses.push_back(Pass{name, inputs, output, std::move(execute), load});
+    }
+
+    void RenderGraph::cull()
+    {
+        // Walking backwards, a pass is live if something after it reads its output (or the output is imported).
+        // Passes drawing to a target after its last read are culled with the rest.
+        for (auto &resource : mResources)
+            resource.needed = resource.imported;
+
+        for (int i = (int)mPasses.size() - 1; i >= 0; i--)
+        {
+            auto &pass = mPasses[i];
+            pass.live = mResources[pass.output].needed;
+            if (!pass.live)
+                continue;
+            for (auto input : pass.inputs)
+                mResources[input].needed = true;
+        }
+
+        for (int i = 0; i < (int)mPasses.size(); i++)
+        {
+            auto &pass = mPasses[i];
+            if (!pass.live)
+                continue;
+            auto use = [i](ResourceEntry &resource) {
+                if (resource.firstUse < 0)
+                    resource.firstUse = i;
+                resource.lastUse = i;
+            };
+            use(mResources[pass.output]);
+            for (auto input : pass.inputs)
+                use(mResources[input]);
+        }
+    }
+
+    std::shared_ptr<FrameBuffer> RenderGraph::acquire(const ResourceEntry &resource)
+    {
+        for (auto &target : mPool)
+        {
+            if (!target.inUse && target.format == resource.format &&
+                target.frameBuffer->width() == resource.width && target.frameBuffer->height() == resource.height)
+            {
+                target.inUse = true;
+                target.lastFrame = mFrame;
+                return target.frameBuffer;
+            }
+        }
+
+        PooledTarget target;
+        target.frameBuffer = FrameBuffer::create(resource.width, resource.height, &resource.format, 1);
+        target.format = resource.format;
+        target.inUse = true;
+        target.lastFrame = mFrame;
+        mPool.push_back(target);
+        return target.frameBuffer;
+    }
+
+    void RenderGraph::release(const std::shared_ptr<FrameBuffer> &frameBuffer)
+    {
+        for (auto &target : mPool)
+        {
+            if (target.frameBuffer == frameBuffer)
+                target.inUse = false;
+        }
+    }
+
+    void RenderGraph::execute()
+    {
+        ENGINE_PROFILE_SCOPE("RenderGraph::execute");
+        mFrame++;
+        cull();
+
+        mExecuted = 0;
+        mCulled = 0;
+        Context context;
+        context.graph = this;
+        for (int i = 0; i < (int)mPasses.size(); i++)
+        {
+            auto &pass = mPasses[i];
+            if (!pass.live)
+            {
+                mCulled++;
+                continue;
+            }
+
+            auto &output = mResources[pass.output];
+            if (!output.frameBuffer)
+            {
+                output.frameBuffer = acquire(output);
+                if (pass.load == Load::Clear)
+                    output.frameBuffer->clear(Color(0, 0, 0, 0));
+            }
+
+            {
+                ENGINE_PROFILE_SCOPE(pass.name);
+                ENGINE_GPU_PROFILE_SCOPE(pass.name);
+                context.pass = i;
+                pass.execute(context);
+            }
+            mExecuted++;
+
+            // targets no later pass uses go back to the pool, the next transient target can alias them
+            auto releaseIfDone = [this, i](ResourceEntry &resource) {
+                if (!resource.imported && resource.lastUse == i && resource.frameBuffer)
+                    release(resource.frameBuffer);
+            };
+            releaseIfDone(output);
+            for (auto input : pass.inputs)
+                releaseIfDone(mResources[input]);
+        }
+
+        mPasses.clear();
+        mResources.clear();
+
+        mPool.erase(std::remove_if(mPool.begin(), mPool.end(), [this](const PooledTarget &target) {
+                        return mFrame - target.lastFrame > POOL_FRAMES;
+                    }),
+                    mPool.end());
+    }
+
+    void RenderGraph::dispose()
+    {
+        mPasses.clear();
+        mResources.clear();
+        mPool.clear();
+    }
+}
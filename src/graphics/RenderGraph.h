@@ -0,0 +1,131 @@
+#pragma once
+
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <vector>
+#include "FrameBuffer.h"
+#include "Texture.h"
+
+namespace Engine
+{
+    // Records the FrameBuffer passes of a frame and runs them in order.
+    // Passes declare the targets they read and the one they draw to. Before running, the graph
+    //  - culls passes whose output is never read (directly or indirectly) by a pass drawing to an imported target,
+    //  - allocates transient targets from a pool, a target whose last reader already ran is handed to the next
+    //    transient target of the same size and format, so a post-processing chain ping-pongs between two buffers,
+    //  - clears a transient target before the first pass drawing to it, unless that pass overwrites every pixel.
+    // Record the passes again every frame, pooled targets persist between frames.
+    class RenderGraph
+    {
+    public:
+        // Handle to a target, only valid for the frame it was created in
+        typedef int Resource;
+
+        static constexpr Resource INVALID = -1;
+
+        // What a pass does with the pixels already in its target when it's the first one drawing to it
+        enum class Load
+        {
+            // Transient targets are cleared to transparent black, imported ones are kept
+            Clear,
+            // The pass draws over every pixel, the previous contents don't matter
+            DontCare
+        };
+
+        class Context
+        {
+        public:
+            // The FrameBuffer the pass draws to
+            [[nodiscard]] const std::shared_ptr<FrameBuffer> &target() const;
+
+            // Color texture of the pass' n-th input
+            [[nodiscard]] const std::shared_ptr<Texture> &input(int index) const;
+
+        private:
+            friend class RenderGraph;
+
+            const RenderGraph *graph = nullptr;
+            int pass = 0;
+        };
+
+        typedef std::function<void(const Context &)> Execute;
+
+        // Transient targets that go unused for this many frames are released
+        static constexpr int POOL_FRAMES = 60;
+
+        RenderGraph() = default;
+
+        RenderGraph(const RenderGraph &) = delete;
+
+        RenderGraph &operator=(const RenderGraph &) = delete;
+
+        // Declares a transient target with a single color attachment
+        Resource create(int width, int height, TextureFormat format = TextureFormat::RGBA);
+
+        // Declares an existing FrameBuffer (ex. the BackBuffer). Passes drawing to imported targets are never culled.
+        Resource import(const std::shared_ptr<FrameBuffer> &frameBuffer);
+
+        // `name` must outlive the graph (it's used for profiler zones), use string literals
+        void addPass(const char *name, std::initializer_list<Resource> inputs, Resource output, Execute execute,
+                     Load load = Load::Clear);
+
+        // Culls, allocates the targets and runs the passes recorded this frame, then forgets them
+        void execute();
+
+        // Releases the pooled targets
+        void dispose();
+
+        // Number of passes run / culled by the last execute(), and FrameBuffers currently pooled
+        [[nodiscard]] int executedPasses() const { return mExecuted; }
+
+        [[nodiscard]] int culledPasses() const { return mCulled; }
+
+        [[nodiscard]] int pooledTargets() const { return (int)mPool.size(); }
+
+    private:
+        struct ResourceEntry
+        {
+            int width = 0;
+            int height = 0;
+            TextureFormat format = TextureFormat::None;
+            std::shared_ptr<FrameBuffer> frameBuffer;
+            bool imported = false;
+            bool needed = false;
+            // pass indices of the first and last live pass using the resource
+            int firstUse = -1;
+            int lastUse = -1;
+        };
+
+        struct Pass
+        {
+            const char *name;
+            std::vector<Resource> inputs;
+            Resource output;
+            Execute execute;
+            Load load;
+            bool live = false;
+        };
+
+        struct PooledTarget
+        {
+            std::shared_ptr<FrameBuffer> frameBuffer;
+            TextureFormat format;
+            bool inUse = false;
+            uint64_t lastFrame = 0;
+        };
+
+        std::vector<ResourceEntry> mResources;
+        std::vector<Pass> mPasses;
+        std::vector<PooledTarget> mPool;
+        uint64_t mFrame = 0;
+        int mExecuted = 0;
+        int mCulled = 0;
+
+        void cull();
+
+        std::shared_ptr<FrameBuffer> acquire(const ResourceEntry &resource);
+
+        void release(const std::shared_ptr<FrameBuffer> &frameBuffer);
+    };
+}
@@ -14,11 +14,15 @@ namespace Engine {
         Repeat
     };
 
+    // Describes how a texture is sampled. RenderPass binds a GL sampler object per distinct value (see SamplerCache),
+    // textures themselves don't carry any sampling state.
     struct TextureSampler {
 
         TextureFilter filter;
         TextureWrap wrapX;
         TextureWrap wrapY;
+        // Filter between mip levels, None samples the first level only
+        TextureFilter mipFilter = TextureFilter::None;
 
         TextureSampler() :
                 filter(TextureFilter::Linear),
@@ -35,10 +39,17 @@ namespace Engine {
                 wrapX(wrap_x),
                 wrapY(wrap_y) {}
 
+        TextureSampler(TextureFilter filter, TextureWrap wrap_x, TextureWrap wrap_y, TextureFilter mip_filter) :
+                filter(filter),
+                wrapX(wrap_x),
+                wrapY(wrap_y),
+                mipFilter(mip_filter) {}
+
         bool operator==(const TextureSampler& rhs) const {
             return filter == rhs.filter &&
                     wrapX == rhs.wrapX &&
-                    wrapY == rhs.wrapY;
+                    wrapY == rhs.wrapY &&
+                    mipFilter == rhs.mipFilter;
         }
 
         bool operator!=(const TextureSampler& rhs) const {
@@ -0,0 +1,51 @@
+#include "SamplerCache.h"
+#include <utility>
+#include <vector>
+
+namespace Engine
+{
+    namespace
+    {
+        // A handful of distinct samplers are ever used, a linear search beats hashing
+        std::vector<std::pair<TextureSampler, GLuint>> samplers;
+
+        GLint minFilter(const TextureSampler &sampler)
+        {
+            bool nearest = sampler.filter == TextureFilter::Nearest;
+            switch (sampler.mipFilter)
+            {
+            case TextureFilter::Nearest:
+                return nearest ? GL_NEAREST_MIPMAP_NEAREST : GL_LINEAR_MIPMAP_NEAREST;
+            case TextureFilter::Linear:
+                return nearest ? GL_NEAREST_MIPMAP_LINEAR : GL_LINEAR_MIPMAP_LINEAR;
+            default:
+                return nearest ? GL_NEAREST : GL_LINEAR;
+            }
+        }
+    }
+
+    GLuint SamplerCache::get(const TextureSampler &sampler)
+    {
+        for (auto &entry : samplers)
+        {
+            if (entry.first == sampler)
+                return entry.second;
+        }
+
+        GLuint id = 0;
+        glGenSamplers(1, &id);
+        glSamplerParameteri(id, GL_TEXTURE_MIN_FILTER, minFilter(sampler));
+        glSamplerParameteri(id, GL_TEXTURE_MAG_FILTER, sampler.filter == TextureFilter::Nearest ? GL_NEAREST : GL_LINEAR);
+        glSamplerParameteri(id, GL_TEXTURE_WRAP_S, sampler.wrapX == TextureWrap::Clamp ? GL_CLAMP_TO_EDGE : GL_REPEAT);
+        glSamplerParameteri(id, GL_TEXTURE_WRAP_T, sampler.wrapY == TextureWrap::Clamp ? GL_CLAMP_TO_EDGE : GL_REPEAT);
+        samplers.emplace_back(sampler, id);
+        return id;
+    }
+
+    void SamplerCache::shutdown()
+    {
+        for (auto &entry : samplers)
+            glDeleteSamplers(1, &entry.second);
+        samplers.clear();
+    }
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <glad/glad.h>
+#include "Sampler.h"
+
+namespace Engine
+{
+    // GL sampler objects, one per distinct TextureSampler value.
+    // Binding a cached sampler replaces re-configuring the texture with glTexParameteri whenever it's drawn differently.
+    class SamplerCache
+    {
+    public:
+        // Returns the sampler object for `sampler`, created on first use (needs the GL context)
+        static GLuint get(const TextureSampler &sampler);
+
+        // Deletes the sampler objects (needs the GL context)
+        static void shutdown();
+
+    private:
+        SamplerCache() = default;
+    };
+}
@@ -1,79 +1,159 @@
 #include "Shader.h"
 #include "Log.h"
-#include <fstream>
 #include "Application.h"
-#include "Content.h"
+#include "ShaderCache.h"
 
 using namespace Engine;
 
 std::shared_ptr<Shader> Shader::create(const std::string &vertexPath, const std::string &fragmentPath)
 {
-    std::string vertexSource;
-    auto assets = Content::path().append(vertexPath);
-    std::getline(std::ifstream(assets), vertexSource, '\0');
+    return ShaderCache::load(vertexPath, fragmentPath);
+}
+
+namespace
+{
+    void compileStage(GLuint shader, const std::string &source)
+    {
+        const GLchar *text = (const GLchar *)source.c_str();
+        glShaderSource(shader, 1, &text, nullptr);
+        glCompileShader(shader);
+    }
 
-    std::string fragmentSource;
-    assets = Content::path().append(fragmentPath);
-    std::getline(std::ifstream(assets), fragmentSource, '\0');
+    // Compile errors make the shader unusable, anything else the driver logs is a warning
+    bool checkStage(GLuint shader, const char *stage)
+    {
+        GLint status = GL_FALSE;
+        glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
 
-    const Engine::ShaderData shader_data = {vertexSource, fragmentSource};
-    return std::shared_ptr<Shader>(new Shader(shader_data));
+        GLchar log[1024];
+        GLsizei logLength = 0;
+        glGetShaderInfoLog(shader, 1024, &logLength, log);
+        if (status != GL_TRUE)
+            ENGINE_LOG_ERROR(Graphics, "{} shader: {}", stage, log);
+        else if (logLength > 0)
+            ENGINE_LOG_WARN(Graphics, "{} shader: {}", stage, log);
+        return status == GL_TRUE;
+    }
 }
 
 Shader::Shader(const ShaderData &data)
+{
+    compile(data, false);
+    finish();
+}
+
+void Shader::compile(const ShaderData &data, bool retrievable)
 {
     ENGINE_ASSERT(data.vertex.length() > 0, "Must provide a vertex shader");
     ENGINE_ASSERT(data.fragment.length() > 0, "Must provide a fragment shader");
 
-    GLchar log[1024];
-    GLsizei logLength = 0;
+    // Nothing to compile without a GL context, the shader has no uniforms
+    if (Application::isHeadless())
+        return;
 
     GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
-    {
-        const GLchar *source = (const GLchar *)data.vertex.c_str();
-        glShaderSource(vertexShader, 1, &source, nullptr);
-        glCompileShader(vertexShader);
-        glGetShaderInfoLog(vertexShader, 1024, &logLength, log);
-
-        if (logLength > 0)
-        {
-            glDeleteShader(vertexShader);
-            ENGINE_CORE_ERROR(log);
-            return;
-        }
-    }
-
+    compileStage(vertexShader, data.vertex);
     GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-    {
-        const GLchar *source = (const GLchar *)data.fragment.c_str();
-        glShaderSource(fragmentShader, 1, &source, nullptr);
-        glCompileShader(fragmentShader);
-        glGetShaderInfoLog(fragmentShader, 1024, &logLength, log);
-
-        if (logLength > 0)
-        {
-            glDeleteShader(vertexShader);
-            glDeleteShader(fragmentShader);
-            ENGINE_CORE_ERROR(log);
-            return;
-        }
-    }
+    compileStage(fragmentShader, data.fragment);
 
+    // Compile status isn't queried here, that would wait for the compiler. A failed stage fails the link,
+    // the stage logs are read then (the shaders stay attached until finish())
     GLuint id = glCreateProgram();
     glAttachShader(id, vertexShader);
     glAttachShader(id, fragmentShader);
+    if (retrievable)
+        glProgramParameteri(id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
     glLinkProgram(id);
-    glGetProgramInfoLog(id, 1024, &logLength, log);
-    glDetachShader(id, vertexShader);
-    glDetachShader(id, fragmentShader);
+    // flagged for deletion, they go away once detached
     glDeleteShader(vertexShader);
     glDeleteShader(fragmentShader);
+    mPending = id;
+}
 
-    if (logLength > 0)
+bool Shader::loadBinary(GLenum format, const void *binary, GLsizei size)
+{
+    if (Application::isHeadless())
+        return false;
+
+    GLuint id = glCreateProgram();
+    glProgramBinary(id, format, binary, size);
+    GLint status = GL_FALSE;
+    glGetProgramiv(id, GL_LINK_STATUS, &status);
+    if (status != GL_TRUE)
+    {
+        // driver updates invalidate binaries, that's expected
+        glDeleteProgram(id);
+        return false;
+    }
+    mPending = id;
+    return true;
+}
+
+std::vector<uint8_t> Shader::getBinary(GLenum &format) const
+{
+    std::vector<uint8_t> binary;
+    GLuint id = getId();
+    if (id == 0)
+        return binary;
+
+    GLint length = 0;
+    glGetProgramiv(id, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+        return binary;
+    binary.resize(length);
+    GLsizei written = 0;
+    glGetProgramBinary(id, length, &written, &format, binary.data());
+    binary.resize(written);
+    return binary;
+}
+
+bool Shader::isReady() const
+{
+    if (mPending == 0 || !ShaderCache::hasParallelCompile())
+        return true;
+    GLint complete = GL_FALSE;
+    glGetProgramiv(mPending, ShaderCache::COMPLETION_STATUS, &complete);
+    return complete == GL_TRUE;
+}
+
+bool Shader::isValid() const
+{
+    return getId() != 0;
+}
+
+void Shader::finish() const
+{
+    if (mPending == 0)
+        return;
+    GLuint id = mPending;
+    mPending = 0;
+
+    GLint status = GL_FALSE;
+    glGetProgramiv(id, GL_LINK_STATUS, &status);
+
+    // report the stages first, a failed compile is what made the link fail
+    GLuint stages[2];
+    GLsizei stageCount = 0;
+    glGetAttachedShaders(id, 2, &stageCount, stages);
+    for (GLsizei i = 0; i < stageCount; i++)
+    {
+        GLint type = 0;
+        glGetShaderiv(stages[i], GL_SHADER_TYPE, &type);
+        checkStage(stages[i], type == GL_VERTEX_SHADER ? "Vertex" : "Fragment");
+        glDetachShader(id, stages[i]);
+    }
+
+    GLchar log[1024];
+    GLsizei logLength = 0;
+    glGetProgramInfoLog(id, 1024, &logLength, log);
+    if (status != GL_TRUE)
     {
-        ENGINE_CORE_ERROR(log);
+        ENGINE_LOG_ERROR(Graphics, "Failed to link shader: {}", log);
+        glDeleteProgram(id);
         return;
     }
+    if (logLength > 0)
+        ENGINE_LOG_WARN(Graphics, "Shader link: {}", log);
 
     // get uniforms
     bool validUniforms = true;
@@ -106,7 +186,7 @@ Shader::Shader(const ShaderData &data)
                 }
             }
 
-            if (type == GL_SAMPLER_2D)
+            if (type == GL_SAMPLER_2D || type == GL_SAMPLER_2D_ARRAY)
             {
                 // GL_SAMPLER are special, so if it's a sampler push a texUniform AND a sampler uniform
                 UniformInfo texUniform;
@@ -157,7 +237,7 @@ Shader::Shader(const ShaderData &data)
                 else
                 {
                     validUniforms = false;
-                    ENGINE_CORE_ERROR("Unsupported uniform type");
+                    ENGINE_LOG_ERROR(Graphics, "Unsupported uniform type");
                     break;
                 }
 
@@ -175,22 +255,28 @@ Shader::Shader(const ShaderData &data)
 
 Shader::~Shader()
 {
+    if (mPending > 0)
+        glDeleteProgram(mPending);
     if (mId > 0)
         glDeleteProgram(mId);
+    mPending = 0;
     mId = 0;
 }
 
 std::vector<UniformInfo> &Shader::uniforms()
 {
+    finish();
     return mUniforms;
 }
 
 const std::vector<UniformInfo> &Shader::uniforms() const
 {
+    finish();
     return mUniforms;
 }
 
 GLuint Shader::getId() const
 {
+    finish();
     return mId;
 }
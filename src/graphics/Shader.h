@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <glad/glad.h>
 #include <vector>
@@ -46,20 +48,48 @@ namespace Engine {
         std::string fragment;
     };
 
+    // A linked GL program and its uniforms.
+    // Shaders made by the ShaderCache are finished lazily: compiling and linking is only issued, the driver may work
+    // on it in the background, and the link result is checked (and uniforms reflected) the first time it's needed.
     class Shader {
     private:
-        GLuint mId;
-        std::vector<UniformInfo> mUniforms{};
+        // mutable: finishing a pending program is invisible to callers, it happens on first use
+        mutable GLuint mId = 0;
+        mutable GLuint mPending = 0;
+        mutable std::vector<UniformInfo> mUniforms{};
+
+        friend class ShaderCache;
+
+        // Issues the compile and link, `retrievable` asks the driver to keep a binary around for getBinary()
+        void compile(const ShaderData& data, bool retrievable);
+
+        // Creates the program from a binary returned by getBinary(), false if the driver rejected it
+        bool loadBinary(GLenum format, const void* binary, GLsizei size);
+
+        // Program binary of a finished shader, empty if unavailable
+        std::vector<uint8_t> getBinary(GLenum& format) const;
+
+        // Checks the link result and reflects the uniforms, waits for the driver if it's still compiling
+        void finish() const;
 
     protected:
         Shader() = default;
 
     public:
+        // Compiles and links the shader, waiting for the result. Prefer ShaderCache::get, which shares programs
         explicit Shader(const ShaderData& data);
 
+        // Same as ShaderCache::load
         static std::shared_ptr<Shader> create(const std::string& vertexPath, const std::string& fragmentPath);
 
-        std::vector<GLint> uniformLocations;
+        mutable std::vector<GLint> uniformLocations;
+
+        // False while the driver is still compiling (only known with GL_KHR_parallel_shader_compile),
+        // using the shader before then waits for it
+        [[nodiscard]] bool isReady() const;
+
+        // False if the shader failed to compile or link (finishes it)
+        [[nodiscard]] bool isValid() const;
 
         Shader(const Shader&) = delete;
 
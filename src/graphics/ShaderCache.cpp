@@ -0,0 +1,221 @@
+#include "ShaderCache.h"
+#include "Application.h"
+#include "Content.h"
+#include "DefaultShader.h"
+#include "Log.h"
+#include "Profiler.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+namespace Engine
+{
+    namespace
+    {
+        constexpr uint32_t BINARY_MAGIC = 0x42485345; // "ESHB"
+        // glMaxShaderCompilerThreadsKHR
+        typedef void(APIENTRYP MaxShaderCompilerThreadsProc)(GLuint count);
+
+        struct Entry
+        {
+            uint64_t hash;
+            ShaderData data;
+            std::shared_ptr<Shader> shader;
+            // the program came from source and its binary hasn't been written yet
+            bool unsaved;
+        };
+
+        // A handful of programs exist, a linear search is plenty
+        std::vector<Entry> entries;
+        std::vector<std::pair<std::string, std::shared_ptr<Shader>>> files;
+        std::string binaryDirectory;
+        // hash of the GL vendor / renderer / version, binaries are only valid for the driver that made them
+        uint64_t driverHash = 0;
+        bool initialized = false;
+        bool parallelCompile = false;
+        bool programBinaries = false;
+
+        uint64_t fnv1a(const void *data, size_t size, uint64_t hash = 0xcbf29ce484222325ull)
+        {
+            auto *bytes = (const uint8_t *)data;
+            for (size_t i = 0; i < size; i++)
+            {
+                hash ^= bytes[i];
+                hash *= 0x100000001b3ull;
+            }
+            return hash;
+        }
+
+        uint64_t hashSource(const ShaderData &data)
+        {
+            uint64_t hash = fnv1a(data.vertex.data(), data.vertex.size());
+            // separator, so moving text between the stages changes the hash
+            hash = fnv1a("\0", 1, hash);
+            return fnv1a(data.fragment.data(), data.fragment.size(), hash);
+        }
+
+        void initialize()
+        {
+            if (initialized || Application::isHeadless())
+                return;
+            initialized = true;
+
+            if (SDL_GL_ExtensionSupported("GL_KHR_parallel_shader_compile"))
+            {
+                auto maxThreads = (MaxShaderCompilerThreadsProc)SDL_GL_GetProcAddress("glMaxShaderCompilerThreadsKHR");
+                if (maxThreads)
+                {
+                    // let the driver pick the number of threads
+                    maxThreads(0xFFFFFFFF);
+                    parallelCompile = true;
+                }
+            }
+
+            GLint formats = 0;
+            if (glGetProgramBinary && glProgramBinary && glProgramParameteri)
+                glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+            programBinaries = formats > 0;
+
+            for (GLenum name : {GL_VENDOR, GL_RENDERER, GL_VERSION})
+            {
+                auto *text = (const char *)glGetString(name);
+                if (text)
+                    driverHash = fnv1a(text, strlen(text), driverHash);
+            }
+        }
+
+        std::string binaryPath(uint64_t hash)
+        {
+            char name[64];
+            snprintf(name, sizeof(name), "shader-%016llx.bin", (unsigned long long)(hash ^ driverHash));
+            return binaryDirectory + name;
+        }
+    }
+
+    bool ShaderCache::readBinary(Shader &shader, uint64_t hash)
+    {
+        std::ifstream file{binaryPath(hash), std::ios::binary};
+        if (!file)
+            return false;
+        std::vector<uint8_t> contents{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+        if (contents.size() <= 8)
+            return false;
+
+        uint32_t magic, format;
+        memcpy(&magic, contents.data(), 4);
+        memcpy(&format, contents.data() + 4, 4);
+        if (magic != BINARY_MAGIC)
+            return false;
+        return shader.loadBinary(format, contents.data() + 8, (GLsizei)(contents.size() - 8));
+    }
+
+    void ShaderCache::writeBinary(const Shader &shader, uint64_t hash)
+    {
+        GLenum format = 0;
+        auto binary = shader.getBinary(format);
+        if (binary.empty())
+            return;
+
+        std::ofstream file{binaryPath(hash), std::ios::binary};
+        if (!file)
+        {
+            ENGINE_LOG_WARN(Graphics, "Couldn't write the shader binary {}", binaryPath(hash));
+            return;
+        }
+        uint32_t header[2] = {BINARY_MAGIC, (uint32_t)format};
+        file.write((const char *)header, sizeof(header));
+        file.write((const char *)binary.data(), (std::streamsize)binary.size());
+    }
+
+    void ShaderCache::saveBinaries()
+    {
+        if (!programBinaries || binaryDirectory.empty())
+            return;
+        for (auto &entry : entries)
+        {
+            if (entry.unsaved)
+            {
+                writeBinary(*entry.shader, entry.hash);
+                entry.unsaved = false;
+            }
+        }
+    }
+
+    std::shared_ptr<Shader> ShaderCache::get(const ShaderData &data)
+    {
+        initialize();
+
+        uint64_t hash = hashSource(data);
+        for (auto &entry : entries)
+        {
+            if (entry.hash == hash && entry.data.vertex == data.vertex && entry.data.fragment == data.fragment)
+                return entry.shader;
+        }
+
+        auto shader = std::shared_ptr<Shader>(new Shader());
+        bool cached = programBinaries && !binaryDirectory.empty() && readBinary(*shader, hash);
+        if (!cached)
+            shader->compile(data, programBinaries && !binaryDirectory.empty());
+
+        entries.push_back(Entry{hash, data, shader, !cached});
+        return shader;
+    }
+
+    std::shared_ptr<Shader> ShaderCache::load(const std::string &vertexPath, const std::string &fragmentPath)
+    {
+        std::string key = vertexPath + '\n' + fragmentPath;
+        for (auto &file : files)
+        {
+            if (file.first == key)
+                return file.second;
+        }
+
+        ShaderData data;
+        std::getline(std::ifstream(Content::path().append(vertexPath)), data.vertex, '\0');
+        std::getline(std::ifstream(Content::path().append(fragmentPath)), data.fragment, '\0');
+        if (data.vertex.empty() || data.fragment.empty())
+            ENGINE_LOG_ERROR(Graphics, "Couldn't read the shader {} / {}", vertexPath, fragmentPath);
+
+        auto shader = get(data);
+        files.emplace_back(key, shader);
+        return shader;
+    }
+
+    void ShaderCache::setBinaryDirectory(const std::string &directory)
+    {
+        binaryDirectory = directory;
+        if (!binaryDirectory.empty() && binaryDirectory.back() != '/' && binaryDirectory.back() != '\\')
+            binaryDirectory += '/';
+    }
+
+    void ShaderCache::warmUp()
+    {
+        if (Application::isHeadless())
+            return;
+        ENGINE_PROFILE_SCOPE("ShaderCache::warmUp");
+
+        // issue every compile before waiting on any of them
+        get(shader_data);
+        get(array_shader_data);
+        get(sharp_bilinear_shader_data);
+        get(distance_field_shader_data);
+        for (auto &entry : entries)
+            entry.shader->finish();
+
+        saveBinaries();
+    }
+
+    bool ShaderCache::hasParallelCompile()
+    {
+        return parallelCompile;
+    }
+
+    void ShaderCache::shutdown()
+    {
+        saveBinaries();
+        entries.clear();
+        files.clear();
+    }
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <glad/glad.h>
+#include "Shader.h"
+
+namespace Engine
+{
+    // Shader programs keyed by a hash of their source, identical sources share one program.
+    // Compiles are only issued (see Shader), the driver can work on several of them at once, on its own threads
+    // with GL_KHR_parallel_shader_compile. Linked programs are saved with glGetProgramBinary when a binary directory
+    // is set, and loaded back instead of compiled on the next start.
+    class ShaderCache
+    {
+    public:
+        // GL_COMPLETION_STATUS_KHR, glad doesn't define GL_KHR_parallel_shader_compile
+        static constexpr GLenum COMPLETION_STATUS = 0x91B1;
+
+        // Returns the shader for `data`, compiling it if it isn't cached yet (needs the GL context)
+        static std::shared_ptr<Shader> get(const ShaderData &data);
+
+        // Returns the shader for the files (relative to Content::path()), the files are only read once
+        static std::shared_ptr<Shader> load(const std::string &vertexPath, const std::string &fragmentPath);
+
+        // Where program binaries are kept, the Application sets its SDL pref path. Empty disables the binary cache.
+        static void setBinaryDirectory(const std::string &directory);
+
+        // Compiles the engine's own shaders and finishes every pending program, so none of them hitch the first frame.
+        // The Application calls it after Content::load(), call it again after loading more shaders.
+        static void warmUp();
+
+        // True if the driver compiles on its own threads (GL_KHR_parallel_shader_compile)
+        static bool hasParallelCompile();
+
+        // Deletes the programs (needs the GL context)
+        static void shutdown();
+
+    private:
+        ShaderCache() = default;
+
+        // Shader's binary API is private to the cache
+        static bool readBinary(Shader &shader, uint64_t hash);
+
+        static void writeBinary(const Shader &shader, uint64_t hash);
+
+        static void saveBinaries();
+    };
+}
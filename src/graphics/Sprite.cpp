@@ -0,0 +1,35 @@
+#include "Sprite.h"
+#include <algorithm>
+
+void Engine::Animation::buildTimeline() {
+    timeline.clear();
+    timelineEnds.clear();
+    int count = (int) frames.size();
+    switch (direction) {
+        case Direction::Forward:
+            for (int i = 0; i < count; i++) timeline.push_back(i);
+            break;
+        case Direction::Reverse:
+            for (int i = count - 1; i >= 0; i--) timeline.push_back(i);
+            break;
+        case Direction::PingPong:
+            for (int i = 0; i < count; i++) timeline.push_back(i);
+            for (int i = count - 2; i > 0; i--) timeline.push_back(i);
+            break;
+    }
+
+    duration = 0;
+    for (int frame : timeline) {
+        duration += frames[frame].durationMillis;
+        timelineEnds.push_back(duration);
+    }
+}
+
+size_t Engine::Animation::seek(float millis) const {
+    // the first entry ending after `millis`, entries lasting 0 millis are never picked
+    auto end = std::upper_bound(timelineEnds.begin(), timelineEnds.end(), millis,
+                                [](float value, int end) { return value < (float) end; });
+    if (end == timelineEnds.end())
+        return timelineEnds.empty() ? 0 : timelineEnds.size() - 1;
+    return (size_t) (end - timelineEnds.begin());
+}
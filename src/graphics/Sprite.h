@@ -12,9 +12,26 @@ namespace Engine {
     };
 
     struct Animation {
+        enum class Direction {
+            Forward, Reverse, PingPong
+        };
+
         std::string name;
         std::vector<Frame> frames;
-        int duration;
+        // Millis one loop takes (a ping pong loop plays the frames forward and back), set by buildTimeline
+        int duration = 0;
+        Direction direction = Direction::Forward;
+
+        // Frames in the order they play in one loop, ping pong doesn't repeat the first and last frames
+        std::vector<int> timeline;
+        // Millis at which each timeline entry ends, ascending
+        std::vector<int> timelineEnds;
+
+        // Fills the timeline from the frames and the direction, call it once the frames are added
+        void buildTimeline();
+
+        // Timeline entry playing `millis` into the loop (0 <= millis < duration), a binary search
+        [[nodiscard]] size_t seek(float millis) const;
     };
 
     class Sprite {
@@ -42,6 +59,10 @@ namespace Engine {
             return animations.emplace_back();
         }
 
+        std::vector<Animation> &getAnimations() {
+            return animations;
+        }
+
         std::string name;
     private:
 
@@ -9,7 +9,20 @@
 Engine::Subtexture::Subtexture() = default;
 
 Engine::Subtexture::Subtexture(const std::shared_ptr<Texture>& texture, Engine::Rect source) : texture{texture}, rect{source} {
+    computeUVs();
+}
+
+Engine::Subtexture::Subtexture(const std::shared_ptr<Texture>& texture, Engine::Rect source, int layer) :
+        texture{texture}, rect{source}, layer{layer} {
+    computeUVs();
+}
 
+void Engine::Subtexture::computeUVs() {
+    // Content creates its frames before the atlas texture exists
+    if (!texture) return;
+    auto size = glm::vec2{(float) texture->getWidth(), (float) texture->getHeight()};
+    uv0 = rect.top_left() / size;
+    uv1 = rect.bottom_right() / size;
 }
 
 
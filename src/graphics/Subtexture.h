@@ -15,15 +15,28 @@ namespace Engine {
 
         Subtexture(const std::shared_ptr<Texture>& texture, Rect source);
 
+        Subtexture(const std::shared_ptr<Texture>& texture, Rect source, int layer);
+
         std::shared_ptr<Texture> texture;
 
         // non-normalised texture coordinates
         Rect rect{};
 
+        // layer of the texture when it's a texture array
+        int layer = 0;
+
+        // `rect` normalised to the texture size (top left, bottom right), set by the constructors:
+        // build a new Subtexture instead of changing `texture` or `rect`
+        glm::vec2 uv0{0.0f};
+        glm::vec2 uv1{0.0f};
+
         [[nodiscard]] float width() const { return rect.w; }
 
         [[nodiscard]] float height() const { return rect.h; }
 
+    private:
+        void computeUVs();
+
     };
 
 }
\ No newline at end of file
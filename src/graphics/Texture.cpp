@@ -4,6 +4,12 @@
 
 #include "Texture.h"
 #include "Log.h"
+#include "Application.h"
+#include "ImageOps.h"
+#include "Ktx2.h"
+#include <climits>
+#include <cstring>
+#include <string>
 
 #define STB_IMAGE_IMPLEMENTATION
 
@@ -11,24 +17,61 @@
 
 namespace Engine
 {
+    namespace
+    {
+        bool premultipliedAlpha = false;
+
+        // Extension enums glad doesn't define for a core profile
+        constexpr GLenum COMPRESSED_RGBA_S3TC_DXT1 = 0x83F1;
+        constexpr GLenum COMPRESSED_RGBA_S3TC_DXT5 = 0x83F3;
+        constexpr GLenum COMPRESSED_RGBA_ASTC_4x4 = 0x93B0;
+
+        bool hasExtension(const char *name)
+        {
+            GLint count = 0;
+            glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+            for (GLint i = 0; i < count; i++)
+            {
+                auto *extension = (const char *)glGetStringi(GL_EXTENSIONS, i);
+                if (extension && strcmp(extension, name) == 0)
+                    return true;
+            }
+            return false;
+        }
+
+        bool hasVersion(int major, int minor)
+        {
+            return GLVersion.major > major || (GLVersion.major == major && GLVersion.minor >= minor);
+        }
+
+        bool endsWith(const char *text, const char *suffix)
+        {
+            size_t length = strlen(text), suffixLength = strlen(suffix);
+            return length >= suffixLength && strcmp(text + length - suffixLength, suffix) == 0;
+        }
+    }
 
-    Texture::Texture(int width, int height, TextureFormat format)
+    Texture::Texture(int width, int height, TextureFormat format, GLenum target, int layers)
     {
         id = 0;
         this->width = width;
         this->height = height;
-        sampler = TextureSampler(TextureFilter::None, TextureWrap::None, TextureWrap::None);
+        this->target = target;
+        this->layers = layers;
         this->format = format;
         framebufferParent = false;
         GLInternalFormat = GL_RED;
         GLFormat = GL_RED;
         GLType = GL_UNSIGNED_BYTE;
 
-        int maxTextureSize;
-        glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize);
+        // No GPU storage, the texture only describes its size and format
+        if (Application::isHeadless())
+            return;
+
+        int maxTextureSize = maxSize();
         if (width > maxTextureSize || height > maxTextureSize)
         {
-            ENGINE_CORE_ERROR("Exceeded Max Texture Size of {}", maxTextureSize);
+            ENGINE_LOG_ERROR(Graphics, "Exceeded Max Texture Size of {}", maxTextureSize);
             return;
         }
 
@@ -75,17 +118,53 @@ namespace Engine
             GLType = GL_UNSIGNED_INT_24_8;
             break;
         }
+        case TextureFormat::BC1:
+        {
+            GLInternalFormat = COMPRESSED_RGBA_S3TC_DXT1;
+            GLFormat = GL_RGBA;
+            break;
+        }
+        case TextureFormat::BC3:
+        {
+            GLInternalFormat = COMPRESSED_RGBA_S3TC_DXT5;
+            GLFormat = GL_RGBA;
+            break;
+        }
+        case TextureFormat::BC7:
+        {
+            GLInternalFormat = GL_COMPRESSED_RGBA_BPTC_UNORM;
+            GLFormat = GL_RGBA;
+            break;
+        }
+        case TextureFormat::ETC2:
+        {
+            GLInternalFormat = GL_COMPRESSED_RGBA8_ETC2_EAC;
+            GLFormat = GL_RGBA;
+            break;
+        }
+        case TextureFormat::ASTC4x4:
+        {
+            GLInternalFormat = COMPRESSED_RGBA_ASTC_4x4;
+            GLFormat = GL_RGBA;
+            break;
+        }
         default:
         {
-            ENGINE_CORE_ERROR("Invalid Texture Format {}", format);
+            ENGINE_LOG_ERROR(Graphics, "Invalid Texture Format {}", format);
             return;
         }
         }
 
         glGenTextures(1, &id);
         glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, id);
-        glTexImage2D(GL_TEXTURE_2D, 0, GLInternalFormat, width, height, 0, GLFormat, GLType, nullptr);
+        glBindTexture(target, id);
+        // compressed storage is allocated when the data is uploaded
+        if (target == GL_TEXTURE_2D_ARRAY)
+            glTexImage3D(target, 0, GLInternalFormat, width, height, layers, 0, GLFormat, GLType, nullptr);
+        else if (!isCompressed(format))
+            glTexImage2D(target, 0, GLInternalFormat, width, height, 0, GLFormat, GLType, nullptr);
+        // only the levels that exist, otherwise sampling with a mip filter reads an incomplete texture
+        glTexParameteri(target, GL_TEXTURE_MAX_LEVEL, 0);
     }
 
     std::shared_ptr<Texture> Engine::Texture::create(int width, int height, unsigned char *rgba)
@@ -105,19 +184,123 @@ namespace Engine
         return std::shared_ptr<Engine::Texture>(texture);
     }
 
+    std::shared_ptr<Texture> Engine::Texture::create(int width, int height, TextureFormat format,
+                                                     const std::vector<TextureLevel> &levels)
+    {
+        ENGINE_ASSERT(width > 0 && height > 0, "Texture with and height must be greater than 0");
+        if (levels.empty() || format == TextureFormat::DepthStencil)
+        {
+            ENGINE_LOG_ERROR(Graphics, "Invalid Texture data");
+            return nullptr;
+        }
+
+        // Fallback for contexts without S3TC: decode every level to RGBA
+        if (isCompressed(format) && !Application::isHeadless() && !isSupported(format))
+        {
+            if (format != TextureFormat::BC1 && format != TextureFormat::BC3)
+            {
+                ENGINE_LOG_ERROR(Graphics, "Compressed Texture Format {} is not supported by this GPU", (int)format);
+                return nullptr;
+            }
+
+            std::vector<std::vector<Color>> decoded(levels.size());
+            std::vector<TextureLevel> rgbaLevels;
+            for (size_t i = 0; i < levels.size(); i++)
+            {
+                auto &level = levels[i];
+                decoded[i].resize((size_t)level.width * level.height);
+                if (format == TextureFormat::BC1)
+                    ImageOps::decodeBC1(decoded[i].data(), level.data, level.width, level.height);
+                else
+                    ImageOps::decodeBC3(decoded[i].data(), level.data, level.width, level.height);
+                rgbaLevels.push_back({level.width, level.height, (const unsigned char *)decoded[i].data(),
+                                      decoded[i].size() * sizeof(Color)});
+            }
+            return create(width, height, TextureFormat::RGBA, rgbaLevels);
+        }
+
+        auto *texture = new Texture(width, height, format);
+        texture->levels = (int)levels.size();
+        if (texture->id == 0)
+            return std::shared_ptr<Texture>(texture);
+
+        for (size_t i = 0; i < levels.size(); i++)
+        {
+            auto &level = levels[i];
+            if (level.size < dataSize(format, level.width, level.height))
+            {
+                ENGINE_LOG_ERROR(Graphics, "Texture level {} is too small", i);
+                texture->levels = (int)i;
+                break;
+            }
+            if (isCompressed(format))
+                glCompressedTexImage2D(GL_TEXTURE_2D, (GLint)i, texture->GLInternalFormat, level.width, level.height,
+                                       0, (GLsizei)dataSize(format, level.width, level.height), level.data);
+            else
+                glTexImage2D(GL_TEXTURE_2D, (GLint)i, texture->GLInternalFormat, level.width, level.height, 0,
+                             texture->GLFormat, texture->GLType, level.data);
+        }
+        // a partial chain is still complete as long as the max level matches it
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, std::max(texture->levels - 1, 0));
+        return std::shared_ptr<Texture>(texture);
+    }
+
+    std::shared_ptr<Texture> Engine::Texture::createArray(int width, int height, int layers, TextureFormat format)
+    {
+        ENGINE_ASSERT(width > 0 && height > 0 && layers > 0, "Texture with, height and layers must be greater than 0");
+        if (isCompressed(format) || format == TextureFormat::DepthStencil)
+        {
+            ENGINE_LOG_ERROR(Graphics, "Texture arrays only support uncompressed color formats");
+            return nullptr;
+        }
+        if (width > maxSize() || height > maxSize() || layers > maxLayers())
+        {
+            ENGINE_LOG_ERROR(Graphics, "Texture array of {}x{}x{} exceeds the limits of {}x{}x{}", width, height,
+                             layers, maxSize(), maxSize(), maxLayers());
+            return nullptr;
+        }
+        return std::shared_ptr<Texture>(new Texture(width, height, format, GL_TEXTURE_2D_ARRAY, layers));
+    }
+
     std::shared_ptr<Texture> Engine::Texture::create(const char *file)
     {
+        if (endsWith(file, ".ktx2"))
+        {
+            Ktx2 ktx{std::string(file)};
+            if (!ktx.valid)
+                return nullptr;
+            if (premultipliedAlpha)
+            {
+                ktx.premultiply();
+                if (!ktx.premultiplied)
+                    ENGINE_LOG_WARN(Graphics, "{} is not premultiplied, it has to be cooked that way", file);
+            }
+            return create(ktx.width, ktx.height, ktx.format, ktx.textureLevels());
+        }
+
         int width, height, channels;
 
         unsigned char *img = stbi_load(file, &width, &height, &channels, STBI_rgb_alpha);
         if (!img)
-            ENGINE_CORE_ERROR("Could not load texture {}", file);
+            ENGINE_LOG_ERROR(Graphics, "Could not load texture {}", file);
+        else if (premultipliedAlpha)
+            ImageOps::premultiply((Color *)img, (size_t)width * height);
         auto *tex = new Texture(width, height, TextureFormat::RGBA);
         tex->set_data(img);
         stbi_image_free(img);
         return std::shared_ptr<Texture>(tex);
     }
 
+    void Texture::setPremultipliedAlpha(bool enabled)
+    {
+        premultipliedAlpha = enabled;
+    }
+
+    bool Texture::isPremultipliedAlpha()
+    {
+        return premultipliedAlpha;
+    }
+
     Texture::~Texture()
     {
         if (id > 0)
@@ -139,40 +322,199 @@ namespace Engine
         return format;
     }
 
+    bool Texture::isCompressed(TextureFormat format)
+    {
+        switch (format)
+        {
+        case TextureFormat::BC1:
+        case TextureFormat::BC3:
+        case TextureFormat::BC7:
+        case TextureFormat::ETC2:
+        case TextureFormat::ASTC4x4:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    bool Texture::isSupported(TextureFormat format)
+    {
+        // queried once, extensions don't change for the lifetime of the context
+        static const bool s3tc = hasExtension("GL_EXT_texture_compression_s3tc");
+        static const bool bptc = hasVersion(4, 2) || hasExtension("GL_ARB_texture_compression_bptc");
+        static const bool etc2 = hasVersion(4, 3) || hasExtension("GL_ARB_ES3_compatibility");
+        static const bool astc = hasExtension("GL_KHR_texture_compression_astc_ldr");
+
+        switch (format)
+        {
+        case TextureFormat::BC1:
+        case TextureFormat::BC3:
+            return s3tc;
+        case TextureFormat::BC7:
+            return bptc;
+        case TextureFormat::ETC2:
+            return etc2;
+        case TextureFormat::ASTC4x4:
+            return astc;
+        case TextureFormat::None:
+        case TextureFormat::Count:
+            return false;
+        default:
+            return true;
+        }
+    }
+
+    int Texture::maxSize()
+    {
+        if (Application::isHeadless())
+            return INT_MAX;
+        // queried once, limits don't change for the lifetime of the context
+        static const int size = []
+        {
+            GLint value = 0;
+            glGetIntegerv(GL_MAX_TEXTURE_SIZE, &value);
+            return (int)value;
+        }();
+        return size;
+    }
+
+    int Texture::maxLayers()
+    {
+        if (Application::isHeadless())
+            return INT_MAX;
+        static const int layers = []
+        {
+            GLint value = 0;
+            glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &value);
+            return (int)value;
+        }();
+        return layers;
+    }
+
+    size_t Texture::dataSize(TextureFormat format, int width, int height)
+    {
+        size_t blocks = (size_t)((width + 3) / 4) * ((height + 3) / 4);
+        switch (format)
+        {
+        case TextureFormat::R:
+            return (size_t)width * height;
+        case TextureFormat::RG:
+            return (size_t)width * height * 2;
+        case TextureFormat::RGB:
+            return (size_t)width * height * 3;
+        case TextureFormat::RGBA:
+        case TextureFormat::DepthStencil:
+            return (size_t)width * height * 4;
+        case TextureFormat::BC1:
+            return blocks * 8;
+        case TextureFormat::BC3:
+        case TextureFormat::BC7:
+        case TextureFormat::ETC2:
+        case TextureFormat::ASTC4x4:
+            return blocks * 16;
+        default:
+            return 0;
+        }
+    }
+
+    int Texture::getLevels() const
+    {
+        return levels;
+    }
+
+    int Texture::getLayers() const
+    {
+        return layers;
+    }
+
+    GLenum Texture::getTarget() const
+    {
+        return target;
+    }
+
+    bool Texture::isArray() const
+    {
+        return target == GL_TEXTURE_2D_ARRAY;
+    }
+
     void Texture::set_data(unsigned char *data) const
     {
+        if (id == 0)
+            return;
+        if (isCompressed(format))
+        {
+            ENGINE_LOG_ERROR(Graphics, "Compressed textures can only be created with their data");
+            return;
+        }
         glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, id);
-        glTexImage2D(GL_TEXTURE_2D, 0, GLInternalFormat, width, height, 0, GLFormat, GLType, data);
+        glBindTexture(target, id);
+        if (target == GL_TEXTURE_2D_ARRAY)
+            glTexSubImage3D(target, 0, 0, 0, 0, width, height, layers, GLFormat, GLType, data);
+        else
+            glTexImage2D(target, 0, GLInternalFormat, width, height, 0, GLFormat, GLType, data);
     }
 
-    void Texture::get_data(unsigned char *data)
+    void Texture::setLayer(int layer, const unsigned char *data) const
     {
+        if (id == 0)
+            return;
+        if (target != GL_TEXTURE_2D_ARRAY || layer < 0 || layer >= layers)
+        {
+            ENGINE_LOG_ERROR(Graphics, "Invalid texture layer {}", layer);
+            return;
+        }
         glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, id);
-        glGetTexImage(GL_TEXTURE_2D, 0, GLInternalFormat, GLType, data);
+        glBindTexture(target, id);
+        glTexSubImage3D(target, 0, 0, 0, layer, width, height, 1, GLFormat, GLType, data);
     }
 
-    bool Texture::isFramebuffer() const
+    void Texture::setRegion(int x, int y, int w, int h, const unsigned char *data) const
     {
-        return framebufferParent;
+        if (id == 0)
+            return;
+        if (isCompressed(format) || target != GL_TEXTURE_2D || x < 0 || y < 0 || x + w > width || y + h > height)
+        {
+            ENGINE_LOG_ERROR(Graphics, "Invalid texture region {}, {} {}x{}", x, y, w, h);
+            return;
+        }
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(target, id);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexSubImage2D(target, 0, x, y, w, h, GLFormat, GLType, data);
     }
 
-    void Texture::updateSampler(const TextureSampler &newSampler)
+    void Texture::generateMipmaps()
     {
-        if (sampler != newSampler)
+        if (isCompressed(format) || format == TextureFormat::DepthStencil)
         {
-            sampler = newSampler;
-            glBindTexture(GL_TEXTURE_2D, id);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
-                            sampler.filter == TextureFilter::Nearest ? GL_NEAREST : GL_LINEAR);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER,
-                            sampler.filter == TextureFilter::Nearest ? GL_NEAREST : GL_LINEAR);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S,
-                            sampler.wrapX == TextureWrap::Clamp ? GL_CLAMP_TO_EDGE : GL_REPEAT);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T,
-                            sampler.wrapY == TextureWrap::Clamp ? GL_CLAMP_TO_EDGE : GL_REPEAT);
+            ENGINE_LOG_ERROR(Graphics, "Mipmaps can't be generated for this texture format");
+            return;
         }
+
+        levels = 1;
+        while ((std::max(width, height) >> levels) > 0)
+            levels++;
+        if (id == 0)
+            return;
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(target, id);
+        glTexParameteri(target, GL_TEXTURE_MAX_LEVEL, levels - 1);
+        glGenerateMipmap(target);
+    }
+
+    void Texture::get_data(unsigned char *data)
+    {
+        if (id == 0 || isCompressed(format))
+            return;
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(target, id);
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glGetTexImage(target, 0, GLFormat, GLType, data);
+    }
+
+    bool Texture::isFramebuffer() const
+    {
+        return framebufferParent;
     }
 
     GLuint Texture::getId()
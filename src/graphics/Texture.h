@@ -1,6 +1,8 @@
 #pragma once
 
+#include <cstddef>
 #include <memory>
+#include <vector>
 #include <glad/glad.h>
 #include "Sampler.h"
 
@@ -13,9 +15,23 @@ namespace Engine {
         RGB,
         RGBA,
         DepthStencil,
+        // Block compressed RGBA formats (4x4 blocks), uploaded as is when the GL context supports them
+        BC1,
+        BC3,
+        BC7,
+        ETC2,
+        ASTC4x4,
         Count
     };
 
+    // One mip level of pixel data, tightly packed in the texture's format
+    struct TextureLevel {
+        int width;
+        int height;
+        const unsigned char* data;
+        size_t size;
+    };
+
 
     class Texture {
 
@@ -23,17 +39,20 @@ namespace Engine {
         GLuint id;
         int width;
         int height;
-        TextureSampler sampler;
+        // GL_TEXTURE_2D or GL_TEXTURE_2D_ARRAY
+        GLenum target = GL_TEXTURE_2D;
+        int layers = 1;
         TextureFormat format;
         GLenum GLInternalFormat;
         GLenum GLFormat;
         GLenum GLType;
+        int levels = 1;
 
 
     protected:
         Texture() = default;
 
-        Texture(int width, int height, TextureFormat format);
+        Texture(int width, int height, TextureFormat format, GLenum target = GL_TEXTURE_2D, int layers = 1);
     public:
         bool framebufferParent;
 
@@ -51,8 +70,43 @@ namespace Engine {
 
         static std::shared_ptr<Texture> create(int width, int height, TextureFormat format);
 
+        // Creates a texture with a full or partial mip chain, largest level first.
+        // Compressed formats the GL context can't sample are decoded to RGBA on the CPU when possible (BC1, BC3).
+        // Returns nullptr if the data can't be used.
+        static std::shared_ptr<Texture> create(int width, int height, TextureFormat format,
+                                               const std::vector<TextureLevel>& levels);
+
+        // Creates a GL_TEXTURE_2D_ARRAY texture, every layer has the same size and format.
+        // Shaders sample it with a sampler2DArray, Batch picks the layer from the Subtexture being drawn.
+        // Returns nullptr past maxSize() or maxLayers().
+        static std::shared_ptr<Texture> createArray(int width, int height, int layers, TextureFormat format);
+
+        // Loads an image file (png, jpg... or a .ktx2 container).
+        // The pixels are premultiplied if the premultiplied alpha pipeline is enabled.
         static std::shared_ptr<Texture> create(const char* file);
 
+        static bool isCompressed(TextureFormat format);
+
+        // True if the GL context can sample the format directly (needs the GL context)
+        static bool isSupported(TextureFormat format);
+
+        // Largest width / height of a texture and largest layer count of a texture array (needs the GL context,
+        // no limit when headless)
+        static int maxSize();
+
+        static int maxLayers();
+
+        // Size in bytes of a `width` x `height` image in the given color format
+        static size_t dataSize(TextureFormat format, int width, int height);
+
+        // Opt-in premultiplied alpha pipeline. When enabled, imported images (image files, Aseprite sprites)
+        // are premultiplied on load, Batch premultiplies vertex colors and defaults to BlendMode::Premultiplied.
+        // Straight alpha bleeds the color of transparent texels into their neighbours when filtering, premultiplied doesn't.
+        // Must be set before any content is loaded (before the Application is created).
+        static void setPremultipliedAlpha(bool enabled);
+
+        static bool isPremultipliedAlpha();
+
         GLuint getId();
 
         [[nodiscard]] int getWidth() const;
@@ -61,19 +115,39 @@ namespace Engine {
 
         [[nodiscard]] TextureFormat getFormat() const;
 
-        // Sets the data of the Texture.
+        [[nodiscard]] int getLevels() const;
+
+        [[nodiscard]] int getLayers() const;
+
+        [[nodiscard]] GLenum getTarget() const;
+
+        [[nodiscard]] bool isArray() const;
+
+        // Sets the data of the Texture (of every layer, one after the other, for texture arrays).
         // Note that the pixel buffer should be in the same format as the Texture. There is no row padding.
         // If the pixel buffer isn't the same size as the texture, it will set the minimum available amount of data.
+        // Only the first level of uncompressed textures can be set.
         void set_data(unsigned char* data) const;
 
+        // Sets the data of a single layer of a texture array, same format rules as set_data
+        void setLayer(int layer, const unsigned char* data) const;
+
+        // Sets the data of a rectangle of the first level, same format rules as set_data (the data is `w` x `h`).
+        // Only uploads the rectangle, ex. a glyph added to an atlas.
+        void setRegion(int x, int y, int w, int h, const unsigned char* data) const;
+
+        // Builds the mip chain from the first level (not available for compressed textures).
+        // Mip levels are only sampled with a TextureSampler that has a mipFilter.
+        void generateMipmaps();
+
         // Gets the data of the Texture.
         // Note that the pixel buffer will be written to in the same format as the Texture,
         // and you should allocate enough space for the full texture. There is no row padding.
+        // Not available for compressed textures.
+        // This waits for the GPU to finish drawing to the texture, see Readback for a version that doesn't.
         virtual void get_data(unsigned char* data);
 
         // Returns true if the Texture is part of a FrameBuffer
         [[nodiscard]] bool isFramebuffer() const;
-
-        void updateSampler(const TextureSampler& newSampler);
     };
 }
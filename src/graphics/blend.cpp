@@ -13,6 +13,28 @@ const BlendMode BlendMode::Normal = BlendMode(
 	0xffffffff
 );
 
+const BlendMode BlendMode::Premultiplied = BlendMode(
+	BlendOp::Add,
+	BlendFactor::One,
+	BlendFactor::OneMinusSrcAlpha,
+	BlendOp::Add,
+	BlendFactor::One,
+	BlendFactor::OneMinusSrcAlpha,
+	BlendMask::RGBA,
+	0xffffffff
+);
+
+const BlendMode BlendMode::PremultipliedAdditive = BlendMode(
+	BlendOp::Add,
+	BlendFactor::One,
+	BlendFactor::One,
+	BlendOp::Add,
+	BlendFactor::One,
+	BlendFactor::One,
+	BlendMask::RGBA,
+	0xffffffff
+);
+
 const BlendMode BlendMode::Additive = BlendMode(
 	BlendOp::Add,
 	BlendFactor::SrcAlpha,
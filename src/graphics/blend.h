@@ -45,9 +45,17 @@ namespace Engine {
     };
 
     struct BlendMode {
-        // Normal, pre-multiplied, Blend Mode
+        // Normal Blend Mode, for straight (non premultiplied) alpha
         static const BlendMode Normal;
 
+        // Normal Blend Mode for premultiplied alpha (see Texture::setPremultipliedAlpha)
+        // A source with alpha 0 and some color is added to the destination, so additive and
+        // normal sprites can be drawn with this mode in the same draw call (ColorMode::Additive)
+        static const BlendMode Premultiplied;
+
+        // Additive Blend Mode for premultiplied alpha
+        static const BlendMode PremultipliedAdditive;
+
         // Subtractive Blend Mode
         static const BlendMode Subtract;
         static const BlendMode Additive;
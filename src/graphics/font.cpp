@@ -1,16 +1,56 @@
 #include "font.h"
 #include "Content.h"
 #include "TexturePacker.h"
+#include "ImageOps.h"
 #include <SDL.h>
 #include "Log.h"
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
 
 #define STB_TRUETYPE_IMPLEMENTATION
 #include "stb/stb_truetype.h"
 
 namespace Engine
 {
+    namespace
+    {
+        std::atomic<uint32_t> nextFontId{1};
+
+        // between glyphs in the atlas pages, so filtering doesn't bleed the neighbours in
+        constexpr int GLYPH_PADDING = 1;
+
+        // advanced by Font::frame(), pages used during the current frame are never evicted
+        std::atomic<uint64_t> currentFrame{1};
+    }
+
+    struct Font::Atlas
+    {
+        struct Page
+        {
+            std::shared_ptr<Texture> texture;
+            // glyphs are packed left to right in shelves as tall as their tallest glyph
+            int shelfX = 0;
+            int shelfY = 0;
+            int shelfHeight = 0;
+            uint64_t lastUse = 0;
+        };
 
-    Font::Font(const std::string &path, int pixel_height = 8)
+        struct Entry
+        {
+            Character character;
+            // -1 for glyphs that take no space in the atlas (spaces, characters the font doesn't have)
+            int page;
+        };
+
+        std::mutex mutex;
+        std::vector<Page> pages;
+        std::unordered_map<uint32_t, Entry> glyphs;
+        std::atomic<uint32_t> generation{0};
+    };
+
+    Font::Font(const std::string &path, int pixel_height, Mode mode) : mode(mode)
     {
         // Find and read .ttf file
         auto assets = Content::path().append(path);
@@ -24,85 +64,377 @@ namespace Engine
         std::shared_ptr<stbtt_fontinfo> info{new stbtt_fontinfo()};
         if (stbtt_InitFont(info.get(), ttf_buffer.data(), 0) == 0)
         {
-            ENGINE_CORE_ERROR("Unable to parse font file");
+            ENGINE_LOG_ERROR(Graphics, "Unable to parse font file");
         }
 
         buffer = std::move(ttf_buffer);
         font = info;
+        id = nextFontId++;
+        atlas = std::make_shared<Atlas>();
 
         // Get font info
         stbtt_fontinfo *fontInfo = (stbtt_fontinfo *)font.get();
-        float scale = stbtt_ScaleForMappingEmToPixels(fontInfo, pixel_height);
+        scale = stbtt_ScaleForMappingEmToPixels(fontInfo, pixel_height);
         stbtt_GetFontVMetrics(fontInfo, &ascent, &descent, &lineGap);
         ascent *= scale;
         descent *= scale;
+        padding = mode == Mode::DistanceField ? DISTANCE_FIELD_PADDING : 0;
 
         // Pack font into bitmap
         auto packer = Engine::TexturePacker();
-        for (int ch = 32; ch < 128; ch++)
+        // the packer only references the glyph pixels, keep them alive until pack()
+        std::vector<std::vector<Engine::Color>> glyphs(128);
+        std::vector<uint8_t> coverage;
+        for (int ch = FIRST_CHARACTER; ch < FIRST_CHARACTER + CHARACTER_COUNT; ch++)
         {
             Character character;
             int g = stbtt_FindGlyphIndex(fontInfo, ch);
-            int x0, y0, x1, y1;
-            stbtt_GetGlyphBitmapBox(fontInfo, g, scale, scale, &x0, &y0, &x1, &y1);
+            int gw, gh, y0;
+            bake(g, coverage, gw, gh, y0);
             character.offset_y = y0;
-            int gw = x1 - x0;
-            int gh = y1 - y0;
-            int pw = gw, ph = gh;
             int ps = gw * gh;
 
-            // allocate in the heap, the packer will own (and delete) this data
-            Engine::Color *pixels = new Engine::Color[ps];
-            stbtt_MakeGlyphBitmap(fontInfo, (uint8_t *)pixels, pw, ph, pw, scale, scale, g);
-
-            int len = gw * gh;
-            for (int a = (len - 1) * sizeof(Engine::Color), b = (len - 1); b >= 0; a -= sizeof(Engine::Color), b -= 1)
-            {
-                auto p = ((uint8_t *)pixels)[b];
-                ((uint8_t *)pixels)[a] = p;
-                ((uint8_t *)pixels)[a + 1] = p;
-                ((uint8_t *)pixels)[a + 2] = p;
-                ((uint8_t *)pixels)[a + 3] = p;
-            }
+            auto &glyph = glyphs[ch];
+            glyph.resize(ps);
+            Engine::Color *pixels = glyph.data();
+            // (a, a, a, a) is white in premultiplied alpha, it needs no conversion when the pipeline is enabled
+            Engine::ImageOps::alphaToRGBA(pixels, coverage.data(), ps);
             packer.addEntry(ch, gw, gh, pixels);
-            characters[ch] = character;
+            characters[ch - FIRST_CHARACTER] = character;
         }
 
         texture = packer.pack();
-        for (int ch = 32; ch < 128; ch++)
+        for (int ch = FIRST_CHARACTER; ch < FIRST_CHARACTER + CHARACTER_COUNT; ch++)
         {
             auto rect = packer.getEntryRect(ch);
-            Character &character = characters[ch];
+            Character &character = characters[ch - FIRST_CHARACTER];
             int advance, offsetX;
             stbtt_GetCodepointHMetrics(fontInfo, ch, &advance, &offsetX);
             character.advance = advance * scale;
             character.offset_x = offsetX * scale;
             character.texture = Engine::Subtexture(texture, *rect);
-            characters[ch] = character;
         }
+
+        // Kerning only depends on the pair, look it up once instead of on every glyph drawn
+        advances.resize(CHARACTER_COUNT * (CHARACTER_COUNT + 1));
+        for (int first = 0; first < CHARACTER_COUNT; first++)
+        {
+            int advance = characters[first].advance;
+            int16_t *row = &advances[first * (CHARACTER_COUNT + 1)];
+            for (int second = 0; second < CHARACTER_COUNT; second++)
+            {
+                int kern = stbtt_GetCodepointKernAdvance(fontInfo, first + FIRST_CHARACTER, second + FIRST_CHARACTER);
+                row[second] = (int16_t)(advance + (int)(kern * scale));
+            }
+            row[CHARACTER_COUNT] = (int16_t)advance;
+        }
+    }
+
+    int Font::index(char ch)
+    {
+        int i = (unsigned char)ch - FIRST_CHARACTER;
+        return i >= 0 && i < CHARACTER_COUNT ? i : '?' - FIRST_CHARACTER;
+    }
+
+    uint32_t Font::decodeUtf8(const char *&text)
+    {
+        auto *bytes = (const unsigned char *)text;
+        uint32_t codepoint = bytes[0];
+        int length;
+        uint32_t smallest;
+        if (codepoint < 0x80)
+        {
+            text++;
+            return codepoint;
+        }
+        else if ((codepoint & 0xE0) == 0xC0)
+        {
+            length = 2;
+            codepoint &= 0x1F;
+            smallest = 0x80;
+        }
+        else if ((codepoint & 0xF0) == 0xE0)
+        {
+            length = 3;
+            codepoint &= 0x0F;
+            smallest = 0x800;
+        }
+        else if ((codepoint & 0xF8) == 0xF0)
+        {
+            length = 4;
+            codepoint &= 0x07;
+            smallest = 0x10000;
+        }
+        else
+        {
+            text++;
+            return 0xFFFD;
+        }
+
+        for (int i = 1; i < length; i++)
+        {
+            // also stops at the terminator of truncated sequences
+            if ((bytes[i] & 0xC0) != 0x80)
+            {
+                text += i;
+                return 0xFFFD;
+            }
+            codepoint = (codepoint << 6) | (bytes[i] & 0x3F);
+        }
+        text += length;
+        // overlong encodings and UTF-16 surrogates aren't valid UTF-8
+        if (codepoint < smallest || codepoint > 0x10FFFF || (codepoint >= 0xD800 && codepoint <= 0xDFFF))
+            return 0xFFFD;
+        return codepoint;
+    }
+
+    void Font::bake(int glyph, std::vector<uint8_t> &coverage, int &w, int &h, int &y0) const
+    {
+        auto *fontInfo = (stbtt_fontinfo *)font.get();
+        if (mode == Mode::DistanceField)
+        {
+            // 128 on the outline, falling to 0 (outside) and rising to 255 (inside) over `padding` pixels
+            int xoff, yoff;
+            unsigned char *field = stbtt_GetGlyphSDF(fontInfo, scale, glyph, padding, 128, 128.0f / padding,
+                                                     &w, &h, &xoff, &yoff);
+            coverage.assign(field, field + (field ? w * h : 0));
+            if (!field)
+                w = h = 0;
+            stbtt_FreeSDF(field, nullptr);
+            // the field is padded on every side, layouts move the quad back by `padding`
+            y0 = yoff + padding;
+            return;
+        }
+
+        int x0, x1, y1;
+        stbtt_GetGlyphBitmapBox(fontInfo, glyph, scale, scale, &x0, &y0, &x1, &y1);
+        w = x1 - x0;
+        h = y1 - y0;
+        coverage.resize(w * h);
+        stbtt_MakeGlyphBitmap(fontInfo, coverage.data(), w, h, w, scale, scale, glyph);
+    }
+
+    bool Font::allocate(int w, int h, int &page, int &x, int &y) const
+    {
+        if (w + GLYPH_PADDING > PAGE_SIZE || h + GLYPH_PADDING > PAGE_SIZE)
+            return false;
+
+        auto place = [&](Atlas::Page &target) {
+            if (target.shelfX + w + GLYPH_PADDING > PAGE_SIZE)
+            {
+                target.shelfY += target.shelfHeight;
+                target.shelfX = 0;
+                target.shelfHeight = 0;
+            }
+            if (target.shelfY + h + GLYPH_PADDING > PAGE_SIZE)
+                return false;
+            x = target.shelfX;
+            y = target.shelfY;
+            target.shelfX += w + GLYPH_PADDING;
+            target.shelfHeight = std::max(target.shelfHeight, h + GLYPH_PADDING);
+            target.lastUse = currentFrame;
+            return true;
+        };
+        // pages start (and are reset) transparent, only glyph rects are uploaded after that
+        auto reset = [](Atlas::Page &target) {
+            std::vector<unsigned char> transparent(PAGE_SIZE * PAGE_SIZE * 4, 0);
+            target.texture->set_data(transparent.data());
+            target.shelfX = 0;
+            target.shelfY = 0;
+            target.shelfHeight = 0;
+        };
+
+        for (page = 0; page < (int)atlas->pages.size(); page++)
+        {
+            if (place(atlas->pages[page]))
+                return true;
+        }
+
+        if ((int)atlas->pages.size() < MAX_PAGES)
+        {
+            Atlas::Page created;
+            created.texture = Texture::create(PAGE_SIZE, PAGE_SIZE, TextureFormat::RGBA);
+            reset(created);
+            atlas->pages.push_back(created);
+            page = (int)atlas->pages.size() - 1;
+            return place(atlas->pages[page]);
+        }
+
+        // Every page is full, empty the least recently used one. Pages used this frame may be in quads recorded
+        // but not rendered yet, the allocation fails if they all are.
+        page = -1;
+        uint64_t frame = currentFrame;
+        for (int i = 0; i < (int)atlas->pages.size(); i++)
+        {
+            auto lastUse = atlas->pages[i].lastUse;
+            if (lastUse < frame && (page < 0 || lastUse < atlas->pages[page].lastUse))
+                page = i;
+        }
+        if (page < 0)
+            return false;
+
+        for (auto it = atlas->glyphs.begin(); it != atlas->glyphs.end();)
+        {
+            if (it->second.page == page)
+                it = atlas->glyphs.erase(it);
+            else
+                ++it;
+        }
+        reset(atlas->pages[page]);
+        atlas->generation++;
+        return place(atlas->pages[page]);
+    }
+
+    const Character &Font::glyph(uint32_t codepoint) const
+    {
+        if (codepoint < (uint32_t)(FIRST_CHARACTER + CHARACTER_COUNT))
+            return characters[index((char)codepoint)];
+
+        auto found = atlas->glyphs.find(codepoint);
+        if (found != atlas->glyphs.end())
+        {
+            if (found->second.page >= 0)
+                atlas->pages[found->second.page].lastUse = currentFrame;
+            return found->second.character;
+        }
+
+        auto *fontInfo = (stbtt_fontinfo *)font.get();
+        int g = stbtt_FindGlyphIndex(fontInfo, (int)codepoint);
+        if (g == 0)
+        {
+            // remembered, so missing characters aren't looked up every time
+            return atlas->glyphs.emplace(codepoint, Atlas::Entry{characters['?' - FIRST_CHARACTER], -1})
+                .first->second.character;
+        }
+
+        Character character;
+        std::vector<uint8_t> coverage;
+        int w, h, y0;
+        bake(g, coverage, w, h, y0);
+        int advance, offsetX;
+        stbtt_GetGlyphHMetrics(fontInfo, g, &advance, &offsetX);
+        character.advance = advance * scale;
+        character.offset_x = offsetX * scale;
+        character.offset_y = y0;
+
+        int page = -1;
+        if (w > 0 && h > 0)
+        {
+            int x, y;
+            if (!allocate(w, h, page, x, y))
+            {
+                ENGINE_LOG_WARN(Graphics, "The font atlas is full, U+{:04X} is drawn as '?'", codepoint);
+                return characters['?' - FIRST_CHARACTER];
+            }
+
+            std::vector<Color> pixels(w * h);
+            Engine::ImageOps::alphaToRGBA(pixels.data(), coverage.data(), pixels.size());
+
+            auto &target = atlas->pages[page].texture;
+            target->setRegion(x, y, w, h, (const unsigned char *)pixels.data());
+            character.texture = Engine::Subtexture(target, Engine::Rect((float)x, (float)y, (float)w, (float)h));
+        }
+        return atlas->glyphs.emplace(codepoint, Atlas::Entry{character, page}).first->second.character;
+    }
+
+    int Font::kernedAdvance(uint32_t ch1, uint32_t ch2) const
+    {
+        constexpr auto tabled = (uint32_t)(FIRST_CHARACTER + CHARACTER_COUNT);
+        if (ch1 < tabled && ch2 < tabled)
+        {
+            int next = ch2 == 0 ? CHARACTER_COUNT : index((char)ch2);
+            return advances[index((char)ch1) * (CHARACTER_COUNT + 1) + next];
+        }
+        int advance = glyph(ch1).advance;
+        if (ch2 == 0)
+            return advance;
+        int kern = stbtt_GetCodepointKernAdvance((stbtt_fontinfo *)font.get(), (int)ch1, (int)ch2);
+        return advance + (int)(kern * scale);
     }
 
     const Engine::Character &Font::getCharacter(const char *text) const
     {
-        return characters.at(*text);
+        uint32_t codepoint = decodeUtf8(text);
+        if (codepoint < (uint32_t)(FIRST_CHARACTER + CHARACTER_COUNT))
+            return characters[index((char)codepoint)];
+        std::lock_guard<std::mutex> lock(atlas->mutex);
+        return glyph(codepoint);
     }
 
     int Engine::Font::getAdvance(int ch1, int ch2) const
     {
-        int advance = characters.at(ch1).advance;
-        int kern = stbtt_GetCodepointKernAdvance(static_cast<stbtt_fontinfo *>(font.get()), ch1, ch2);
-        return advance + kern;
+        constexpr int tabled = FIRST_CHARACTER + CHARACTER_COUNT;
+        if (ch1 < tabled && ch2 < tabled)
+            return kernedAdvance((uint32_t)ch1, (uint32_t)ch2);
+        std::lock_guard<std::mutex> lock(atlas->mutex);
+        return kernedAdvance((uint32_t)ch1, (uint32_t)ch2);
     }
 
     int Engine::Font::getWidth(const char* text) const {
-        auto txt = text;
-        float width = 0;
-        while (*txt) {
-            auto character = getCharacter(txt);
-            width += character.offset_x; // this character left padding
-            width += getAdvance(*txt, *(txt + 1)); // next character space
-            ++txt;
-        }
-        return width;
+        return layout(text).width;
+    }
+
+    TextLayout Font::layout(const std::string &text) const
+    {
+        TextLayout layout;
+        layout.distanceField = mode == Mode::DistanceField;
+        layout.glyphs.reserve(text.size());
+
+        std::lock_guard<std::mutex> lock(atlas->mutex);
+
+        const char *txt = text.c_str();
+        uint32_t codepoint = *txt ? decodeUtf8(txt) : 0;
+        float x = 0;
+        while (codepoint)
+        {
+            uint32_t next = *txt ? decodeUtf8(txt) : 0;
+            auto &character = glyph(codepoint);
+            x += character.offset_x; // this character left padding
+            auto &rect = character.texture.rect;
+            if (character.texture.texture && rect.w > 0 && rect.h > 0)
+            {
+                auto &glyphTexture = character.texture.texture;
+                auto found = std::find(layout.textures.begin(), layout.textures.end(), glyphTexture);
+                if (found == layout.textures.end())
+                    found = layout.textures.insert(layout.textures.end(), glyphTexture);
+
+                glm::vec2 textureSize{(float)glyphTexture->getWidth(), (float)glyphTexture->getHeight()};
+                TextLayout::Glyph quad;
+                quad.position = {x - padding, character.offset_y - padding};
+                quad.size = {rect.w, rect.h};
+                quad.uv0 = rect.top_left() / textureSize;
+                quad.uv1 = rect.bottom_right() / textureSize;
+                quad.texture = (uint16_t)(found - layout.textures.begin());
+                layout.glyphs.push_back(quad);
+            }
+            x += kernedAdvance(codepoint, next); // next character space
+            codepoint = next;
+        }
+        layout.width = (int)x;
+        // evictions while laying out don't touch this layout's pages, it's current with the atlas as it is now
+        layout.generation = atlas->generation;
+        return layout;
+    }
+
+    void Font::touch(const TextLayout &layout) const
+    {
+        if (layout.textures.empty() || (layout.textures.size() == 1 && layout.textures[0] == texture))
+            return;
+        std::lock_guard<std::mutex> lock(atlas->mutex);
+        for (auto &page : atlas->pages)
+        {
+            if (std::find(layout.textures.begin(), layout.textures.end(), page.texture) != layout.textures.end())
+                page.lastUse = currentFrame;
+        }
+    }
+
+    void Font::frame()
+    {
+        currentFrame++;
+    }
+
+    uint32_t Font::getGeneration() const
+    {
+        return atlas->generation;
     }
 }
@@ -3,7 +3,9 @@
 #include <string>
 #include <memory>
 #include <vector>
-#include <map>
+#include <array>
+#include <cstdint>
+#include <glm/glm.hpp>
 #include "Texture.h"
 #include "Subtexture.h"
 
@@ -19,21 +21,120 @@ namespace Engine
         float offset_y;
     };
 
+    // A string laid out with a Font: one quad per glyph, relative to the start of the line.
+    // Laying out is the expensive part of drawing text, Batch::str keeps the layouts it draws.
+    struct TextLayout
+    {
+        struct Glyph
+        {
+            glm::vec2 position;
+            glm::vec2 size;
+            // normalised texture coordinates (top left, bottom right)
+            glm::vec2 uv0;
+            glm::vec2 uv1;
+            // index in `textures`
+            uint16_t texture;
+        };
+
+        // ASCII glyphs are in the font texture, the rest in the atlas pages they were rasterized into
+        std::vector<std::shared_ptr<Engine::Texture>> textures;
+        std::vector<Glyph> glyphs;
+        // same as Font::getWidth()
+        int width = 0;
+        // the textures hold distance fields (Font::Mode::DistanceField), Batch draws them with distance_field_shader_data
+        bool distanceField = false;
+        // Font::getGeneration() when laid out, the layout is stale once it changes
+        uint32_t generation = 0;
+    };
+
+    // A TrueType font. Printable ASCII is rasterized when the font is created, any other character (UTF-8 text)
+    // the first time it's laid out, into atlas pages of PAGE_SIZE pixels. Once MAX_PAGES are full the least
+    // recently used page is emptied for the new glyphs.
+    // Rasterizing a glyph uploads it to its page, text with characters the font hasn't drawn yet has to be
+    // laid out on the thread that owns the GL context (the glyphs are shared by every copy of the font).
     class Font
     {
     public:
+        enum class Mode
+        {
+            // Coverage bitmaps, sharp at the size the font was created with
+            Bitmap,
+            // Signed distance fields, one font scales to any size (Batch::str's scale) and can be outlined,
+            // see distance_field_shader_data. Create it around 32 pixels high so the small sizes keep their shape.
+            DistanceField
+        };
+
+        // Pixels of distance field around every glyph, outlines and glows can reach this far out
+        static constexpr int DISTANCE_FIELD_PADDING = 4;
+
+        // Printable ASCII, kept in a table and never evicted
+        static constexpr int FIRST_CHARACTER = 32;
+        static constexpr int CHARACTER_COUNT = 96;
+
+        static constexpr int PAGE_SIZE = 512;
+        static constexpr int MAX_PAGES = 4;
+
         Font() = delete;
-        Font(const std::string &path, int pixel_height);
+        Font(const std::string &path, int pixel_height, Mode mode = Mode::Bitmap);
 
+        // The character at the start of the UTF-8 `text`. Characters the font doesn't have are drawn as '?'.
+        // References to characters outside ASCII are valid until their page is evicted (getGeneration() changes).
         const Engine::Character &getCharacter(const char *text) const;
+        // Advance from the codepoint `ch1` to `ch2` (0 at the end of the text), kerning included
         int getAdvance(int ch1, int ch2) const;
         int getWidth(const char* text) const;
 
+        // Lays out the UTF-8 `text` on a single line
+        [[nodiscard]] TextLayout layout(const std::string &text) const;
+
+        // Marks the atlas pages of a cached layout as used, so they aren't the next ones evicted
+        void touch(const TextLayout &layout) const;
+
+        // Identifies the font in layout caches (copies share it, they hold the same glyphs)
+        [[nodiscard]] uint32_t getId() const { return id; }
+
+        // Called by the Application once per frame, after rendering. Atlas pages used since the last call hold glyphs
+        // of quads that may not be rendered yet, they're never evicted.
+        static void frame();
+
+        // Changes when atlas pages are evicted, layouts made before then point at glyphs that are gone
+        [[nodiscard]] uint32_t getGeneration() const;
+
+        // Decodes the codepoint at `text` and advances it, invalid sequences decode to U+FFFD
+        static uint32_t decodeUtf8(const char *&text);
+
         int ascent, descent, lineGap;
     private:
+        struct Atlas;
+
         std::shared_ptr<void> font;
         std::vector<uint8_t> buffer;
         std::shared_ptr<Engine::Texture> texture;
-        std::map<char, Character> characters;
+        uint32_t id;
+        float scale;
+        Mode mode;
+        // distance field border around the glyph bitmaps, 0 for Bitmap fonts
+        int padding;
+        // indexed by character - FIRST_CHARACTER
+        std::array<Character, CHARACTER_COUNT> characters;
+        // advance + kerning of every character pair (current * CHARACTER_COUNT + next),
+        // the last column is the advance at the end of the text
+        std::vector<int16_t> advances;
+        // glyphs outside ASCII, rasterized on demand
+        std::shared_ptr<Atlas> atlas;
+
+        static int index(char ch);
+
+        // The glyph for `codepoint`, rasterizing it if needed (call with the atlas locked)
+        const Character &glyph(uint32_t codepoint) const;
+
+        // Rasterizes a glyph (coverage or distance field), `y0` is the top of the glyph relative to the baseline
+        void bake(int glyph, std::vector<uint8_t> &coverage, int &w, int &h, int &y0) const;
+
+        // Advance + kerning between two codepoints (call with the atlas locked unless both are ASCII)
+        int kernedAdvance(uint32_t ch1, uint32_t ch2) const;
+
+        // Packs a glyph of `w` x `h` pixels into a page, returns false if every page is full and used this frame
+        bool allocate(int w, int h, int &page, int &x, int &y) const;
     };
 } // namespace Engine
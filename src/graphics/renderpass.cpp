@@ -1,6 +1,11 @@
 #include "renderpass.h"
 #include "Log.h"
 #include "glad/glad.h"
+#include <algorithm>
+#include "Profiler.h"
+#include "GpuProfiler.h"
+#include "SamplerCache.h"
+#include "Application.h"
 
 using namespace Engine;
 
@@ -89,6 +94,12 @@ RenderPass::RenderPass()
 
 void RenderPass::perform()
 {
+    if (Application::isHeadless())
+        return;
+
+    ENGINE_PROFILE_SCOPE("RenderPass::perform");
+    // merged into the enclosing pass when called from Batch::render
+    ENGINE_GPU_PROFILE_SCOPE("RenderPass::perform");
     ENGINE_ASSERT(material, "Trying to draw with an invalid material");
     ENGINE_ASSERT(material->shader(), "Trying to draw with an invalid Shader");
     ENGINE_ASSERT(mesh, "Trying to draw with an invalid Mesh");
@@ -97,14 +108,14 @@ void RenderPass::perform()
     if (!target)
     {
         target = FrameBuffer::BackBuffer();
-        ENGINE_CORE_WARN("Trying to draw with an invalid Target; falling back to Back Buffer");
+        ENGINE_LOG_WARN(Graphics, "Trying to draw with an invalid Target; falling back to Back Buffer");
     }
 
     // Validate Index Count
     int64_t meshIndexCount = mesh->index_count();
     if (index_start + index_count > meshIndexCount)
     {
-        ENGINE_CORE_WARN(
+        ENGINE_LOG_WARN(Graphics, 
             "Trying to draw more indices than exist in the index buffer {}-{} / {}); trimming extra indices",
             index_start,
             index_start + index_count,
@@ -176,13 +187,16 @@ void RenderPass::perform()
                     if (!tex)
                     {
                         glBindTexture(GL_TEXTURE_2D, 0);
+                        glBindSampler(gl_texture_slot, 0);
                     }
                     else
                     {
                         auto glTex = tex.get();
-                        glTex->updateSampler(sampler); // config the texture.
                         // Put the texture into whatever slot is 'active'
-                        glBindTexture(GL_TEXTURE_2D, glTex->getId());
+                        glBindTexture(glTex->getTarget(), glTex->getId());
+                        // the sampler object overrides the texture's own sampling state
+                        glBindSampler(gl_texture_slot, SamplerCache::get(sampler));
+                        ENGINE_GPU_PROFILE_TEXTURE_BIND();
                     }
 
                     // We just put the texture into the slot, now we need to remember this slot to assign it
@@ -284,6 +298,7 @@ void RenderPass::perform()
 
         int indexSize = mesh->indexSize();
 
+        ENGINE_GPU_PROFILE_DRAW(index_count * std::max<int64_t>(instance_count, 1));
         if (this->instance_count > 0)
         {
             // not suported yet
@@ -1,54 +1,358 @@
 #include <Log.h>
 #include "Aseprite.h"
 #include "Color.h"
-#include "fstream"
+#include "ImageOps.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
 
 #define STBI_NO_STDIO
 #define STBI_ONLY_ZLIB
 
 #include "stb/stb_image.h"
 
+namespace {
+    constexpr uint16_t FILE_MAGIC = 0xA5E0;
+    constexpr uint16_t FRAME_MAGIC = 0xF1FA;
+    constexpr size_t HEADER_SIZE = 128;
+    constexpr size_t FRAME_HEADER_SIZE = 16;
+
+    // header flag: layer opacity has a valid value
+    constexpr uint16_t LAYER_OPACITY_VALID = 1;
+    // layer flags
+    constexpr uint16_t LAYER_VISIBLE = 1;
+    constexpr uint16_t LAYER_BACKGROUND = 8;
+
+    enum BlendMode {
+        Normal, Multiply, Screen, Overlay, Darken, Lighten, ColorDodge, ColorBurn, HardLight, SoftLight,
+        Difference, Exclusion, Hue, Saturation, ColorMode, Luminosity, Addition, Subtract, Divide
+    };
+
+    // a * b / 255, rounded
+    inline int mul_un8(int a, int b) {
+        int t = a * b + 0x80;
+        return ((t >> 8) + t) >> 8;
+    }
+
+    // a * 255 / b, rounded
+    inline int div_un8(int a, int b) {
+        return (a * 0xFF + (b / 2)) / b;
+    }
+
+    // Separable blend functions, b = backdrop, s = source
+    inline int blend_multiply(int b, int s) { return mul_un8(b, s); }
+
+    inline int blend_screen(int b, int s) { return b + s - mul_un8(b, s); }
+
+    inline int blend_hard_light(int b, int s) {
+        return s < 128 ? blend_multiply(b, s << 1) : blend_screen(b, (s << 1) - 255);
+    }
+
+    inline int blend_overlay(int b, int s) { return blend_hard_light(s, b); }
+
+    inline int blend_darken(int b, int s) { return std::min(b, s); }
+
+    inline int blend_lighten(int b, int s) { return std::max(b, s); }
+
+    inline int blend_color_dodge(int b, int s) {
+        if (b == 0)
+            return 0;
+        s = 255 - s;
+        return b >= s ? 255 : div_un8(b, s);
+    }
+
+    inline int blend_color_burn(int b, int s) {
+        if (b == 255)
+            return 255;
+        b = 255 - b;
+        return b >= s ? 0 : 255 - div_un8(b, s);
+    }
+
+    inline int blend_soft_light(int b, int s) {
+        double fb = b / 255.0;
+        double fs = s / 255.0;
+        double d = fb <= 0.25 ? ((16 * fb - 12) * fb + 4) * fb : std::sqrt(fb);
+        double r = fs <= 0.5 ? fb - (1.0 - 2.0 * fs) * fb * (1.0 - fb) : fb + (2.0 * fs - 1.0) * (d - fb);
+        return (int) (r * 255 + 0.5);
+    }
+
+    inline int blend_difference(int b, int s) { return std::abs(b - s); }
+
+    inline int blend_exclusion(int b, int s) { return b + s - 2 * mul_un8(b, s); }
+
+    inline int blend_addition(int b, int s) { return std::min(b + s, 255); }
+
+    inline int blend_subtract(int b, int s) { return std::max(b - s, 0); }
+
+    inline int blend_divide(int b, int s) {
+        if (b == 0)
+            return 0;
+        return b >= s ? 255 : div_un8(b, s);
+    }
+
+    // Non separable blend modes work on the whole color (W3C compositing spec)
+    struct RGB {
+        double r, g, b;
+    };
+
+    inline double lum(const RGB &c) { return 0.3 * c.r + 0.59 * c.g + 0.11 * c.b; }
+
+    inline double sat(const RGB &c) { return std::max({c.r, c.g, c.b}) - std::min({c.r, c.g, c.b}); }
+
+    RGB clipColor(RGB c) {
+        double l = lum(c);
+        double n = std::min({c.r, c.g, c.b});
+        double x = std::max({c.r, c.g, c.b});
+        if (n < 0.0) {
+            c = {l + (c.r - l) * l / (l - n), l + (c.g - l) * l / (l - n), l + (c.b - l) * l / (l - n)};
+        }
+        if (x > 1.0) {
+            c = {l + (c.r - l) * (1 - l) / (x - l), l + (c.g - l) * (1 - l) / (x - l), l + (c.b - l) * (1 - l) / (x - l)};
+        }
+        return c;
+    }
+
+    RGB setLum(const RGB &c, double l) {
+        double d = l - lum(c);
+        return clipColor({c.r + d, c.g + d, c.b + d});
+    }
+
+    RGB setSat(RGB c, double s) {
+        double *channels[3] = {&c.r, &c.g, &c.b};
+        std::sort(channels, channels + 3, [](double *a, double *b) { return *a < *b; });
+        double &min = *channels[0], &mid = *channels[1], &max = *channels[2];
+        if (max > min) {
+            mid = (mid - min) * s / (max - min);
+            max = s;
+        } else {
+            mid = max = 0.0;
+        }
+        min = 0.0;
+        return c;
+    }
+
+    Engine::Color blendNonSeparable(const Engine::Color &backdrop, const Engine::Color &src, int mode) {
+        RGB b{backdrop.r / 255.0, backdrop.g / 255.0, backdrop.b / 255.0};
+        RGB s{src.r / 255.0, src.g / 255.0, src.b / 255.0};
+        RGB r{};
+        switch (mode) {
+            case Hue:
+                r = setLum(setSat(s, sat(b)), lum(b));
+                break;
+            case Saturation:
+                r = setLum(setSat(b, sat(s)), lum(b));
+                break;
+            case ColorMode:
+                r = setLum(s, lum(b));
+                break;
+            default: // Luminosity
+                r = setLum(b, lum(s));
+                break;
+        }
+        return {(uint8_t) (r.r * 255 + 0.5), (uint8_t) (r.g * 255 + 0.5), (uint8_t) (r.b * 255 + 0.5), src.a};
+    }
+
+    // Composites `src` over `dst` (straight alpha)
+    inline void blendNormal(Engine::Color &dst, const Engine::Color &src, int opacity) {
+        if (src.a == 0)
+            return;
+        int sa = mul_un8(src.a, opacity);
+        if (dst.a == 0) {
+            dst = Engine::Color(src.r, src.g, src.b, (uint8_t) sa);
+            return;
+        }
+        int ra = sa + dst.a - mul_un8(dst.a, sa);
+        dst.r = (uint8_t) (dst.r + (src.r - dst.r) * sa / ra);
+        dst.g = (uint8_t) (dst.g + (src.g - dst.g) * sa / ra);
+        dst.b = (uint8_t) (dst.b + (src.b - dst.b) * sa / ra);
+        dst.a = (uint8_t) ra;
+    }
+
+    void blendRowNormal(Engine::Color *dst, const Engine::Color *src, int count, int opacity) {
+        if (opacity == 255) {
+            for (int i = 0; i < count; i++) {
+                // most pixels are either fully opaque or fully transparent
+                if (src[i].a == 255)
+                    dst[i] = src[i];
+                else if (src[i].a != 0)
+                    blendNormal(dst[i], src[i], 255);
+            }
+            return;
+        }
+        for (int i = 0; i < count; i++)
+            blendNormal(dst[i], src[i], opacity);
+    }
+
+    template <int (*F)(int, int)>
+    void blendRowSeparable(Engine::Color *dst, const Engine::Color *src, int count, int opacity) {
+        for (int i = 0; i < count; i++) {
+            auto &b = dst[i];
+            auto &s = src[i];
+            if (s.a == 0)
+                continue;
+            // nothing to blend against, behaves like normal
+            if (b.a == 0) {
+                blendNormal(b, s, opacity);
+                continue;
+            }
+            Engine::Color blended((uint8_t) F(b.r, s.r), (uint8_t) F(b.g, s.g), (uint8_t) F(b.b, s.b), s.a);
+            blendNormal(b, blended, opacity);
+        }
+    }
+
+    void blendRowNonSeparable(Engine::Color *dst, const Engine::Color *src, int count, int opacity, int mode) {
+        for (int i = 0; i < count; i++) {
+            if (src[i].a == 0)
+                continue;
+            if (dst[i].a == 0) {
+                blendNormal(dst[i], src[i], opacity);
+                continue;
+            }
+            blendNormal(dst[i], blendNonSeparable(dst[i], src[i], mode), opacity);
+        }
+    }
+
+    using RowBlender = void (*)(Engine::Color *, const Engine::Color *, int, int);
+
+    RowBlender separableBlender(int mode) {
+        switch (mode) {
+            case Multiply: return blendRowSeparable<blend_multiply>;
+            case Screen: return blendRowSeparable<blend_screen>;
+            case Overlay: return blendRowSeparable<blend_overlay>;
+            case Darken: return blendRowSeparable<blend_darken>;
+            case Lighten: return blendRowSeparable<blend_lighten>;
+            case ColorDodge: return blendRowSeparable<blend_color_dodge>;
+            case ColorBurn: return blendRowSeparable<blend_color_burn>;
+            case HardLight: return blendRowSeparable<blend_hard_light>;
+            case SoftLight: return blendRowSeparable<blend_soft_light>;
+            case Difference: return blendRowSeparable<blend_difference>;
+            case Exclusion: return blendRowSeparable<blend_exclusion>;
+            case Addition: return blendRowSeparable<blend_addition>;
+            case Subtract: return blendRowSeparable<blend_subtract>;
+            case Divide: return blendRowSeparable<blend_divide>;
+            default: return nullptr;
+        }
+    }
+}
+
+template <class T>
+T Engine::Aseprite::Reader::read() {
+    T value{};
+    if (position + sizeof(T) > size) {
+        overrun = true;
+        position = size;
+        return value;
+    }
+    memcpy(&value, data + position, sizeof(T));
+    position += sizeof(T);
+    return value;
+}
+
+const uint8_t *Engine::Aseprite::Reader::bytes(size_t count) {
+    if (count > size - position) {
+        overrun = true;
+        position = size;
+        return nullptr;
+    }
+    auto *result = data + position;
+    position += count;
+    return result;
+}
+
+std::string Engine::Aseprite::Reader::string() {
+    auto length = read<uint16_t>();
+    auto *chars = bytes(length);
+    return chars ? std::string{(const char *) chars, length} : std::string{};
+}
+
+Engine::Color *Engine::Aseprite::PixelArena::allocate(size_t count) {
+    if (count > capacity - used) {
+        capacity = std::max(count, BLOCK_SIZE);
+        blocks.emplace_back(new Engine::Color[capacity]);
+        used = 0;
+    }
+    auto *pixels = blocks.back().get() + used;
+    used += count;
+    return pixels;
+}
+
 Engine::Aseprite::Aseprite(const std::string &path) {
-    std::ifstream reader(path, std::ios::binary);
-    if (!reader.is_open()) ENGINE_CORE_ERROR("Could not open Aseprite file {}", path);
+    std::ifstream reader(path, std::ios::binary | std::ios::ate);
+    if (!reader.is_open()) {
+        ENGINE_LOG_ERROR(Content, "Could not open Aseprite file {}", path);
+        return;
+    }
 
-    reader.read((char *) &info, 128);
+    // one read for the whole file, everything else is parsed from memory
+    std::vector<uint8_t> file((size_t) reader.tellg());
+    reader.seekg(0, std::ios::beg);
+    reader.read((char *) file.data(), (std::streamsize) file.size());
+    decode(file.data(), file.size());
+}
 
-    frames.resize(info.frameCount);
+Engine::Aseprite::Aseprite(const uint8_t *data, size_t size) {
+    decode(data, size);
+}
 
-    for (int frameIndex = 0; frameIndex < info.frameCount; frameIndex++) {
-        AsepriteFrameHeader frameHeader{};
-        reader.read((char *) &frameHeader, 16);
+void Engine::Aseprite::decode(const uint8_t *data, size_t size) {
+    Reader reader{data, size};
+    if (size < HEADER_SIZE) {
+        ENGINE_LOG_ERROR(Content, "File is not a valid Aseprite file");
+        return;
+    }
 
-        if (frameHeader.magicNumber != 0xF1FA) {
-            ENGINE_CORE_ERROR("File is not a valid Aseprite file");
+    reader.skip(4); // file size
+    if (reader.read<uint16_t>() != FILE_MAGIC) {
+        ENGINE_LOG_ERROR(Content, "File is not a valid Aseprite file");
+        return;
+    }
+    auto frameCount = reader.read<uint16_t>();
+    width = reader.read<uint16_t>();
+    height = reader.read<uint16_t>();
+    colorDepth = reader.read<uint16_t>();
+    headerFlags = (uint16_t) reader.read<uint32_t>();
+    reader.skip(2 + 4 + 4); // speed (deprecated), reserved
+    transparentIndex = reader.read<uint8_t>();
+    reader.seek(HEADER_SIZE);
+
+    // all the frames share one allocation
+    frames.resize(frameCount);
+    size_t framePixels = (size_t) width * height;
+    auto *pixels = arena.allocate(framePixels * frameCount);
+
+    for (int frameIndex = 0; frameIndex < frameCount; frameIndex++) {
+        size_t frameStart = reader.tell();
+        auto frameSize = reader.read<uint32_t>();
+        auto magic = reader.read<uint16_t>();
+        auto chunkCountOld = reader.read<uint16_t>();
+        auto duration = reader.read<uint16_t>();
+        reader.skip(2);
+        auto chunkCountNew = reader.read<uint32_t>();
+
+        if (magic != FRAME_MAGIC || reader.failed()) {
+            ENGINE_LOG_ERROR(Content, "File is not a valid Aseprite file");
+            frames.resize(frameIndex);
             return;
         }
 
         auto &frame = frames[frameIndex];
-        frame.duration = frameHeader.frameDuration;
-        frame.image.width = info.w;
-        frame.image.height = info.h;
-        frame.image.pixels = new Engine::Color[info.w * info.h];
-
-        uint16_t chunkCount;
-        if (frameHeader.chunkCountOld == 0xFFFF) {
-            chunkCount = frameHeader.chunkCountOld;
-        } else {
-            chunkCount = frameHeader.chunkCountNew;
-        }
+        frame.duration = duration;
+        frame.image.width = width;
+        frame.image.height = height;
+        frame.image.pixels = pixels + framePixels * frameIndex;
 
-        for (int chunkIndex = 0; chunkIndex < chunkCount; chunkIndex++) {
-            auto chunkStart = reader.tellg();
-            DWORD chunkSize;
-            WORD chunkType;
+        // the new field is 0 on files written by older versions
+        uint32_t chunkCount = chunkCountNew != 0 ? chunkCountNew : chunkCountOld;
 
-            reader.read((char *) &chunkSize, sizeof(DWORD));
-            reader.read((char *) &chunkType, sizeof(WORD));
+        for (uint32_t chunkIndex = 0; chunkIndex < chunkCount && !reader.failed(); chunkIndex++) {
+            size_t chunkStart = reader.tell();
+            auto chunkSize = reader.read<uint32_t>();
+            auto chunkType = reader.read<uint16_t>();
+            size_t chunkEnd = std::min(chunkStart + chunkSize, size);
 
             auto type = static_cast<Chunks>(chunkType);
             switch (type) {
-                case Chunks::OldPaletteA :
                 case Chunks::OldPaletteB :
                 case Chunks::ColorProfile :
                 case Chunks::CelExtra :
@@ -56,6 +360,26 @@ Engine::Aseprite::Aseprite(const std::string &path) {
                 case Chunks::UserData :
                 case Chunks::Mask : //(DEPRECATED)
                     break;
+                case Chunks::OldPaletteA : {
+                    // only used when the file has no new palette chunk
+                    if (!palette.empty())
+                        break;
+                    palette.resize(256, Color(0, 0, 0, 255));
+                    auto packets = reader.read<uint16_t>();
+                    int index = 0;
+                    for (int p = 0; p < packets && !reader.failed(); p++) {
+                        index += reader.read<uint8_t>();
+                        int count = reader.read<uint8_t>();
+                        if (count == 0)
+                            count = 256;
+                        for (int c = 0; c < count; c++, index++) {
+                            auto *rgb = reader.bytes(3);
+                            if (rgb && index < 256)
+                                palette[index] = Color(rgb[0], rgb[1], rgb[2], 255);
+                        }
+                    }
+                    break;
+                }
                 case Chunks::Slice :
                     parseSlice(reader);
                     break;
@@ -66,230 +390,264 @@ Engine::Aseprite::Aseprite(const std::string &path) {
                     parseLayer(reader);
                     break;
                 case Chunks::Cel :
-                    parseCel(reader, chunkSize + chunkStart, frame);
+                    parseCel(reader, chunkEnd, frame);
                     break;
                 case Chunks::Palette :
                     parsePalette(reader);
                     break;
             }
 
-            reader.seekg(chunkSize + chunkStart, std::ios_base::beg);
+            reader.seek(chunkEnd);
         }
-    }
-}
-
-void Engine::Aseprite::parseLayer(std::ifstream &reader) {
 
-    layers.emplace_back();
-    auto &layer = layers.back();
+        // cels are composited bottom to top, whatever order they were stored in
+        std::stable_sort(frame.cels.begin(), frame.cels.end(),
+                         [](const Cel &a, const Cel &b) { return a.layer_index < b.layer_index; });
+        for (auto &cel : frame.cels)
+            composite(cel, frame);
 
-    reader.read((char *) &layer.flags, sizeof(WORD));
-    reader.read((char *) &layer.type, sizeof(WORD));
-    reader.read((char *) &layer.child_level, sizeof(WORD));
-    reader.seekg(sizeof(WORD) * 2, std::__1::ios_base::cur); // x,y ignored
-    reader.read((char *) &layer.blendmode, sizeof(WORD));
-    reader.read((char *) &layer.opacity, sizeof(BYTE));
-    reader.seekg(sizeof(BYTE) * 3, std::__1::ios_base::cur); // reserved for future use
+        reader.seek(frameStart + frameSize);
+    }
 
-    WORD nameLength;
-    reader.read((char *) &nameLength, sizeof(WORD));
-    layer.name = std::string{};
-    layer.name.resize(nameLength);
-    reader.read(&layer.name[0], nameLength);
+    if (reader.failed())
+        ENGINE_LOG_ERROR(Content, "Aseprite file is truncated");
 }
 
-void Engine::Aseprite::parseCel(std::ifstream &reader, int chunkEnd, Frame &currentFrame) {
-    currentFrame.cels.emplace_back();
-    auto &cel = currentFrame.cels.back();
-    reader.read((char *) &cel.layer_index, sizeof(WORD));
-    reader.read((char *) &cel.x, sizeof(SHORT));
-    reader.read((char *) &cel.y, sizeof(SHORT));
-    reader.read((char *) &cel.alpha, sizeof(BYTE));
-    WORD type;
-    reader.read((char *) &type, sizeof(WORD));
+void Engine::Aseprite::parseLayer(Reader &reader) {
+
+    auto &layer = layers.emplace_back();
+
+    layer.flags = reader.read<uint16_t>();
+    layer.type = reader.read<uint16_t>();
+    layer.child_level = reader.read<uint16_t>();
+    reader.skip(sizeof(uint16_t) * 2); // default width, height (ignored)
+    layer.blendmode = reader.read<uint16_t>();
+    layer.opacity = reader.read<uint8_t>();
+    reader.skip(3); // reserved for future use
+    layer.name = reader.string();
+
+    // A layer is only visible if every group it's nested in is visible too.
+    // Groups precede their children, so the last layer seen at each level is the current parent.
+    bool visible = (layer.flags & LAYER_VISIBLE) != 0;
+    for (int i = (int) layers.size() - 2; i >= 0 && layer.child_level > 0; i--) {
+        if (layers[i].child_level < layer.child_level) {
+            visible = visible && layers[i].visible;
+            break;
+        }
+    }
+    layer.visible = visible;
+}
 
-    reader.seekg(7, std::__1::ios_base::cur); // ignored (for future use)
+void Engine::Aseprite::parseCel(Reader &reader, size_t chunkEnd, Frame &currentFrame) {
+    auto &cel = currentFrame.cels.emplace_back();
+    cel.layer_index = reader.read<uint16_t>();
+    cel.x = reader.read<int16_t>();
+    cel.y = reader.read<int16_t>();
+    cel.alpha = reader.read<uint8_t>();
+    auto type = reader.read<uint16_t>();
+    reader.skip(7); // z-index, reserved
 
     switch (type) {
         case 0:      // Raw
         case 2: {   // ZLib
-            WORD width;
-            reader.read((char *) &width, sizeof(WORD));
-            WORD height;
-            reader.read((char *) &height, sizeof(WORD));
-            cel.image.width = width;
-            cel.image.height = height;
-            cel.image.pixels = new Engine::Color[width * height];
-            size_t count = width * height * sizeof(Color);
-
-            if (type == 0) { // Raw
-                reader.read((char *) cel.image.pixels, count);
-            }
-            if (type == 2) { // ZLib
-                size_t isize = chunkEnd - reader.tellg();
-                char *ibuffer = new char[isize];
-                reader.read(ibuffer, isize);
-                auto res = stbi_zlib_decode_buffer((char *) cel.image.pixels, count, ibuffer, isize);
-                if (res < 0) ENGINE_CORE_ERROR("Could not read ase file data");
-                delete[] ibuffer;
-            }
-
-            switch (info.colorDepth / 8) {
-                case Modes::RGBA: {
-                    // no op
-                    break;
-                }
-                case Modes::GRAYSCALED: {
-                    //Each pixel contains 2 bytes [value, alpha]
-                    auto src = (unsigned char *) cel.image.pixels;
-                    auto dst = cel.image.pixels;
-                    for (int d = width * height - 1, s = (width * height - 1) * 2;
-                         d >= 0; d--, s -= 2) {
-                        dst[d] = Color(src[s], src[s], src[s], src[s + 1]);
-                    }
-                    cel.image.pixels = cel.image.pixels;
-                    break;
-                }
-                case Modes::INDEXED: {
-                    auto src = (unsigned char *) cel.image.pixels;
-                    auto dst = cel.image.pixels;
-                    // This copies in-place from the end to the beginning to avoid copying over data we still need to read.
-                    // Explanation: we copy (8 bits at a time - by decrementing an unsigned char *)
-                    // we get a 32 bits Color from thhe palette and we paste these 32 bits into the array.
-                    // All of this happens in place. So if we pasted these 32 bits in theh beggining, we would be pasing it over
-                    // the next 8 bits we were supposed to read.
-                    for (int x = width * height - 1; x >= 0; x--) {
-                        dst[x] = palette[src[x]];
+            if (!decodeCelPixels(reader, chunkEnd, cel, type))
+                currentFrame.cels.pop_back();
+            break;
+        }
+        case 1: {   // Linked cel (https://www.aseprite.org/docs/linked-cels/)
+            cel.linked_frame_index = reader.read<uint16_t>();
+            // shares the pixels of the cel on the same layer in the linked frame
+            bool found = false;
+            if (cel.linked_frame_index < (int) frames.size() && &frames[cel.linked_frame_index] != &currentFrame) {
+                for (auto &linked : frames[cel.linked_frame_index].cels) {
+                    if (linked.layer_index == cel.layer_index) {
+                        cel.image = linked.image;
+                        found = true;
+                        break;
                     }
                 }
-                    break;
             }
-        }
-            break;
-        case 1:     // Linked cel (https://www.aseprite.org/docs/linked-cels/)
-            reader.read((char *) &cel.linked_frame_index, sizeof(WORD));
+            if (!found)
+                currentFrame.cels.pop_back();
             break;
-        default:
+        }
+        default:    // Compressed tilemap (unsupported)
+            currentFrame.cels.pop_back();
             break;
     }
+}
 
+bool Engine::Aseprite::decodeCelPixels(Reader &reader, size_t chunkEnd, Cel &cel, uint8_t compression) {
+    int celWidth = reader.read<uint16_t>();
+    int celHeight = reader.read<uint16_t>();
+    size_t count = (size_t) celWidth * celHeight;
+    if (count == 0 || reader.failed())
+        return false;
+
+    cel.image.width = celWidth;
+    cel.image.height = celHeight;
+    cel.image.pixels = arena.allocate(count);
+
+    int bytesPerPixel = colorDepth / 8;
+    size_t size = count * bytesPerPixel;
+    size_t available = chunkEnd > reader.tell() ? chunkEnd - reader.tell() : 0;
+    auto *input = reader.bytes(available);
+
+    // RGBA cels go straight into their final buffer, the others through the scratch buffer
+    const uint8_t *source = nullptr;
+    uint8_t *destination = (uint8_t *) cel.image.pixels;
+    if (bytesPerPixel != Modes::RGBA) {
+        if (scratch.size() < size)
+            scratch.resize(size);
+        destination = scratch.data();
+    }
 
-    // render cel to current frame
-    // TODO: account for cel x and y (right now we assume the cel size and position equals that of the frame)
-    {
-        for (int j = 0; j < currentFrame.image.height; j++) {
-            for (int i = 0; i < currentFrame.image.width; i++) {
-                if (i >= cel.x && i < cel.x + cel.image.width &&
-                    j >= cel.y && j < cel.y + cel.image.height) {
-                    auto frameCoords = i + j * currentFrame.image.width;
-                    auto celCoords = (i - cel.x) + (j - cel.y) * cel.image.width;
-                    // todo: blending?
-                    currentFrame.image.pixels[frameCoords] = cel.image.pixels[celCoords];
-                }
-            }
+    if (compression == 0) { // Raw
+        if (!input || available < size) {
+            ENGINE_LOG_ERROR(Content, "Could not read ase file data");
+            return false;
         }
+        if (bytesPerPixel == Modes::RGBA)
+            memcpy(destination, input, size);
+        else
+            source = input;
+    } else { // ZLib
+        auto res = stbi_zlib_decode_buffer((char *) destination, (int) size, (const char *) input, (int) available);
+        if (res != (int) size) {
+            ENGINE_LOG_ERROR(Content, "Could not read ase file data");
+            return false;
+        }
+        source = destination;
     }
 
-    //memcpy(currentFrame.image.pixels, cel.image.pixels, sizeof(Engine::Color) * cel.image.width * cel.image.height);
-
+    auto *dst = cel.image.pixels;
+    switch (bytesPerPixel) {
+        case Modes::RGBA:
+            break;
+        case Modes::GRAYSCALED:
+            // Each pixel contains 2 bytes [value, alpha]
+            ImageOps::grayAlphaToRGBA(dst, source, count);
+            break;
+        case Modes::INDEXED: {
+            // the transparent index is only transparent outside of the background layer
+            bool background = cel.layer_index < (int) layers.size() &&
+                              (layers[cel.layer_index].flags & LAYER_BACKGROUND) != 0;
+            ImageOps::paletteLookup(dst, source, count, palette.data(), palette.size(),
+                                    background ? -1 : transparentIndex);
+            break;
+        }
+        default:
+            ENGINE_LOG_ERROR(Content, "Unsupported Aseprite color depth {}", colorDepth);
+            return false;
+    }
+    return true;
 }
 
-void Engine::Aseprite::parsePalette(std::ifstream &reader) {
-    AsepritePalette asepritePalette;
-    reader.read((char *) &asepritePalette.entryCount, sizeof(DWORD));
-    reader.read((char *) &asepritePalette.firstColorIndex, sizeof(DWORD));
-    reader.read((char *) &asepritePalette.lastColorIndex, sizeof(DWORD));
-    reader.seekg(8, std::__1::ios_base::cur); // skip 8 bytes, future use
+void Engine::Aseprite::composite(const Cel &cel, Frame &frame) {
+    if (!cel.image.pixels || cel.layer_index >= (int) layers.size())
+        return;
+
+    auto &layer = layers[cel.layer_index];
+    if (!layer.visible)
+        return;
+
+    int opacity = cel.alpha;
+    if (headerFlags & LAYER_OPACITY_VALID)
+        opacity = mul_un8(opacity, layer.opacity);
+    if (opacity == 0)
+        return;
+
+    // clip the cel against the frame
+    int x0 = std::max(cel.x, 0);
+    int y0 = std::max(cel.y, 0);
+    int x1 = std::min(cel.x + cel.image.width, frame.image.width);
+    int y1 = std::min(cel.y + cel.image.height, frame.image.height);
+    if (x0 >= x1 || y0 >= y1)
+        return;
+
+    int count = x1 - x0;
+    auto blender = separableBlender(layer.blendmode);
+    bool nonSeparable = layer.blendmode >= Hue && layer.blendmode <= Luminosity;
+
+    for (int y = y0; y < y1; y++) {
+        const Color *src = cel.image.pixels + (y - cel.y) * cel.image.width + (x0 - cel.x);
+        Color *dst = frame.image.pixels + y * frame.image.width + x0;
+
+        if (blender)
+            blender(dst, src, count, opacity);
+        else if (nonSeparable)
+            blendRowNonSeparable(dst, src, count, opacity, layer.blendmode);
+        else
+            blendRowNormal(dst, src, count, opacity);
+    }
+}
 
-    palette.reserve(asepritePalette.entryCount);
+void Engine::Aseprite::parsePalette(Reader &reader) {
+    auto size = reader.read<uint32_t>();
+    auto first = reader.read<uint32_t>();
+    auto last = reader.read<uint32_t>();
+    reader.skip(8); // future use
 
-    for (int p = 0; p < asepritePalette.entryCount; p++) {
-        AsepritePaletteEntry entry;
-        reader.read((char *) &entry.flags, sizeof(WORD));
-        reader.read((char *) &entry.color, sizeof(Color));
+    if (size > 256 * 256 || last < first) {
+        ENGINE_LOG_ERROR(Content, "Invalid Aseprite palette");
+        return;
+    }
+    palette.resize(size);
 
-        palette.push_back(entry.color);
+    for (uint32_t index = first; index <= last && !reader.failed(); index++) {
+        auto flags = reader.read<uint16_t>();
+        auto *rgba = reader.bytes(4);
+        if (rgba && index < size)
+            palette[index] = Color(rgba[0], rgba[1], rgba[2], rgba[3]);
 
-        if (entry.flags == 1) {
+        if (flags & 1) {
             // has name
-            WORD nameLength;
-            reader.read((char *) &nameLength, sizeof(WORD));
-            char *entryName = new char[nameLength + 1];
-            entryName[nameLength] = '\0';
-            reader.read(entryName, nameLength);
-            std::cout << entryName << std::endl;
-            delete[] entryName;
+            reader.string();
         }
     }
 }
 
-void Engine::Aseprite::parseTag(std::ifstream &reader) {
-    WORD numberOfTags;
-    reader.read((char *) &numberOfTags, sizeof(WORD));
-    reader.seekg(8, std::ios_base::cur);
-    for (int tagIndex = 0; tagIndex < numberOfTags; ++tagIndex) {
+void Engine::Aseprite::parseTag(Reader &reader) {
+    auto numberOfTags = reader.read<uint16_t>();
+    reader.skip(8);
+    for (int tagIndex = 0; tagIndex < numberOfTags && !reader.failed(); ++tagIndex) {
         auto &tag = tags.emplace_back();
-        reader.read((char *) &tag.from, sizeof(WORD));
-        reader.read((char *) &tag.to, sizeof(WORD));
-        BYTE animDirection;
-        reader.read((char *) &animDirection, sizeof(BYTE));
-        tag.animationDirection = static_cast<Tag::AnimDirection>(animDirection);
-
-        reader.seekg(8, std::ios_base::cur); // for future
-        reader.seekg(3, std::ios_base::cur); // tag-color
-        reader.seekg(1, std::ios_base::cur); // extra byte (0)
-
-        WORD nameLength;
-        reader.read((char *) &nameLength, sizeof(WORD));
-        tag.name = std::string{};
-        tag.name.resize(nameLength);
-        reader.read(&tag.name[0], nameLength);
+        tag.from = reader.read<uint16_t>();
+        tag.to = reader.read<uint16_t>();
+        tag.animationDirection = static_cast<Tag::AnimDirection>(reader.read<uint8_t>());
+
+        reader.skip(2); // repeat
+        reader.skip(6); // for future
+        reader.skip(3); // tag-color
+        reader.skip(1); // extra byte (0)
+
+        tag.name = reader.string();
     }
 }
 
-void Engine::Aseprite::parseSlice(std::ifstream &reader) {
-    DWORD sliceCount;
-    reader.read((char *) &sliceCount, sizeof(DWORD));
+void Engine::Aseprite::parseSlice(Reader &reader) {
+    auto sliceCount = reader.read<uint32_t>();
     if (sliceCount <= 0) return;
-    DWORD flags;
-    reader.read((char *) &flags, sizeof(DWORD));
+    auto flags = reader.read<uint32_t>();
     if ((flags & 0b10) == 0) return; // has pivot information
-    reader.seekg(sizeof(DWORD), std::ios_base::cur); //reserved
-
-    WORD nameLenght;
-    reader.read((char *) &nameLenght, sizeof(WORD));
-    reader.seekg(nameLenght, std::ios_base::cur); //name
-
-    for (int i = 0; i < sliceCount; i++) {
-        DWORD frameNumber;
-        reader.read((char *) &frameNumber, sizeof(DWORD));
-        LONG sliceX;
-        reader.read((char *) &sliceX, sizeof(LONG));
-        LONG sliceY;
-        reader.read((char *) &sliceY, sizeof(LONG));
-        DWORD sliceW;
-        reader.read((char *) &sliceW, sizeof(DWORD));
-        DWORD sliceH;
-        reader.read((char *) &sliceH, sizeof(DWORD));
+    reader.skip(sizeof(uint32_t)); //reserved
+    reader.string(); //name
+
+    for (uint32_t i = 0; i < sliceCount && !reader.failed(); i++) {
+        reader.skip(sizeof(uint32_t)); // frame number
+        reader.skip(sizeof(int32_t) * 2); // x, y
+        reader.skip(sizeof(uint32_t) * 2); // w, h
         if ((flags & 0b1) > 0) {
             // 9-patch (unsopported)
-            reader.seekg(sizeof(LONG) * 2, std::ios_base::cur);
-            reader.seekg(sizeof(DWORD) * 2, std::ios_base::cur);
+            reader.skip(sizeof(int32_t) * 2);
+            reader.skip(sizeof(uint32_t) * 2);
         }
 
         if ((flags & 0b10) > 0) {
             // pivot
-            LONG pivotX;
-            reader.read((char *) &pivotX, sizeof(LONG));
-            LONG pivotY;
-            reader.read((char *) &pivotY, sizeof(LONG));
-
-            int32_t px = pivotX;
-            int32_t py = pivotY;
-            slices.push_back({px, py});
+            auto pivotX = reader.read<int32_t>();
+            auto pivotY = reader.read<int32_t>();
+            slices.push_back({pivotX, pivotY});
         }
     }
-
-
 }
-
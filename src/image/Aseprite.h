@@ -1,19 +1,26 @@
 #pragma once
 
-#include <iostream>
-#include <Color.h>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
 #include <vector>
+#include <Color.h>
 
 namespace Engine {
 
+    // Decodes .ase/.aseprite files (https://github.com/aseprite/aseprite/blob/main/docs/ase-file-specs.md)
+    // The whole file is parsed from a single in-memory buffer and every frame is composited
+    // (layer visibility, opacity and blend modes) into its own image.
     class Aseprite {
 
     public:
 
         struct Image {
-            int width;
-            int height;
-            Engine::Color* pixels;
+            int width = 0;
+            int height = 0;
+            // Points into the Aseprite's pixel arena, valid for as long as the Aseprite object lives
+            Engine::Color* pixels = nullptr;
         };
 
         struct Cel {
@@ -49,6 +56,7 @@ namespace Engine {
             uint16_t child_level = 0;
             uint16_t blendmode = 0;
             uint8_t opacity = 0;
+            // false if the layer or any of its parent groups is hidden
             bool visible = true;
         };
 
@@ -59,6 +67,9 @@ namespace Engine {
 
         explicit Aseprite(const std::string& path);
 
+        // Decodes a file already in memory, the data only needs to outlive the constructor
+        Aseprite(const uint8_t* data, size_t size);
+
         std::vector<Frame> frames{};
         std::vector<Engine::Color> palette;
         std::vector<Layer> layers;
@@ -88,82 +99,75 @@ namespace Engine {
             ColorProfile = 0x2007
         };
 
-        typedef uint32_t DWORD;     // 4
-        typedef uint16_t WORD;      // 2
-        typedef int16_t SHORT;      // 2
-        typedef uint8_t BYTE;       // 1
-        typedef int32_t LONG;       // 4
-
-        struct AsepriteFrameHeader {
-            DWORD bytes;            // Bytes in this frame
-            WORD magicNumber;       // Magic number (always 0xF1FA)
-            WORD chunkCountOld;     // Old field which specifies the number of "chunks" in this frame. If this value is 0xFFFF, we might have more chunks to read in this frame (so we have to use the new field)
-            WORD frameDuration;     // Frame duration (in milliseconds)
-            BYTE unused[2];         // For future (set to zero)
-            DWORD chunkCountNew;    // New field which specifies the number of "chunks" in this frame (if this is 0, use the old field)
-        };
+        // Bounds checked little endian cursor over the file
+        class Reader {
+        public:
+            Reader(const uint8_t* data, size_t size) : data{data}, size{size} {}
 
-        struct AsepriteHeader {
-            DWORD fileSize = 0;
-            WORD magicNumber = 0;
-            WORD frameCount = 0;
-            WORD w, h = 0;
-            WORD colorDepth = 0;
-            DWORD flags;
-            WORD speed;
-            DWORD zeroA;
-            DWORD zeroB;
-            BYTE paletteEntry;
-            BYTE ignored[3];
-            WORD colorCount = 0;
-            BYTE pixelWidth = 0;
-            BYTE pixelHeight = 0;
-            SHORT x, y = 0;
-            WORD gridWidth;
-            WORD gridHeight;
-            BYTE unused[84];
-        };
+            template <class T>
+            T read();
 
-        struct AsepriteLayer {
-            WORD flags;
-            WORD type;
-            WORD childLevel;
-            WORD width;
-            WORD height;
-            WORD blendMode;
-            BYTE opacity;
-            BYTE future[3]; // reserved for future use
-            WORD nameLength;
-        };
+            // Returns a pointer to the next `count` bytes and skips them (nullptr if the file is too short)
+            const uint8_t* bytes(size_t count);
+
+            std::string string();
+
+            void skip(size_t count) { seek(position + count); }
+
+            void seek(size_t offset) { position = offset <= size ? offset : size; }
 
-        struct AsepritePaletteEntry {
-            WORD flags{}; // 1 = has name
-            Engine::Color color;
+            [[nodiscard]] size_t tell() const { return position; }
+
+            [[nodiscard]] size_t remaining() const { return size - position; }
+
+            [[nodiscard]] bool failed() const { return overrun; }
+
+        private:
+            const uint8_t* data;
+            size_t size;
+            size_t position = 0;
+            bool overrun = false;
         };
 
-        struct AsepritePalette {
-            DWORD entryCount;
-            DWORD firstColorIndex;
-            DWORD lastColorIndex;
+        // Every pixel buffer (frames and cels) is carved out of a few large blocks
+        // instead of one allocation per image
+        class PixelArena {
+        public:
+            Engine::Color* allocate(size_t count);
+
+        private:
+            static constexpr size_t BLOCK_SIZE = 64 * 1024;
+
+            std::vector<std::unique_ptr<Engine::Color[]>> blocks;
+            size_t used = 0;
+            size_t capacity = 0;
         };
 
-        /// PIXEL: One pixel, depending on the image pixel format:
-        //RGBA: BYTE[4], each pixel have 4 bytes in this order Red, Green, Blue, Alpha.
-        //Grayscale: BYTE[2], each pixel have 2 bytes in the order Value, Alpha.
-        //Indexed: BYTE, Each pixel uses 1 byte (the index).
-        /// \param path
+        int width = 0;
+        int height = 0;
+        int colorDepth = 0;
+        uint16_t headerFlags = 0;
+        uint8_t transparentIndex = 0;
+
+        PixelArena arena;
+        // Scratch buffer the grayscale/indexed cels are inflated into before being expanded to RGBA
+        std::vector<uint8_t> scratch;
+
+        void decode(const uint8_t* data, size_t size);
+
+        void parsePalette(Reader& reader);
 
-        AsepriteHeader info;
+        void parseCel(Reader& reader, size_t chunkEnd, Frame& currentFrame);
 
-        void parsePalette(std::ifstream& reader);
+        bool decodeCelPixels(Reader& reader, size_t chunkEnd, Cel& cel, uint8_t compression);
 
-        void parseCel(std::ifstream& reader, int chunkEnd, Frame& currentFrame);
+        void composite(const Cel& cel, Frame& frame);
 
-        void parseLayer(std::ifstream& reader);
+        void parseLayer(Reader& reader);
 
-        void parseTag(std::ifstream& reader);
+        void parseTag(Reader& reader);
 
-        void parseSlice(std::ifstream& ifstream);
+        void parseSlice(Reader& reader);
     };
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,258 @@
+#include "ImageOps.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define ENGINE_IMAGE_AVX2
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define ENGINE_IMAGE_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define ENGINE_IMAGE_NEON
+#endif
+
+namespace {
+    // x * a / 255, rounded
+    inline uint8_t mul_un8(int x, int a) {
+        int t = x * a + 0x80;
+        return (uint8_t) (((t >> 8) + t) >> 8);
+    }
+
+    inline uint32_t pack(uint8_t r, uint8_t g, uint8_t b, uint8_t a) {
+        return (uint32_t) r | ((uint32_t) g << 8) | ((uint32_t) b << 16) | ((uint32_t) a << 24);
+    }
+}
+
+void Engine::ImageOps::paletteLookup(Color *dst, const uint8_t *indices, size_t count,
+                                     const Color *palette, size_t paletteSize, int transparentIndex) {
+    // A full 256 entry table makes the lookup branchless, transparency is baked into it
+    alignas(32) uint32_t table[256];
+    for (size_t i = 0; i < 256; i++) {
+        if (i < paletteSize && (int) i != transparentIndex) {
+            auto &color = palette[i];
+            table[i] = pack(color.r, color.g, color.b, color.a);
+        } else {
+            table[i] = 0;
+        }
+    }
+
+    auto *out = (uint32_t *) (void *) dst;
+    size_t i = 0;
+#if defined(ENGINE_IMAGE_AVX2)
+    for (; i + 8 <= count; i += 8) {
+        __m256i index = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *) (indices + i)));
+        __m256i colors = _mm256_i32gather_epi32((const int *) table, index, 4);
+        _mm256_storeu_si256((__m256i *) (out + i), colors);
+    }
+#endif
+    // there is no gather on SSE2/NEON and a 1KB table doesn't fit in a shuffle, plain loads are as fast
+    for (; i + 4 <= count; i += 4) {
+        out[i] = table[indices[i]];
+        out[i + 1] = table[indices[i + 1]];
+        out[i + 2] = table[indices[i + 2]];
+        out[i + 3] = table[indices[i + 3]];
+    }
+    for (; i < count; i++)
+        out[i] = table[indices[i]];
+}
+
+void Engine::ImageOps::grayAlphaToRGBA(Color *dst, const uint8_t *src, size_t count) {
+    auto *out = (uint8_t *) (void *) dst;
+    size_t i = 0;
+#if defined(ENGINE_IMAGE_SSE2)
+    const __m128i lowByte = _mm_set1_epi16(0x00FF);
+    for (; i + 8 <= count; i += 8) {
+        // 16 bit lanes hold (value | alpha << 8)
+        __m128i pairs = _mm_loadu_si128((const __m128i *) (src + i * 2));
+        __m128i value = _mm_and_si128(pairs, lowByte);
+        __m128i doubled = _mm_or_si128(value, _mm_slli_epi16(value, 8));
+        // interleaving (value, value) with (value, alpha) gives (value, value, value, alpha)
+        _mm_storeu_si128((__m128i *) (out + i * 4), _mm_unpacklo_epi16(doubled, pairs));
+        _mm_storeu_si128((__m128i *) (out + i * 4 + 16), _mm_unpackhi_epi16(doubled, pairs));
+    }
+#elif defined(ENGINE_IMAGE_NEON)
+    for (; i + 8 <= count; i += 8) {
+        uint8x8x2_t pairs = vld2_u8(src + i * 2);
+        uint8x8x4_t rgba = {{pairs.val[0], pairs.val[0], pairs.val[0], pairs.val[1]}};
+        vst4_u8(out + i * 4, rgba);
+    }
+#endif
+    for (; i < count; i++) {
+        out[i * 4] = out[i * 4 + 1] = out[i * 4 + 2] = src[i * 2];
+        out[i * 4 + 3] = src[i * 2 + 1];
+    }
+}
+
+void Engine::ImageOps::alphaToRGBA(Color *dst, const uint8_t *alpha, size_t count) {
+    auto *out = (uint8_t *) (void *) dst;
+    size_t i = 0;
+#if defined(ENGINE_IMAGE_SSE2)
+    for (; i + 16 <= count; i += 16) {
+        __m128i a = _mm_loadu_si128((const __m128i *) (alpha + i));
+        __m128i lo = _mm_unpacklo_epi8(a, a);
+        __m128i hi = _mm_unpackhi_epi8(a, a);
+        _mm_storeu_si128((__m128i *) (out + i * 4), _mm_unpacklo_epi16(lo, lo));
+        _mm_storeu_si128((__m128i *) (out + i * 4 + 16), _mm_unpackhi_epi16(lo, lo));
+        _mm_storeu_si128((__m128i *) (out + i * 4 + 32), _mm_unpacklo_epi16(hi, hi));
+        _mm_storeu_si128((__m128i *) (out + i * 4 + 48), _mm_unpackhi_epi16(hi, hi));
+    }
+#elif defined(ENGINE_IMAGE_NEON)
+    for (; i + 16 <= count; i += 16) {
+        uint8x16_t a = vld1q_u8(alpha + i);
+        uint8x16x4_t rgba = {{a, a, a, a}};
+        vst4q_u8(out + i * 4, rgba);
+    }
+#endif
+    for (; i < count; i++)
+        out[i * 4] = out[i * 4 + 1] = out[i * 4 + 2] = out[i * 4 + 3] = alpha[i];
+}
+
+void Engine::ImageOps::premultiply(Color *pixels, size_t count) {
+    auto *data = (uint8_t *) (void *) pixels;
+    size_t i = 0;
+#if defined(ENGINE_IMAGE_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i rgbMask = _mm_set_epi16(0, -1, -1, -1, 0, -1, -1, -1);
+    // alpha is multiplied by 255 so it comes out unchanged
+    const __m128i alphaOne = _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0);
+    const __m128i half = _mm_set1_epi16(0x80);
+
+    auto multiply = [&](__m128i channels) {
+        __m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(channels, 0xFF), 0xFF);
+        alpha = _mm_or_si128(_mm_and_si128(alpha, rgbMask), alphaOne);
+        __m128i t = _mm_add_epi16(_mm_mullo_epi16(channels, alpha), half);
+        return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+    };
+
+    for (; i + 4 <= count; i += 4) {
+        __m128i p = _mm_loadu_si128((const __m128i *) (data + i * 4));
+        __m128i lo = multiply(_mm_unpacklo_epi8(p, zero));
+        __m128i hi = multiply(_mm_unpackhi_epi8(p, zero));
+        _mm_storeu_si128((__m128i *) (data + i * 4), _mm_packus_epi16(lo, hi));
+    }
+#elif defined(ENGINE_IMAGE_NEON)
+    auto multiply = [](uint8x8_t channel, uint8x8_t alpha) {
+        uint16x8_t t = vmull_u8(channel, alpha);
+        return vraddhn_u16(t, vrshrq_n_u16(t, 8));
+    };
+
+    for (; i + 8 <= count; i += 8) {
+        uint8x8x4_t p = vld4_u8(data + i * 4);
+        p.val[0] = multiply(p.val[0], p.val[3]);
+        p.val[1] = multiply(p.val[1], p.val[3]);
+        p.val[2] = multiply(p.val[2], p.val[3]);
+        vst4_u8(data + i * 4, p);
+    }
+#endif
+    for (; i < count; i++) {
+        uint8_t a = data[i * 4 + 3];
+        data[i * 4] = mul_un8(data[i * 4], a);
+        data[i * 4 + 1] = mul_un8(data[i * 4 + 1], a);
+        data[i * 4 + 2] = mul_un8(data[i * 4 + 2], a);
+    }
+}
+
+namespace {
+    // RGB565 to RGBA8888
+    inline void expand565(uint16_t color, int rgb[3]) {
+        int r = (color >> 11) & 0x1F, g = (color >> 5) & 0x3F, b = color & 0x1F;
+        rgb[0] = (r << 3) | (r >> 2);
+        rgb[1] = (g << 2) | (g >> 4);
+        rgb[2] = (b << 3) | (b >> 2);
+    }
+
+    // Decodes the 4 colors of a BC1 color block, `opaque` forces the 4 color mode (BC2/BC3)
+    void colorPalette(const uint8_t *block, bool opaque, uint32_t palette[4]) {
+        auto c0 = (uint16_t) (block[0] | (block[1] << 8));
+        auto c1 = (uint16_t) (block[2] | (block[3] << 8));
+        int a[3], b[3];
+        expand565(c0, a);
+        expand565(c1, b);
+        palette[0] = pack((uint8_t) a[0], (uint8_t) a[1], (uint8_t) a[2], 255);
+        palette[1] = pack((uint8_t) b[0], (uint8_t) b[1], (uint8_t) b[2], 255);
+        if (c0 > c1 || opaque) {
+            palette[2] = pack((uint8_t) ((2 * a[0] + b[0]) / 3), (uint8_t) ((2 * a[1] + b[1]) / 3),
+                              (uint8_t) ((2 * a[2] + b[2]) / 3), 255);
+            palette[3] = pack((uint8_t) ((a[0] + 2 * b[0]) / 3), (uint8_t) ((a[1] + 2 * b[1]) / 3),
+                              (uint8_t) ((a[2] + 2 * b[2]) / 3), 255);
+        } else {
+            palette[2] = pack((uint8_t) ((a[0] + b[0]) / 2), (uint8_t) ((a[1] + b[1]) / 2),
+                              (uint8_t) ((a[2] + b[2]) / 2), 255);
+            palette[3] = 0;
+        }
+    }
+
+    // Writes a decoded 4x4 block, clipped to the image
+    void storeBlock(uint32_t *dst, int width, int height, int bx, int by, const uint32_t texels[16]) {
+        int w = std::min(4, width - bx);
+        int h = std::min(4, height - by);
+        for (int y = 0; y < h; y++)
+            memcpy(dst + (size_t) (by + y) * width + bx, texels + y * 4, sizeof(uint32_t) * w);
+    }
+
+    void decodeColorBlock(const uint8_t *block, bool opaque, uint32_t texels[16]) {
+        uint32_t palette[4];
+        colorPalette(block, opaque, palette);
+        uint32_t indices = block[4] | (block[5] << 8) | (block[6] << 16) | ((uint32_t) block[7] << 24);
+        for (int i = 0; i < 16; i++)
+            texels[i] = palette[(indices >> (i * 2)) & 3];
+    }
+}
+
+void Engine::ImageOps::decodeBC1(Color *dst, const uint8_t *blocks, int width, int height) {
+    auto *out = (uint32_t *) (void *) dst;
+    uint32_t texels[16];
+    for (int by = 0; by < height; by += 4) {
+        for (int bx = 0; bx < width; bx += 4, blocks += 8) {
+            decodeColorBlock(blocks, false, texels);
+            storeBlock(out, width, height, bx, by, texels);
+        }
+    }
+}
+
+void Engine::ImageOps::decodeBC3(Color *dst, const uint8_t *blocks, int width, int height) {
+    auto *out = (uint32_t *) (void *) dst;
+    uint32_t texels[16];
+    for (int by = 0; by < height; by += 4) {
+        for (int bx = 0; bx < width; bx += 4, blocks += 16) {
+            // 8 byte alpha block: 2 endpoints and 16 3 bit indices
+            int a0 = blocks[0], a1 = blocks[1];
+            int alphas[8] = {a0, a1};
+            if (a0 > a1) {
+                for (int i = 1; i < 7; i++)
+                    alphas[i + 1] = ((7 - i) * a0 + i * a1) / 7;
+            } else {
+                for (int i = 1; i < 5; i++)
+                    alphas[i + 1] = ((5 - i) * a0 + i * a1) / 5;
+                alphas[6] = 0;
+                alphas[7] = 255;
+            }
+            uint64_t indices = 0;
+            for (int i = 0; i < 6; i++)
+                indices |= (uint64_t) blocks[2 + i] << (8 * i);
+
+            decodeColorBlock(blocks + 8, true, texels);
+            for (int i = 0; i < 16; i++) {
+                uint32_t alpha = alphas[(indices >> (i * 3)) & 7];
+                texels[i] = (texels[i] & 0x00FFFFFF) | (alpha << 24);
+            }
+            storeBlock(out, width, height, bx, by, texels);
+        }
+    }
+}
+
+void Engine::ImageOps::blit(Color *dst, size_t dstStride, const Color *src, size_t srcStride, int width, int height) {
+    if (width <= 0 || height <= 0)
+        return;
+
+    // memcpy is already vectorized, all that's left is doing as few calls as possible
+    if (dstStride == (size_t) width && srcStride == (size_t) width) {
+        memcpy((void *) dst, (const void *) src, sizeof(Color) * width * height);
+        return;
+    }
+    for (int y = 0; y < height; y++)
+        memcpy((void *) (dst + y * dstStride), (const void *) (src + y * srcStride), sizeof(Color) * width);
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <Color.h>
+
+namespace Engine {
+
+    // Pixel format conversion kernels used when importing images.
+    // Each kernel has an SSE2 (AVX2 where it helps) and NEON version picked at compile time, and a scalar fallback.
+    // Sources and destinations must not overlap.
+    class ImageOps {
+
+    public:
+
+        // Expands 8 bit palette indices to RGBA. Indices equal to `transparentIndex` (pass -1 for none)
+        // or outside the palette become fully transparent.
+        static void paletteLookup(Color* dst, const uint8_t* indices, size_t count,
+                                  const Color* palette, size_t paletteSize, int transparentIndex);
+
+        // Expands [value, alpha] pairs to (value, value, value, alpha)
+        static void grayAlphaToRGBA(Color* dst, const uint8_t* src, size_t count);
+
+        // Splats a single 8 bit channel to all four components (a, a, a, a), used for glyph coverage
+        static void alphaToRGBA(Color* dst, const uint8_t* alpha, size_t count);
+
+        // Multiplies the color channels by alpha, in place
+        static void premultiply(Color* pixels, size_t count);
+
+        // Decodes BC1 (DXT1) / BC3 (DXT5) compressed images to RGBA, used when the GL context can't sample them.
+        // `blocks` holds ceil(width / 4) * ceil(height / 4) blocks of 8 (BC1) or 16 (BC3) bytes.
+        static void decodeBC1(Color* dst, const uint8_t* blocks, int width, int height);
+
+        static void decodeBC3(Color* dst, const uint8_t* blocks, int width, int height);
+
+        // Copies a `width` x `height` block, strides are in pixels
+        static void blit(Color* dst, size_t dstStride, const Color* src, size_t srcStride, int width, int height);
+
+    private:
+        ImageOps() = default;
+    };
+
+}
@@ -0,0 +1,120 @@
+#include <Log.h>
+#include "ImageWriter.h"
+#include <cstdint>
+#include <fstream>
+#include <vector>
+
+namespace {
+    // deflate stored blocks hold at most 65535 bytes
+    constexpr size_t MAX_STORED_BLOCK = 65535;
+
+    uint32_t crc32(const uint8_t *data, size_t size, uint32_t crc = 0) {
+        struct Table {
+            uint32_t entries[256];
+
+            Table() : entries{} {
+                for (uint32_t i = 0; i < 256; i++) {
+                    uint32_t c = i;
+                    for (int k = 0; k < 8; k++)
+                        c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                    entries[i] = c;
+                }
+            }
+        };
+        // images are encoded on worker threads, a function static is initialized exactly once
+        static const Table table;
+        crc = ~crc;
+        for (size_t i = 0; i < size; i++)
+            crc = table.entries[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+        return ~crc;
+    }
+
+    void putU32(std::vector<uint8_t> &out, uint32_t value) {
+        out.push_back((uint8_t) (value >> 24));
+        out.push_back((uint8_t) (value >> 16));
+        out.push_back((uint8_t) (value >> 8));
+        out.push_back((uint8_t) value);
+    }
+
+    void putChunk(std::vector<uint8_t> &out, const char *type, const std::vector<uint8_t> &data) {
+        putU32(out, (uint32_t) data.size());
+        size_t start = out.size();
+        out.insert(out.end(), type, type + 4);
+        out.insert(out.end(), data.begin(), data.end());
+        putU32(out, crc32(out.data() + start, out.size() - start));
+    }
+
+    bool writeFile(const std::string &path, const uint8_t *data, size_t size) {
+        std::ofstream file{path, std::ios::binary};
+        if (!file) {
+            ENGINE_LOG_ERROR(Graphics, "Couldn't open {} for writing", path);
+            return false;
+        }
+        file.write((const char *) data, (std::streamsize) size);
+        return (bool) file;
+    }
+}
+
+bool Engine::ImageWriter::writePNG(const std::string &path, int width, int height, const Color *pixels) {
+    ENGINE_ASSERT(width > 0 && height > 0, "Image width and height must be larger than 0");
+
+    // every row is prefixed with filter type 0 (none)
+    size_t rowSize = (size_t) width * 4 + 1;
+    size_t rawSize = rowSize * height;
+    size_t blocks = (rawSize + MAX_STORED_BLOCK - 1) / MAX_STORED_BLOCK;
+
+    std::vector<uint8_t> idat;
+    idat.reserve(2 + rawSize + blocks * 5 + 4);
+    // zlib header: deflate, 32K window, no preset dictionary, (0x78 << 8 | 0x01) % 31 == 0
+    idat.push_back(0x78);
+    idat.push_back(0x01);
+
+    // adler32 sums are 64 bit so they only need reducing once per row
+    uint64_t a = 1, b = 0;
+    size_t remaining = rawSize;
+    size_t blockLeft = 0;
+    for (int y = 0; y < height; y++) {
+        auto *row = (const uint8_t *) (pixels + (size_t) y * width);
+        for (size_t x = 0; x < rowSize; x++) {
+            if (blockLeft == 0) {
+                blockLeft = remaining < MAX_STORED_BLOCK ? remaining : MAX_STORED_BLOCK;
+                remaining -= blockLeft;
+                auto length = (uint16_t) blockLeft;
+                auto inverse = (uint16_t) ~length;
+                // BFINAL on the last block, BTYPE 00 (stored), then LEN and its one's complement
+                idat.push_back(remaining == 0 ? 1 : 0);
+                idat.push_back((uint8_t) length);
+                idat.push_back((uint8_t) (length >> 8));
+                idat.push_back((uint8_t) inverse);
+                idat.push_back((uint8_t) (inverse >> 8));
+            }
+            uint8_t value = x == 0 ? 0 : row[x - 1];
+            idat.push_back(value);
+            blockLeft--;
+            a += value;
+            b += a;
+        }
+        a %= 65521;
+        b %= 65521;
+    }
+    putU32(idat, (uint32_t) ((b << 16) | a));
+
+    std::vector<uint8_t> header;
+    putU32(header, (uint32_t) width);
+    putU32(header, (uint32_t) height);
+    // 8 bits per channel, RGBA, deflate, adaptive filtering, no interlace
+    header.insert(header.end(), {8, 6, 0, 0, 0});
+
+    static const uint8_t SIGNATURE[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    std::vector<uint8_t> png{SIGNATURE, SIGNATURE + 8};
+    png.reserve(8 + 12 * 3 + header.size() + idat.size());
+    putChunk(png, "IHDR", header);
+    putChunk(png, "IDAT", idat);
+    putChunk(png, "IEND", {});
+
+    return writeFile(path, png.data(), png.size());
+}
+
+bool Engine::ImageWriter::writeRaw(const std::string &path, int width, int height, const Color *pixels) {
+    return writeFile(path, (const uint8_t *) pixels, (size_t) width * height * sizeof(Color));
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <string>
+#include <Color.h>
+
+namespace Engine {
+
+    // Writes RGBA8 images to disk, rows top to bottom.
+    // PNGs are written with uncompressed (stored) deflate blocks: encoding costs about as much as a memcpy,
+    // so frames can be captured every frame, at the cost of larger files.
+    class ImageWriter {
+
+    public:
+
+        static bool writePNG(const std::string& path, int width, int height, const Color* pixels);
+
+        // Tightly packed RGBA8 pixels, no header
+        static bool writeRaw(const std::string& path, int width, int height, const Color* pixels);
+
+    private:
+        ImageWriter() = default;
+    };
+
+}
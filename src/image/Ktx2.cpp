@@ -0,0 +1,143 @@
+#include <Log.h>
+#include "Ktx2.h"
+#include "ImageOps.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace {
+    constexpr uint8_t IDENTIFIER[12] = {0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n'};
+    constexpr size_t HEADER_SIZE = 80;
+    constexpr size_t LEVEL_INDEX_ENTRY_SIZE = 24;
+    // KHR_DF_FLAG_ALPHA_PREMULTIPLIED
+    constexpr uint8_t DFD_PREMULTIPLIED = 1;
+
+    template <class T>
+    T read(const uint8_t *data, size_t offset) {
+        T value;
+        memcpy(&value, data + offset, sizeof(T));
+        return value;
+    }
+
+    // VkFormat values of the formats Texture can hold
+    Engine::TextureFormat fromVkFormat(uint32_t vkFormat) {
+        switch (vkFormat) {
+            case 37: // VK_FORMAT_R8G8B8A8_UNORM
+            case 43: // VK_FORMAT_R8G8B8A8_SRGB
+                return Engine::TextureFormat::RGBA;
+            case 133: // VK_FORMAT_BC1_RGBA_UNORM_BLOCK
+            case 134: // VK_FORMAT_BC1_RGBA_SRGB_BLOCK
+                return Engine::TextureFormat::BC1;
+            case 137: // VK_FORMAT_BC3_UNORM_BLOCK
+            case 138: // VK_FORMAT_BC3_SRGB_BLOCK
+                return Engine::TextureFormat::BC3;
+            case 145: // VK_FORMAT_BC7_UNORM_BLOCK
+            case 146: // VK_FORMAT_BC7_SRGB_BLOCK
+                return Engine::TextureFormat::BC7;
+            case 151: // VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK
+            case 152: // VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK
+                return Engine::TextureFormat::ETC2;
+            case 157: // VK_FORMAT_ASTC_4x4_UNORM_BLOCK
+            case 158: // VK_FORMAT_ASTC_4x4_SRGB_BLOCK
+                return Engine::TextureFormat::ASTC4x4;
+            default:
+                return Engine::TextureFormat::None;
+        }
+    }
+}
+
+Engine::Ktx2::Ktx2(const std::string &path) {
+    std::ifstream reader(path, std::ios::binary | std::ios::ate);
+    if (!reader.is_open()) {
+        ENGINE_LOG_ERROR(Content, "Could not open KTX2 file {}", path);
+        return;
+    }
+
+    file.resize((size_t) reader.tellg());
+    reader.seekg(0, std::ios::beg);
+    reader.read((char *) file.data(), (std::streamsize) file.size());
+    decode();
+}
+
+Engine::Ktx2::Ktx2(const uint8_t *data, size_t size) : file{data, data + size} {
+    decode();
+}
+
+void Engine::Ktx2::decode() {
+    const uint8_t *data = file.data();
+    size_t size = file.size();
+    if (size < HEADER_SIZE || memcmp(data, IDENTIFIER, sizeof(IDENTIFIER)) != 0) {
+        ENGINE_LOG_ERROR(Content, "File is not a valid KTX2 file");
+        return;
+    }
+
+    auto vkFormat = read<uint32_t>(data, 12);
+    width = (int) read<uint32_t>(data, 20);
+    height = (int) read<uint32_t>(data, 24);
+    auto depth = read<uint32_t>(data, 28);
+    auto layerCount = read<uint32_t>(data, 32);
+    auto faceCount = read<uint32_t>(data, 36);
+    auto levelCount = std::max(read<uint32_t>(data, 40), 1u);
+    auto supercompression = read<uint32_t>(data, 44);
+    auto dfdOffset = read<uint32_t>(data, 48);
+    auto dfdLength = read<uint32_t>(data, 52);
+
+    format = fromVkFormat(vkFormat);
+    if (format == TextureFormat::None) {
+        ENGINE_LOG_ERROR(Content, "Unsupported KTX2 format {}", vkFormat);
+        return;
+    }
+    if (depth > 1 || layerCount > 1 || faceCount != 1 || width <= 0 || height <= 0) {
+        ENGINE_LOG_ERROR(Content, "Only 2D KTX2 textures are supported");
+        return;
+    }
+    if (supercompression != 0) {
+        ENGINE_LOG_ERROR(Content, "Supercompressed KTX2 files are not supported");
+        return;
+    }
+    if (HEADER_SIZE + levelCount * LEVEL_INDEX_ENTRY_SIZE > size) {
+        ENGINE_LOG_ERROR(Content, "KTX2 file is truncated");
+        return;
+    }
+
+    // flags live in the first (basic) descriptor block, after the total size and block header
+    if (dfdLength >= 16 && (size_t) dfdOffset + 16 <= size)
+        premultiplied = (data[dfdOffset + 15] & DFD_PREMULTIPLIED) != 0;
+
+    levels.resize(levelCount);
+    for (uint32_t i = 0; i < levelCount; i++) {
+        size_t entry = HEADER_SIZE + i * LEVEL_INDEX_ENTRY_SIZE;
+        auto offset = read<uint64_t>(data, entry);
+        auto length = read<uint64_t>(data, entry + 8);
+
+        auto &level = levels[i];
+        level.width = std::max(width >> i, 1);
+        level.height = std::max(height >> i, 1);
+        if (offset > size || length > size - offset ||
+            length < Texture::dataSize(format, level.width, level.height)) {
+            ENGINE_LOG_ERROR(Content, "KTX2 file is truncated");
+            levels.clear();
+            return;
+        }
+        level.data = data + offset;
+        level.size = (size_t) length;
+    }
+    valid = true;
+}
+
+void Engine::Ktx2::premultiply() {
+    if (!valid || premultiplied || format != TextureFormat::RGBA)
+        return;
+    for (auto &level : levels)
+        ImageOps::premultiply((Color *) (void *) (file.data() + (level.data - file.data())),
+                              (size_t) level.width * level.height);
+    premultiplied = true;
+}
+
+std::vector<Engine::TextureLevel> Engine::Ktx2::textureLevels() const {
+    std::vector<TextureLevel> result;
+    result.reserve(levels.size());
+    for (auto &level : levels)
+        result.push_back({level.width, level.height, level.data, level.size});
+    return result;
+}
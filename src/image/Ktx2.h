@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Texture.h"
+
+namespace Engine {
+
+    // Reads KTX2 texture containers (https://registry.khronos.org/KTX/specs/2.0/ktxspec.v2.html)
+    // Only single 2D images (no arrays, cube maps or 3D textures) without supercompression are supported.
+    // The whole file is kept in memory and mip levels point into it.
+    class Ktx2 {
+
+    public:
+
+        struct Level {
+            int width = 0;
+            int height = 0;
+            const uint8_t* data = nullptr;
+            size_t size = 0;
+        };
+
+        explicit Ktx2(const std::string& path);
+
+        Ktx2(const uint8_t* data, size_t size);
+
+        // False if the file couldn't be read or uses a feature / format that isn't supported
+        bool valid = false;
+        TextureFormat format = TextureFormat::None;
+        int width = 0;
+        int height = 0;
+        // Taken from the data format descriptor
+        bool premultiplied = false;
+        // Largest level first
+        std::vector<Level> levels;
+
+        // Premultiplies uncompressed levels that aren't already, compressed data has to be premultiplied when cooked
+        void premultiply();
+
+        // Levels as expected by Texture::create
+        [[nodiscard]] std::vector<TextureLevel> textureLevels() const;
+
+    private:
+        std::vector<uint8_t> file;
+
+        void decode();
+    };
+
+}
@@ -1,5 +1,7 @@
 #include "Application.h"
+#include "Input.h"
 #include "Log.h"
+#include <cstdlib>
 
 /*
 void* operator new(size_t size) {
@@ -16,8 +18,25 @@ void operator delete(void* memory, std::size_t size) noexcept {
 int main(int argc, char *argv[]) {
     Engine::Log::init();
     ENGINE_CORE_INFO("Launching app...");
+
+    auto &options = Engine::Application::launchOptions;
+    options = Engine::LaunchOptions::parse(argc, argv);
+    if (!options.log.empty())
+        Engine::Log::openFile(options.log);
+
+    // The seed has to be known before the game is created (it may use rand() while setting up)
+    if (!options.replay.empty())
+        Engine::Input::startReplay(options.replay, options.seed);
+    else if (options.headless)
+        Engine::Input::setSource(Engine::Input::Source::Scripted);
+    srand(options.seed);
+
     Engine::Application *application = Engine::createApplication();
+    if (!options.record.empty())
+        Engine::Input::startRecording(options.record, options.seed);
     application->run();
+    Engine::Input::stopRecording();
     delete application;
+    Engine::Log::shutdown();
     return 0;
 }
@@ -24,36 +24,12 @@ namespace Engine::Math
     }
 
     glm::mat3x2 transform(const glm::vec2 &position, const glm::vec2 &origin, const glm::vec2 &scale, float radians) {
-        auto matrix = glm::mat3x2{1.0, 0.0, 0.0, 1.0, 1.0, 1.0};
-
-        if (origin.x != 0 || origin.y != 0)
-        {
-            glm::mat3x2 transform{1, 0.0f, 0.0f, 1, -origin.x, -origin.y};
-            matrix = transform;
-        }
-        if (scale.x != 1 || scale.y != 1)
-        {
-            glm::mat3x2 transform{ scale.x, 0.0f, 0.0f, scale.y, 0.0f, 0.0f};
-            matrix = transform * glm::mat3x3(matrix);
-        }
-        
-        if (radians != 0) {
-            glm::mat3x2 transform = rotate(radians);
-            matrix = transform * glm::mat3x3(matrix);
-        }
-
-        if (position.x != 0 || position.y != 0)
-        {
-            glm::mat3x2 transform{
-                1.0, 0.0f,
-                0.0f, 1.0,
-                position.x,
-                position.y};
-
-            matrix = transform * glm::mat3x3(matrix);
-        }
-
-        return matrix;
+        // translate(position) * rotate(radians) * scale(scale) * translate(-origin), multiplied out
+        float c = radians != 0 ? cos(radians) : 1.0f;
+        float s = radians != 0 ? sin(radians) : 0.0f;
+        glm::vec2 x{c * scale.x, s * scale.x};
+        glm::vec2 y{-s * scale.y, c * scale.y};
+        return glm::mat3x2{x, y, position - x * origin.x - y * origin.y};
     }
     glm::mat3x2 transform(const glm::vec2 &position, const glm::vec2 &origin, const glm::vec2 &scale)
     {
@@ -1,10 +1,20 @@
 #include "time/time.h"
 #include "SDL.h"
 
+float Engine::Time::delta = 1.0f / 60.0f;
+float Engine::Time::frameDelta = 0.0f;
+float Engine::Time::alpha = 1.0f;
 uint32_t Engine::Time::pauseTimer = 0;
+uint64_t Engine::Time::steps = 0;
+double Engine::Time::elapsed = 0.0;
+
+namespace {
+    // SDL_Delay can overshoot by a scheduler quantum, the last stretch before a deadline is spent spinning
+    constexpr double SPIN_THRESHOLD = 0.002;
+}
 
 bool Engine::Time::onInterval(uint32_t interval) {
-    auto currentTimeMillis = SDL_GetTicks();
+    auto currentTimeMillis = getTime();
 
     auto d = currentTimeMillis / interval;
 
@@ -12,5 +22,20 @@ bool Engine::Time::onInterval(uint32_t interval) {
 }
 
 uint32_t Engine::Time::getTime() {
-    return SDL_GetTicks();
+    return (uint32_t)(elapsed * 1000.0);
+}
+
+double Engine::Time::now() {
+    static const Uint64 start = SDL_GetPerformanceCounter();
+    static const double frequency = (double)SDL_GetPerformanceFrequency();
+    return (SDL_GetPerformanceCounter() - start) / frequency;
+}
+
+void Engine::Time::sleepUntil(double time) {
+    double remaining = time - now();
+    if (remaining > SPIN_THRESHOLD)
+        SDL_Delay((Uint32)((remaining - SPIN_THRESHOLD) * 1000.0));
+
+    while (now() < time) {
+    }
 }